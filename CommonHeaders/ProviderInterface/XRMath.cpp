@@ -249,6 +249,48 @@ void MatrixToQuaternion( const XRMatrix3x3 &kRot, XRQuaternion &q )
 	q = Normalize( q );
 }
 
+void QuaternionToMatrix( const XRQuaternion &q, XRMatrix3x3 &m )
+{
+	// Inverse of MatrixToQuaternion, q is expected to be normalized
+	float x = q.x * 2.0f;
+	float y = q.y * 2.0f;
+	float z = q.z * 2.0f;
+	float xx = q.x * x;
+	float yy = q.y * y;
+	float zz = q.z * z;
+	float xy = q.x * y;
+	float xz = q.x * z;
+	float yz = q.y * z;
+	float wx = q.w * x;
+	float wy = q.w * y;
+	float wz = q.w * z;
+
+	m.m[0][0] = 1.0f - ( yy + zz );
+	m.m[0][1] = xy + wz;
+	m.m[0][2] = xz - wy;
+	m.m[1][0] = xy - wz;
+	m.m[1][1] = 1.0f - ( xx + zz );
+	m.m[1][2] = yz + wx;
+	m.m[2][0] = xz + wy;
+	m.m[2][1] = yz - wx;
+	m.m[2][2] = 1.0f - ( xx + yy );
+}
+
+void QuaternionToMatrix( const XRQuaternion &q, XRMatrix4x4 &m )
+{
+	XRMatrix3x3 rotation;
+	QuaternionToMatrix( q, rotation );
+
+	m = XRMatrix4x4::identity;
+	for ( int i = 0; i < 3; ++i )
+	{
+		for ( int j = 0; j < 3; ++j )
+		{
+			m.m[i][j] = rotation.m[i][j];
+		}
+	}
+}
+
 /*static*/ XRMatrix4x4 XRMatrix4x4::Transpose( const XRMatrix4x4 &m )
 {
 	XRMatrix4x4 res;
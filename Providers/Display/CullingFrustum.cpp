@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cfloat>
+
+#include "CullingFrustum.h"
+
+
+bool GetUnionCullingFrustum( const float rawProjection[2][4], const vr::HmdMatrix34_t eyeToHead[2], float flNear, float flFar, UnionCullingFrustum &frustum )
+{
+	if ( flNear <= 0.0f || flFar <= flNear )
+		return false;
+
+	// Corner rays of both eyes in head space. In eye space they're ( x, -y, -1 ), as OpenVR's top and bottom
+	// tangents are positive downwards.
+	float corners[2][4][3];
+	for ( int eye = 0; eye < 2; ++eye )
+	{
+		const vr::HmdMatrix34_t &mat = eyeToHead[eye];
+		const float *raw = rawProjection[eye];
+
+		for ( int corner = 0; corner < 4; ++corner )
+		{
+			float eyeDir[3] = { raw[corner & 1], -raw[2 + ( corner >> 1 )], -1.0f };
+			for ( int axis = 0; axis < 3; ++axis )
+			{
+				corners[eye][corner][axis] = mat.m[axis][0] * eyeDir[0] + mat.m[axis][1] * eyeDir[1] + mat.m[axis][2] * eyeDir[2];
+			}
+		}
+	}
+
+	// A frustum contains a rotated eye frustum when it contains the eye's apex and the eye's corner rays point within its tangents
+	float flLeft = FLT_MAX, flRight = -FLT_MAX, flTop = FLT_MAX, flBottom = -FLT_MAX;
+	for ( int eye = 0; eye < 2; ++eye )
+	{
+		for ( int corner = 0; corner < 4; ++corner )
+		{
+			const float *dir = corners[eye][corner];
+			float flForward = -dir[2];
+			if ( flForward <= 1e-4f )
+				return false;
+
+			flLeft = std::min( flLeft, dir[0] / flForward );
+			flRight = std::max( flRight, dir[0] / flForward );
+			flTop = std::min( flTop, -dir[1] / flForward );
+			flBottom = std::max( flBottom, -dir[1] / flForward );
+		}
+	}
+
+	if ( flLeft >= flRight || flTop >= flBottom )
+		return false;
+
+	// With the tangents fixed, moving the apex forward only shrinks the frustum. The apex z (az) is bounded by
+	// every pair of eye apexes (p, q) that has to fit between two opposite planes at the same time:
+	//   x: p.x - R * ( az - p.z ) <= q.x - L * ( az - q.z )
+	//   y: p.y + T * ( az - p.z ) <= q.y + B * ( az - q.z )
+	// p == q gives az >= p.z, the apex can't be in front of an eye.
+	float flApexZ = -FLT_MAX;
+	for ( int p = 0; p < 2; ++p )
+	{
+		const vr::HmdMatrix34_t &matP = eyeToHead[p];
+		for ( int q = 0; q < 2; ++q )
+		{
+			const vr::HmdMatrix34_t &matQ = eyeToHead[q];
+			flApexZ = std::max( flApexZ, ( matP.m[0][3] - matQ.m[0][3] + flRight * matP.m[2][3] - flLeft * matQ.m[2][3] ) / ( flRight - flLeft ) );
+			flApexZ = std::max( flApexZ, ( matQ.m[1][3] - matP.m[1][3] + flTop * matP.m[2][3] - flBottom * matQ.m[2][3] ) / ( flTop - flBottom ) );
+		}
+	}
+
+	// Center the apex in what's left of the x and y ranges
+	float flMinX = -FLT_MAX, flMaxX = FLT_MAX, flMinY = -FLT_MAX, flMaxY = FLT_MAX;
+	for ( int eye = 0; eye < 2; ++eye )
+	{
+		const vr::HmdMatrix34_t &mat = eyeToHead[eye];
+		float flDistance = flApexZ - mat.m[2][3];
+
+		flMinX = std::max( flMinX, mat.m[0][3] - flRight * flDistance );
+		flMaxX = std::min( flMaxX, mat.m[0][3] - flLeft * flDistance );
+		flMinY = std::max( flMinY, mat.m[1][3] + flTop * flDistance );
+		flMaxY = std::min( flMaxY, mat.m[1][3] + flBottom * flDistance );
+	}
+
+	frustum.rawProjection[0] = flLeft;
+	frustum.rawProjection[1] = flRight;
+	frustum.rawProjection[2] = flTop;
+	frustum.rawProjection[3] = flBottom;
+	frustum.apex[0] = ( flMinX + flMaxX ) * 0.5f;
+	frustum.apex[1] = ( flMinY + flMaxY ) * 0.5f;
+	frustum.apex[2] = flApexZ;
+
+	// Enclose the near and far corners of both eyes, measured along the head's forward axis from the apex
+	frustum.flNear = FLT_MAX;
+	frustum.flFar = 0.0f;
+	for ( int eye = 0; eye < 2; ++eye )
+	{
+		float flEyeDistance = flApexZ - eyeToHead[eye].m[2][3];
+		for ( int corner = 0; corner < 4; ++corner )
+		{
+			float flForward = -corners[eye][corner][2];
+			frustum.flNear = std::min( frustum.flNear, flEyeDistance + flNear * flForward );
+			frustum.flFar = std::max( frustum.flFar, flEyeDistance + flFar * flForward );
+		}
+	}
+
+	frustum.flNear = std::max( frustum.flNear, flNear * 1e-3f );
+
+	return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "OpenVR/openvr.h"
+
+/// A single frustum containing the frustums of both eyes, used to cull both eyes with one culling pass.
+/// It looks straight down the head's forward axis; the eyes may be translated and rotated (canted displays).
+struct UnionCullingFrustum
+{
+	/// Left, right, top and bottom tangents, in the same convention as IVRSystem::GetProjectionRaw
+	float rawProjection[4];
+
+	/// Apex in head space (OpenVR coordinates, -z forward)
+	float apex[3];
+
+	/// Near and far plane distances from the apex that enclose the near and far planes of both eyes
+	float flNear;
+	float flFar;
+};
+
+/// Calculate the smallest frustum facing the head's forward axis that contains the frustums of both eyes.
+/// The tangents are the widest extents of the rotated eye frustums, the apex is moved forward as far as
+/// it can go while both eye apexes stay inside, which minimizes the frustum's volume.
+/// @param[in] const float rawProjection[2][4] - Left, right, top and bottom tangents of both eyes as returned by IVRSystem::GetProjectionRaw
+/// @param[in] const vr::HmdMatrix34_t eyeToHead[2] - Eye to head transforms as returned by IVRSystem::GetEyeToHeadTransform
+/// @param[in] float flNear - Near plane distance of the eyes
+/// @param[in] float flFar - Far plane distance of the eyes
+/// @param[out] UnionCullingFrustum& frustum - The union frustum
+/// @return bool - false if an eye frustum can't be contained by a forward facing frustum (e.g. it's rotated too far)
+bool GetUnionCullingFrustum( const float rawProjection[2][4], const vr::HmdMatrix34_t eyeToHead[2], float flNear, float flFar, UnionCullingFrustum &frustum );
@@ -2,12 +2,16 @@
 #include <cstring>
 #endif
 
+#include <atomic>
+
 #include "Display.h"
 #include "Input/Input.h"
+#include "TimeDomain.h"
 
 
 // Interfaces
 static IUnityXRDisplayInterface *s_pXRDisplay = nullptr;
+static IUnityXRDisplayShadingRateExt *s_pXRDisplayShadingRate = nullptr;
 static IUnityXRStats *s_pXRStats;
 static UnitySubsystemHandle s_DisplayHandle;
 static OpenVRProviderContext *s_pProviderContext;
@@ -21,6 +25,26 @@ static UnityXRStatId m_flCPURenderTimeInMs;			// time spent on cpu submitting th
 static UnityXRStatId m_flCPUIdelTimeInMs;			// time spent waiting for running start (application could have used this much more time)
 static UnityXRStatId m_flCompositorRenderTimeInMs;	// time spend performing distortion correction, rendering chaperone, overlays, etc.
 static UnityXRStatId m_flRefreshRate;
+static UnityXRStatId s_nViewConfigCacheHitsStat;	// number of frames that reused the cached eye poses and projections
+static UnityXRStatId s_nViewConfigCacheMissesStat;	// number of times the eye poses and projections had to be recomputed
+static UnityXRStatId m_nStageRingStarvedFrames;		// number of frames that had to reuse a stage the compositor may still be reading
+static UnityXRStatId m_nStageRingFreeStages;		// number of free stages when the current frame acquired its stage
+static UnityXRStatId m_flDynamicResolutionScale;	// viewport scale the current frame is rendered with
+static UnityXRStatId m_nEyeTexturePoolHits;			// number of eye textures that were reused from the pool instead of created
+static UnityXRStatId m_flEyeTexturePoolSizeMB;		// estimated VRAM held by the eye texture pool
+static UnityXRStatId m_flQuadViewShadedPixelRatio;	// pixels shaded with quad view rendering relative to rendering the eye textures directly
+static UnityXRStatId m_flPoseAgeAtSubmitInMs;		// time between the compositor handing out the pose a frame was rendered with and submitting that frame
+static UnityXRStatId m_flSubmitAfterVsyncInMs;		// time between the last vsync and submitting the frame
+static UnityXRStatId m_nTopologyCallsPerFrame;		// runtime calls made to keep the device list up to date this frame
+
+// Viewport scale of the most recent frame, read from managed code
+static std::atomic< float > s_flDynamicResolutionScale( 1.0f );
+
+extern "C" float UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+GetDynamicResolutionScale()
+{
+	return s_flDynamicResolutionScale;
+}
 
 static UnitySubsystemErrorCode UNITY_INTERFACE_API GfxThread_Start( UnitySubsystemHandle handle, void *userData, UnityXRRenderingCapabilities *renderingCaps )
 {
@@ -125,13 +149,24 @@ OpenVRDisplayProvider::OpenVRDisplayProvider() :
 {
 	for ( int i = 0; i < k_nMaxNumStages; ++i )
 	{
+		m_flStageResolutionScale[i] = 1.0f;
+		m_stageRenderPoses[i] = {};
+		m_bStageHasRenderPose[i] = false;
+		m_bQuadViewStagePrepared[i] = false;
+
 		for ( int j = 0; j < 2; ++j )
 		{
 			m_pNativeColorTextures[i][j] = nullptr;
 			m_pNativeDepthTextures[i][j] = nullptr;
 			m_UnityTextures[i][j] = 0;
+			m_UnityWideTextures[i][j] = 0;
+			m_UnityInsetTextures[i][j] = 0;
+			m_pNativeWideTextures[i][j] = nullptr;
+			m_pNativeInsetTextures[i][j] = nullptr;
 		}
 	}
+
+	memset( m_submitDescriptors, 0, sizeof( m_submitDescriptors ) );
 }
 
 
@@ -144,6 +179,7 @@ UnitySubsystemErrorCode OpenVRDisplayProvider::Lifecycle_Initialize( UnitySubsys
 {
 	// Register handles
 	s_DisplayHandle = handle;
+	m_eyeTexturePool.Initialize( s_pXRDisplay, s_pXRDisplayShadingRate, handle );
 	if ( s_pProviderContext )
 	{
 		s_pProviderContext->displayProvider = this;
@@ -193,6 +229,9 @@ UnitySubsystemErrorCode OpenVRDisplayProvider::Lifecycle_Start( UnitySubsystemHa
 	// Reset previous mirror mode
 	m_nPrevMirrorMode = m_nMirrorMode;
 
+	// Map the display config from the last session so the first frame doesn't have to wait on the runtime
+	m_displayConfigCache.Load( UserProjectSettings::GetDisplayConfigCachePath() );
+
 	// Setup mirror subrect defaults
 	SetupMirror();
 
@@ -225,8 +264,13 @@ void OpenVRDisplayProvider::Lifecycle_Shutdown( UnitySubsystemHandle handle )
 		ReleaseOverlayPointers();
 	}
 
-	// Destroy all eye textures
+	// Destroy all eye textures, once the last composite is done with them
+	m_quadViewCompositor.Shutdown();
 	DestroyEyeTextures( handle );
+	m_eyeTexturePool.Clear();
+	m_fragmentDensityMaps.Shutdown();
+
+	m_displayConfigCache.Close();
 
 	// Explicitly reset member vars as Unity holds on to them in-between editor runs
 	m_nCurFrame = 0;
@@ -253,10 +297,35 @@ UnitySubsystemErrorCode OpenVRDisplayProvider::GfxThread_Start( UnityXRRendering
 
 	case kUnityGfxRendererD3D12:
 		m_eActiveTextureType = vr::TextureType_DirectX12;
+
+		#ifndef __linux__
+		// Grab the command queue the compositor should use once, from the newest interface available
+		if ( IUnityGraphicsD3D12v5 *pD3D12v5 = s_pProviderContext->interfaces->Get< IUnityGraphicsD3D12v5 >() )
+		{
+			m_pD3D12CommandQueue = pD3D12v5->GetCommandQueue();
+		}
+		else if ( IUnityGraphicsD3D12v4 *pD3D12v4 = s_pProviderContext->interfaces->Get< IUnityGraphicsD3D12v4 >() )
+		{
+			m_pD3D12CommandQueue = pD3D12v4->GetCommandQueue();
+		}
+		else if ( IUnityGraphicsD3D12 *pD3D12 = s_pProviderContext->interfaces->Get< IUnityGraphicsD3D12 >() )
+		{
+			m_pD3D12CommandQueue = pD3D12->GetCommandQueue();
+		}
+		#endif
 		break;
 
 	case kUnityGfxRendererVulkan:
 		m_eActiveTextureType = vr::TextureType_Vulkan;
+
+		// The Vulkan instance, device and queue don't change for the lifetime of the renderer
+		m_pUnityVulkan = s_pProviderContext->interfaces->Get< IUnityGraphicsVulkan >();
+		if ( m_pUnityVulkan )
+		{
+			m_unityVulkanInstance = m_pUnityVulkan->Instance();
+			m_fragmentDensityMaps.Initialize( m_pUnityVulkan );
+			m_quadViewCompositor.Initialize( m_pUnityVulkan );
+		}
 		break;
 
 	case kUnityGfxRendererOpenGLCore:
@@ -278,11 +347,15 @@ UnitySubsystemErrorCode OpenVRDisplayProvider::GfxThread_Start( UnityXRRendering
 	renderingCaps->invalidateRenderStateAfterEachCallback = true;
 
 	// Get occlusion mesh/hidden area mesh for both eyes (if available)
+	SetupHiddenAreaMeshes();
 	m_pOcclusionMeshLeftEye = SetupOcclusionMesh( vr::Eye_Left );
 	m_pOcclusionMeshRightEye = SetupOcclusionMesh( vr::Eye_Right );
 
 	m_bIsOverlayApplication = UserProjectSettings::GetInitializationType() == vr::VRApplication_Overlay;
 
+	// The HMD may have changed since the last session
+	InvalidateViewConfigCache();
+
 	return kUnitySubsystemErrorCodeSuccess;
 }
 
@@ -321,6 +394,16 @@ UnitySubsystemErrorCode OpenVRDisplayProvider::GfxThread_PopulateNextFrameDesc(
 	s_pProviderContext->inputProvider->GfxThread_UpdateDevices();
 	m_bIsUsingRGB = frameHints->appSetup.sRGB;
 
+	// The IPD is the only part of the display config that can change without Unity telling us, the pose update above already read it
+	float flIpd = s_pProviderContext->inputProvider->GfxThread_GetUserIpd();
+
+	// Check the cached display config against the runtime once the first frame is out, or right away if the IPD changed
+	if ( m_displayConfigCache.HasConfig()
+		&& ( ( !m_displayConfigCache.IsValidated() && m_nCurFrame > 0 ) || flIpd != m_displayConfigCache.GetConfig().flIpd ) )
+	{
+		ValidateDisplayConfig();
+	}
+
 	TryUpdateMirrorMode();
 
 	// Check if engine requested a change of the viewport
@@ -359,37 +442,130 @@ UnitySubsystemErrorCode OpenVRDisplayProvider::GfxThread_PopulateNextFrameDesc(
 		m_bTexturesCreated = false;
 	}
 
+	// Check if depth submission was toggled at runtime
+	if ( m_bTexturesCreated && m_bSubmitDepth != UserProjectSettings::GetDepthSubmissionEnabled() )
+	{
+		BuildSubmitDescriptors();
+	}
+
+	// Check if the number of stages or foveation were changed at runtime
+	if ( m_bTexturesCreated && ( m_nNumStages != UserProjectSettings::GetDisplayStageCount() || m_bFoveationRequested != ( UserProjectSettings::GetFoveationLevel() != FoveationLevel_Off )
+		|| m_bQuadViewRequested != UserProjectSettings::GetQuadViewEnabled()
+		|| m_flQuadViewInsetFraction != UserProjectSettings::GetQuadViewInsetFraction()
+		|| m_flQuadViewWideScale != UserProjectSettings::GetQuadViewWideScale() ) )
+	{
+		if ( s_DisplayHandle )
+			DestroyEyeTextures( s_DisplayHandle );
+
+		m_bTexturesCreated = false;
+	}
+
 	if ( !m_bTexturesCreated )
 	{
 		ret = CreateEyeTextures( frameHints );
 	}
 
+	// Return the stages the compositor has finished with and pick one for this frame
+	vr::Compositor_FrameTiming pTiming = {};
+	pTiming.m_nSize = sizeof( vr::Compositor_FrameTiming );
+	bool bHasFrameTiming = vr::VRCompositor() && vr::VRCompositor()->GetFrameTiming( &pTiming, 0 );
+
+	if ( bHasFrameTiming )
+	{
+		ReclaimStages( pTiming.m_nFrameIndex );
+	}
+
+	int nNumFreeStages = m_nNumFreeStages;
+	if ( m_nCurStage < 0 )
+	{
+		m_nCurStage = AcquireStage();
+	}
+
+	// Keep the pose Unity renders this frame with alongside the stage, by submit time the main thread may have published the
+	// next one. A pose already latched for an earlier frame doesn't belong to this one.
+	RenderPose renderPose;
+	if ( s_pProviderContext->inputProvider->GfxThread_GetRenderPose( renderPose ) && renderPose.nSequence != m_nLastLatchedRenderPoseSequence )
+	{
+		m_stageRenderPoses[m_nCurStage] = renderPose;
+		m_bStageHasRenderPose[m_nCurStage] = true;
+		m_nLastLatchedRenderPoseSequence = renderPose.nSequence;
+	}
+	else if ( m_stageRenderPoses[m_nCurStage].nSequence != m_nLastLatchedRenderPoseSequence )
+	{
+		m_bStageHasRenderPose[m_nCurStage] = false;
+	}
+
+	// Drive the eye viewport scale from the compositor timing (textures stay at full size)
+	m_dynamicResolution.SetPolicy( UserProjectSettings::GetDynamicResolutionPolicy() );
+	m_dynamicResolution.SetScaleRange( UserProjectSettings::GetDynamicResolutionMinScale(), UserProjectSettings::GetDynamicResolutionMaxScale() );
+
+	float flDisplayFrequency = 0.0f;
+	if ( bHasFrameTiming && vr::VRSystem() && ( s_pXRStats || m_dynamicResolution.GetPolicy() != DynamicResolutionPolicy_Disabled ) )
+	{
+		flDisplayFrequency = vr::VRSystem()->GetFloatTrackedDeviceProperty( vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float );
+		m_dynamicResolution.Update( pTiming, flDisplayFrequency );
+	}
+
+	// Quad view composites whole textures, the wide view already renders at a reduced resolution
+	m_flStageResolutionScale[m_nCurStage] = m_bQuadViewActive ? 1.0f : m_dynamicResolution.GetScale();
+	SetStageTextureBounds( m_nCurStage, m_flStageResolutionScale[m_nCurStage] );
+	s_flDynamicResolutionScale = m_dynamicResolution.GetScale();
+
+	// The density maps have to cover the part of the eye texture this stage renders into
+	if ( m_bFoveationActive )
+	{
+		UpdateFoveation( m_flStageResolutionScale[m_nCurStage] );
+	}
+
+
+	// Refresh eye poses and projections if the near/far planes or IPD changed
+	UpdateViewConfigCache( frameHints, flIpd );
+
+	if ( m_bSubmitDepth )
+	{
+		m_submitDescriptors[m_nCurStage][vr::Eye_Left].texture.depth.mProjection = m_viewConfigCache[vr::Eye_Left].depthProjection;
+		m_submitDescriptors[m_nCurStage][vr::Eye_Right].texture.depth.mProjection = m_viewConfigCache[vr::Eye_Right].depthProjection;
+	}
 
 	// Calculate culling frustum
-	if ( m_bUseSinglePass )
+	if ( m_bQuadViewActive )
 	{
-		// Single pass
-		SetupCullingPass( 2, frameHints, nextFrame->cullingPasses[0] );
+		// The eye textures get composited into from the quad views, make sure they're readable by then
+		if ( !m_bQuadViewStagePrepared[m_nCurStage] )
+		{
+			m_quadViewCompositor.Prepare( GetNativeEyeTexture( m_nCurStage, vr::Eye_Left ) );
+			m_quadViewCompositor.Prepare( GetNativeEyeTexture( m_nCurStage, vr::Eye_Right ) );
+			m_bQuadViewStagePrepared[m_nCurStage] = true;
+		}
+
+		SetupQuadViewPasses( nextFrame );
 	}
 	else
 	{
-		// Multi-pass
-		SetupCullingPass( vr::Eye_Left, frameHints, nextFrame->cullingPasses[0] );
-		SetupCullingPass( vr::Eye_Right, frameHints, nextFrame->cullingPasses[1] );
-	}
+		m_bSharedCulling = !m_bUseSinglePass && UserProjectSettings::GetSharedCullingEnabled();
+
+		if ( m_bUseSinglePass || m_bSharedCulling )
+		{
+			// Single pass, or multi-pass with both render passes culled against the combined frustum
+			SetupCullingPass( 2, nextFrame->cullingPasses[0] );
+		}
+		else
+		{
+			// Multi-pass
+			SetupCullingPass( vr::Eye_Left, nextFrame->cullingPasses[0] );
+			SetupCullingPass( vr::Eye_Right, nextFrame->cullingPasses[1] );
+		}
 
-	SetupRenderPass( vr::Eye_Left, frameHints, nextFrame );
-	SetupRenderPass( vr::Eye_Right, frameHints, nextFrame );
+		SetupRenderPass( vr::Eye_Left, frameHints, nextFrame );
+		SetupRenderPass( vr::Eye_Right, frameHints, nextFrame );
+	}
 
 	m_bFrameInFlight = true;
 
 	// Set frame stats
 	if ( s_pXRStats )
 	{
-		vr::Compositor_FrameTiming pTiming = {};
-		pTiming.m_nSize = sizeof( vr::Compositor_FrameTiming );
-
-		if ( vr::VRCompositor() && vr::VRCompositor()->GetFrameTiming( &pTiming, 0 ) )
+		if ( bHasFrameTiming )
 		{
 			// Unity XRStats in this version only exposes floats
 			// Since we are in the gfx thread, we do NOT need to call increment frame here for XRStats
@@ -400,9 +576,20 @@ UnitySubsystemErrorCode OpenVRDisplayProvider::GfxThread_PopulateNextFrameDesc(
 			s_pXRStats->SetStatFloat( m_flCPURenderTimeInMs, pTiming.m_flCompositorRenderCpuMs );
 			s_pXRStats->SetStatFloat( m_flCPUIdelTimeInMs, pTiming.m_flCompositorIdleCpuMs );
 			s_pXRStats->SetStatFloat( m_flCompositorRenderTimeInMs, pTiming.m_flCompositorRenderGpuMs );
-            s_pXRStats->SetStatFloat( m_flRefreshRate, vr::VRSystem()->GetFloatTrackedDeviceProperty(0, 
-				vr::ETrackedDeviceProperty::Prop_DisplayFrequency_Float));
+            s_pXRStats->SetStatFloat( m_flRefreshRate, flDisplayFrequency );
 		}
+
+		s_pXRStats->SetStatFloat( s_nViewConfigCacheHitsStat, (float )m_nViewConfigCacheHits );
+		s_pXRStats->SetStatFloat( s_nViewConfigCacheMissesStat, (float )m_nViewConfigCacheMisses );
+		s_pXRStats->SetStatFloat( m_nStageRingStarvedFrames, (float )m_nNumStarvedFrames );
+		s_pXRStats->SetStatFloat( m_nStageRingFreeStages, (float )nNumFreeStages );
+		s_pXRStats->SetStatFloat( m_flDynamicResolutionScale, m_flStageResolutionScale[m_nCurStage] );
+		s_pXRStats->SetStatFloat( m_nEyeTexturePoolHits, (float )m_eyeTexturePool.GetNumHits() );
+		s_pXRStats->SetStatFloat( m_flEyeTexturePoolSizeMB, (float )m_eyeTexturePool.GetSizeBytes() / ( 1024.0f * 1024.0f ) );
+		s_pXRStats->SetStatFloat( m_flQuadViewShadedPixelRatio, m_bQuadViewActive ? m_flQuadViewShadedPixelRatioValue : 1.0f );
+		s_pXRStats->SetStatFloat( m_flPoseAgeAtSubmitInMs, m_flLastPoseAgeAtSubmitMs );
+		s_pXRStats->SetStatFloat( m_flSubmitAfterVsyncInMs, m_flLastSubmitAfterVsyncMs );
+		s_pXRStats->SetStatFloat( m_nTopologyCallsPerFrame, (float )s_pProviderContext->inputProvider->GfxThread_GetTopologyCallsPerFrame() );
 	}
 
 	return ret;
@@ -411,18 +598,44 @@ UnitySubsystemErrorCode OpenVRDisplayProvider::GfxThread_PopulateNextFrameDesc(
 
 UnitySubsystemErrorCode OpenVRDisplayProvider::GfxThread_SubmitCurrentFrame()
 {
-	if ( !m_bFrameInFlight )
+	if ( !m_bFrameInFlight || m_nCurStage < 0 )
 		return kUnitySubsystemErrorCodeSuccess;
 
 	// Get the stage for the current frame
-	int stage = m_nCurFrame % m_nNumStages;
+	int stage = m_nCurStage;
+	m_nCurStage = -1;
 
 	// Advance frame number
 	m_nCurFrame = ( m_nCurFrame < UINT32_MAX ) ? m_nCurFrame + 1 : 0;
 
-	// Send eye textures for this stage to the compositor
-	SubmitToCompositor( vr::Eye_Left, stage );
-	SubmitToCompositor( vr::Eye_Right, stage );
+	// Build the eye textures out of the quad views before the compositor reads them
+	bool bHasEyeTextures = true;
+	if ( m_bQuadViewActive )
+	{
+		void *pWideTextures[2] = { GetNativeQuadViewTexture( stage, vr::Eye_Left, false ), GetNativeQuadViewTexture( stage, vr::Eye_Right, false ) };
+		void *pInsetTextures[2] = { GetNativeQuadViewTexture( stage, vr::Eye_Left, true ), GetNativeQuadViewTexture( stage, vr::Eye_Right, true ) };
+		void *pEyeTextures[2] = { GetNativeEyeTexture( stage, vr::Eye_Left ), GetNativeEyeTexture( stage, vr::Eye_Right ) };
+		bHasEyeTextures = m_quadViewCompositor.Composite( stage, pWideTextures, pInsetTextures, pEyeTextures, m_quadViewPlans );
+	}
+
+	// Send eye textures for this stage to the compositor. If compositing failed they hold a stale or unfinished frame,
+	// skipping the submit lets the compositor reproject the last good one instead.
+	if ( bHasEyeTextures )
+	{
+		SubmitStageToCompositor( stage );
+	}
+
+	// The compositor owns this stage until it has moved past the frame it was submitted in
+	vr::Compositor_FrameTiming pTiming = {};
+	pTiming.m_nSize = sizeof( vr::Compositor_FrameTiming );
+	if ( vr::VRCompositor() && vr::VRCompositor()->GetFrameTiming( &pTiming, 0 ) )
+	{
+		SubmitStage( stage, pTiming.m_nFrameIndex );
+	}
+	else
+	{
+		SubmitStage( stage, 0 );
+	}
 
 	// Tell the compositor it can start rendering immediately
 	if ( vr::VRCompositor() )
@@ -485,6 +698,7 @@ UnitySubsystemErrorCode OpenVRDisplayProvider::GfxThread_BlitToMirrorViewRenderT
 UnitySubsystemErrorCode OpenVRDisplayProvider::GfxThread_Stop()
 {
 	m_nCurFrame = 0;
+	m_nCurStage = -1;
 
 	// Clean-up occlusion meshes
 	if ( m_pOcclusionMeshLeftEye != 0 )
@@ -538,9 +752,10 @@ UnitySubsystemErrorCode OpenVRDisplayProvider::MainThread_QueryMirrorViewBlitDes
 		flSourceAspect = static_cast< float >( m_nRenderMirrorWidth ) / static_cast< float >( m_nRenderMirrorHeight );
 	}
 
-	// Set default mirror blit
-	int stage = m_nCurFrame % m_nNumStages;
+	// Set default mirror blit from the newest finished frame
+	int stage = m_nLastSubmittedStage;
 	int32_t nTextureArraySlice = 0;
+	bool bIsEyeTextureMirror = true;
 	m_pMirrorTexture = m_UnityTextures[stage][0];
 
 	// Check the current mirror mode
@@ -556,6 +771,7 @@ UnitySubsystemErrorCode OpenVRDisplayProvider::MainThread_QueryMirrorViewBlitDes
 
 		// Set the mirror texture to the SteamVR mirror texture
 		m_pMirrorTexture = m_pSteamVRTextureId;
+		bIsEyeTextureMirror = false;
 	}
 	else
 	{
@@ -594,6 +810,15 @@ UnitySubsystemErrorCode OpenVRDisplayProvider::MainThread_QueryMirrorViewBlitDes
 
 	vSourceUV0 = { vSourceUVCenter.x - ( vSourceUVSize.x * 0.5f ), vSourceUVCenter.y - ( vSourceUVSize.y * 0.5f ) };
 	vSourceUV1 = { vSourceUV0.x + vSourceUVSize.x, vSourceUV0.y + vSourceUVSize.y };
+
+	// Eye textures are only partially rendered to when dynamic resolution is scaling down. Use the scale the mirrored
+	// stage was rendered with, the controller may already have moved on for the frame being rendered.
+	if ( bIsEyeTextureMirror )
+	{
+		float flResolutionScale = m_flStageResolutionScale[stage];
+		vSourceUV0 = { vSourceUV0.x * flResolutionScale, vSourceUV0.y * flResolutionScale };
+		vSourceUV1 = { vSourceUV1.x * flResolutionScale, vSourceUV1.y * flResolutionScale };
+	}
 	vDestUV0 = { vDestUVCenter.x - vDestUVSize.x * 0.5f, vDestUVCenter.y - vDestUVSize.y * 0.5f };
 	vDestUV1 = { vDestUV0.x + vDestUVSize.x, vDestUV0.y + vDestUVSize.y };
 
@@ -653,11 +878,23 @@ void OpenVRDisplayProvider::SetupMirror()
 		m_flCPUIdelTimeInMs = s_pXRStats->RegisterStatDefinition( s_DisplayHandle, "OpenVR.CPUIdleTimeMs", kUnityXRStatOptionNone );
 		m_flCompositorRenderTimeInMs = s_pXRStats->RegisterStatDefinition( s_DisplayHandle, kUnityStatsGPUTimeCompositor, kUnityXRStatOptionNone );
         m_flRefreshRate = s_pXRStats->RegisterStatDefinition( s_DisplayHandle, kUnityStatsDisplayRefreshRate, kUnityXRStatOptionNone );
+		s_nViewConfigCacheHitsStat = s_pXRStats->RegisterStatDefinition( s_DisplayHandle, "OpenVR.ViewConfigCacheHits", kUnityXRStatOptionNone );
+		s_nViewConfigCacheMissesStat = s_pXRStats->RegisterStatDefinition( s_DisplayHandle, "OpenVR.ViewConfigCacheMisses", kUnityXRStatOptionNone );
+		m_nStageRingStarvedFrames = s_pXRStats->RegisterStatDefinition( s_DisplayHandle, "OpenVR.StageRingStarvedFrames", kUnityXRStatOptionNone );
+		m_nStageRingFreeStages = s_pXRStats->RegisterStatDefinition( s_DisplayHandle, "OpenVR.StageRingFreeStages", kUnityXRStatOptionNone );
+		m_flDynamicResolutionScale = s_pXRStats->RegisterStatDefinition( s_DisplayHandle, "OpenVR.DynamicResolutionScale", kUnityXRStatOptionNone );
+		m_nEyeTexturePoolHits = s_pXRStats->RegisterStatDefinition( s_DisplayHandle, "OpenVR.EyeTexturePoolHits", kUnityXRStatOptionNone );
+		m_flEyeTexturePoolSizeMB = s_pXRStats->RegisterStatDefinition( s_DisplayHandle, "OpenVR.EyeTexturePoolSizeMB", kUnityXRStatOptionNone );
+		m_flQuadViewShadedPixelRatio = s_pXRStats->RegisterStatDefinition( s_DisplayHandle, "OpenVR.QuadViewShadedPixelRatio", kUnityXRStatOptionNone );
+		m_flPoseAgeAtSubmitInMs = s_pXRStats->RegisterStatDefinition( s_DisplayHandle, "OpenVR.PoseAgeAtSubmitInMs", kUnityXRStatOptionNone );
+		m_flSubmitAfterVsyncInMs = s_pXRStats->RegisterStatDefinition( s_DisplayHandle, "OpenVR.SubmitAfterVsyncInMs", kUnityXRStatOptionNone );
+		m_nTopologyCallsPerFrame = s_pXRStats->RegisterStatDefinition( s_DisplayHandle, "OpenVR.TopologyCallsPerFrame", kUnityXRStatOptionNone );
 	}
 
 
 	// Get recommended render target size based on currently active hmd
-	vr::VRSystem()->GetRecommendedRenderTargetSize( &m_nEyeWidth, &m_nEyeHeight );
+	m_nEyeWidth = m_displayConfigCache.GetConfig().nRecommendedWidth;
+	m_nEyeHeight = m_displayConfigCache.GetConfig().nRecommendedHeight;
 	m_nEyeMirrorWidth = m_nEyeWidth;
 	m_nEyeMirrorHeight = m_nEyeHeight;
 
@@ -710,124 +947,193 @@ void OpenVRDisplayProvider::SetupMirror()
 	}
 }
 
-bool OpenVRDisplayProvider::SubmitToCompositor( vr::EVREye eEye, int nStage )
+void OpenVRDisplayProvider::BuildSubmitDescriptors()
 {
-	if ( !vr::VRCompositor() )
-		return false;
+	// The compositor only takes depth from D3D here, Unity doesn't expose native Vulkan or OpenGL depth images
+	m_bSubmitDepth = UserProjectSettings::GetDepthSubmissionEnabled();
+	bool bSubmitDepth = m_bSubmitDepth && ( m_eActiveTextureType == vr::TextureType_DirectX || m_eActiveTextureType == vr::TextureType_DirectX12 );
+
+	if ( m_bSubmitDepth && !bSubmitDepth )
+	{
+		XR_TRACE( "[OpenVR] Depth submission is only supported on D3D11 and D3D12, submitting color only\n" );
+	}
+
+	// Everything except the native handles is known as soon as the eye textures exist
+	for ( int stage = 0; stage < k_nMaxNumStages; ++stage )
+	{
+		for ( int eye = 0; eye < 2; ++eye )
+		{
+			SubmitDescriptor &descriptor = m_submitDescriptors[stage][eye];
+			memset( &descriptor, 0, sizeof( SubmitDescriptor ) );
+
+			descriptor.texture.eType = m_eActiveTextureType;
+			descriptor.texture.eColorSpace = vr::ColorSpace_Auto;
+			descriptor.bounds = m_textureBounds;
+			descriptor.nFlags = vr::Submit_Default;
+
+			if ( m_eActiveTextureType == vr::TextureType_Vulkan )
+			{
+				descriptor.vulkanTexture.m_pPhysicalDevice = m_unityVulkanInstance.physicalDevice;
+				descriptor.vulkanTexture.m_pDevice = m_unityVulkanInstance.device;
+				descriptor.vulkanTexture.m_pInstance = m_unityVulkanInstance.instance;
+				descriptor.vulkanTexture.m_pQueue = m_unityVulkanInstance.graphicsQueue;
+				descriptor.vulkanTexture.m_nQueueFamilyIndex = m_unityVulkanInstance.queueFamilyIndex;
+				descriptor.vulkanTexture.m_unArraySize = m_bUseSinglePass ? 2 : 1;
+				descriptor.vulkanTexture.m_unArrayIndex = m_bUseSinglePass ? eye : 0;
+				descriptor.texture.handle = &descriptor.vulkanTexture;
+				descriptor.nFlags = vr::Submit_VulkanTextureWithArrayData;
+			}
+			#ifndef __linux__
+			else if ( m_eActiveTextureType == vr::TextureType_DirectX12 )
+			{
+				descriptor.d3d12Texture.m_pCommandQueue = m_pD3D12CommandQueue;
+				descriptor.d3d12Texture.m_nNodeMask = 1;
+				descriptor.texture.handle = &descriptor.d3d12Texture;
+				descriptor.d3d12DepthTexture.m_pCommandQueue = m_pD3D12CommandQueue;
+				descriptor.d3d12DepthTexture.m_nNodeMask = 1;
+			}
+			#endif
+
+			if ( bSubmitDepth )
+			{
+				descriptor.nFlags = (vr::EVRSubmitFlags )( descriptor.nFlags | vr::Submit_TextureWithDepth );
+				descriptor.texture.depth.vRange = { { 0.0f, 1.0f } };
+			}
+		}
+	}
+}
 
 
+bool OpenVRDisplayProvider::ResolveSubmitDescriptor( int nStage, int nEye )
+{
 	// Use the left eye texture if we're doing a single pass
-	int nTexIndex = m_bUseSinglePass ? vr::Eye_Left : eEye;
+	int nTexIndex = m_bUseSinglePass ? vr::Eye_Left : nEye;
+
+	SubmitDescriptor &descriptor = m_submitDescriptors[nStage][nEye];
+	descriptor.pNativeTexture = GetNativeEyeTexture( nStage, nTexIndex );
+
+	if ( !descriptor.pNativeTexture )
+		return false;
 
-	// Check for Vulkan support
 	if ( m_eActiveTextureType == vr::TextureType_Vulkan )
 	{
-		if ( s_pProviderContext->interfaces->Get<IUnityGraphicsVulkan>()->AccessTexture( GetNativeEyeTexture( nStage, nTexIndex ),
-			UnityVulkanWholeImage,
-			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-			VK_ACCESS_SHADER_READ_BIT,
-			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-			kUnityVulkanResourceAccess_ObserveOnly,
-			&m_unityVulkanImage )
-			)
+		UnityVulkanImage unityVulkanImage;
+		if ( !m_pUnityVulkan || !m_pUnityVulkan->AccessTexture( descriptor.pNativeTexture, UnityVulkanWholeImage, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, kUnityVulkanResourceAccess_ObserveOnly, &unityVulkanImage ) )
 		{
-			// Vulkan image information
-			m_vrVulkanTexture.m_nImage = (uint64_t )m_unityVulkanImage.image;
-			m_vrVulkanTexture.m_nWidth = m_unityVulkanImage.extent.width;
-			m_vrVulkanTexture.m_nHeight = m_unityVulkanImage.extent.height;
-			m_vrVulkanTexture.m_nFormat = m_unityVulkanImage.format;
-			m_vrVulkanTexture.m_nSampleCount = m_unityVulkanImage.samples;
-			m_vrVulkanTexture.m_pPhysicalDevice = s_pProviderContext->interfaces->Get<IUnityGraphicsVulkan>()->Instance().physicalDevice;
-			m_vrVulkanTexture.m_pDevice = s_pProviderContext->interfaces->Get<IUnityGraphicsVulkan>()->Instance().device;
-			m_vrVulkanTexture.m_pInstance = s_pProviderContext->interfaces->Get<IUnityGraphicsVulkan>()->Instance().instance;
-			m_vrVulkanTexture.m_pQueue = s_pProviderContext->interfaces->Get<IUnityGraphicsVulkan>()->Instance().graphicsQueue;
-			m_vrVulkanTexture.m_nQueueFamilyIndex = s_pProviderContext->interfaces->Get<IUnityGraphicsVulkan>()->Instance().queueFamilyIndex;
-
-			// Array specific data
-			m_vrVulkanTexture.m_unArraySize = m_bUseSinglePass ? 2 : 1;
-			m_vrVulkanTexture.m_unArrayIndex = ( m_bUseSinglePass && eEye == vr::Eye_Right ) ? 1 : 0;
-		}
-		else
-		{
-			XR_TRACE( "[OpenVR] [Error] Unable to get Vulkan texture for stage %i and eye %i\n", nStage, eEye );
+			XR_TRACE( "[OpenVR] [Error] Unable to get Vulkan texture for stage %i and eye %i\n", nStage, nEye );
 			return false;
 		}
+
+		// Vulkan image information
+		descriptor.vulkanTexture.m_nImage = (uint64_t )unityVulkanImage.image;
+		descriptor.vulkanTexture.m_nWidth = unityVulkanImage.extent.width;
+		descriptor.vulkanTexture.m_nHeight = unityVulkanImage.extent.height;
+		descriptor.vulkanTexture.m_nFormat = unityVulkanImage.format;
+		descriptor.vulkanTexture.m_nSampleCount = unityVulkanImage.samples;
 	}
 	#ifndef __linux__
 	else if ( m_eActiveTextureType == vr::TextureType_DirectX12 )
 	{
-		ID3D12Resource *pD3D12Resource = (ID3D12Resource * )GetNativeEyeTexture( nStage, nTexIndex );
-		if ( !pD3D12Resource )
-		{
-			XR_TRACE( "[OpenVR] [Error] Unable to get D3D12 resource for stage %i and eye %i\n", nStage, eEye );
-			return false;
-		}
-
-		IUnityGraphicsD3D12v5 *pD3D12v5 = s_pProviderContext->interfaces->Get<IUnityGraphicsD3D12v5>();
-		IUnityGraphicsD3D12v4 *pD3D12v4 = s_pProviderContext->interfaces->Get<IUnityGraphicsD3D12v4>();
-		IUnityGraphicsD3D12 *pD3D12 = s_pProviderContext->interfaces->Get<IUnityGraphicsD3D12>();
-
-		ID3D12CommandQueue *pCommandQueue = nullptr;
-		if ( pD3D12v5 )
-		{
-			pCommandQueue = pD3D12v5->GetCommandQueue();
-		}
-		else if ( pD3D12v4 )
+		if ( !m_pD3D12CommandQueue )
 		{
-			pCommandQueue = pD3D12v4->GetCommandQueue();
-		}
-		else if ( pD3D12 )
-		{
-			pCommandQueue = pD3D12->GetCommandQueue();
-		}
-
-		if ( !pCommandQueue )
-		{
-			XR_TRACE( "[OpenVR] [Error] Unable to get D3D12 command queue for stage %i and eye %i\n", nStage, eEye );
+			XR_TRACE( "[OpenVR] [Error] Unable to get D3D12 command queue for stage %i and eye %i\n", nStage, nEye );
 			return false;
 		}
 
-		m_vrD3D12Texture.m_pResource = pD3D12Resource;
-		m_vrD3D12Texture.m_pCommandQueue = pCommandQueue;
-		m_vrD3D12Texture.m_nNodeMask = 1; 
-
-		XR_TRACE( "[OpenVR] D3D12 Resource: %p, CommandQueue: %p for stage %i eye %i\n", 
-			pD3D12Resource, pCommandQueue, nStage, eEye );
+		descriptor.d3d12Texture.m_pResource = (ID3D12Resource * )descriptor.pNativeTexture;
 	}
 	#endif
+	else
+	{
+		descriptor.texture.handle = descriptor.pNativeTexture;
+	}
 
-	// Grab the correct texture for this stage
-	vr::VRTextureWithDepth_t tex;
-	if ( m_eActiveTextureType == vr::TextureType_Vulkan )
+	// Check if we have a valid depth buffer
+	void *pNativeDepthTexture = m_pNativeDepthTextures[nStage][nTexIndex];
+	if ( m_eActiveTextureType == vr::TextureType_DirectX )
 	{
-		tex.handle = &m_vrVulkanTexture;
+		descriptor.texture.depth.handle = pNativeDepthTexture;
 	}
 	#ifndef __linux__
-	else if ( m_eActiveTextureType == vr::TextureType_DirectX12 )
+	else if ( m_eActiveTextureType == vr::TextureType_DirectX12 && pNativeDepthTexture )
 	{
-		tex.handle = &m_vrD3D12Texture;
+		descriptor.d3d12DepthTexture.m_pResource = (ID3D12Resource * )pNativeDepthTexture;
+		descriptor.texture.depth.handle = &descriptor.d3d12DepthTexture;
 	}
 	#endif
-	else
+
+	// Don't claim to submit depth without a depth buffer
+	if ( !descriptor.texture.depth.handle )
 	{
-		tex.handle = GetNativeEyeTexture( nStage, nTexIndex );
+		descriptor.nFlags = (vr::EVRSubmitFlags )( descriptor.nFlags & ~vr::Submit_TextureWithDepth );
 	}
-	tex.eType = m_eActiveTextureType;
-	tex.eColorSpace = vr::ColorSpace_Auto;
 
-	// Check if we have a valid depth buffer
-	if ( m_pNativeDepthTextures[nStage][nTexIndex] )
+	descriptor.bResolved = true;
+	return true;
+}
+
+
+bool OpenVRDisplayProvider::SubmitStageToCompositor( int nStage )
+{
+	if ( !vr::VRCompositor() || m_bIsOverlayApplication )
+		return false;
+
+	SubmitDescriptor *pDescriptors = m_submitDescriptors[nStage];
+
+	// Native handles may not exist until Unity has rendered into the textures once
+	for ( int eye = 0; eye < 2; ++eye )
+	{
+		if ( !pDescriptors[eye].bResolved && !ResolveSubmitDescriptor( nStage, eye ) )
+			return false;
+	}
+
+	// Vulkan needs the image transitioned for the compositor every frame, single pass shares one image between both eyes
+	if ( m_pUnityVulkan )
+	{
+		UnityVulkanImage unityVulkanImage;
+		int nNumImages = m_bUseSinglePass ? 1 : 2;
+		for ( int eye = 0; eye < nNumImages; ++eye )
+		{
+			m_pUnityVulkan->AccessTexture( pDescriptors[eye].pNativeTexture, UnityVulkanWholeImage, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, kUnityVulkanResourceAccess_ObserveOnly, &unityVulkanImage );
+		}
+	}
+
+	// Submit the pose the frame was rendered with, so the compositor reprojects from that pose instead of assuming the latest one
+	const RenderPose &renderPose = m_stageRenderPoses[nStage];
+	bool bHasRenderPose = m_bStageHasRenderPose[nStage] && renderPose.hmdPose.bPoseIsValid;
+	uint64_t nNowNs = TimeDomain::GetNowNs();
+	if ( bHasRenderPose )
+	{
+		m_flLastPoseAgeAtSubmitMs = (float )( nNowNs - renderPose.nSampleTimeNs ) / 1000000.0f;
+	}
+
+	uint64_t nLastVsyncNs = TimeDomain::Get().GetLastVsyncNs();
+	if ( nLastVsyncNs != 0 && nLastVsyncNs <= nNowNs )
 	{
-		tex.depth.handle = m_pNativeDepthTextures[nStage][nTexIndex];
+		m_flLastSubmitAfterVsyncMs = (float )( nNowNs - nLastVsyncNs ) / 1000000.0f;
 	}
 
-	if ( !m_bIsOverlayApplication )
+	bool bSubmitted = true;
+	for ( int eye = 0; eye < 2; ++eye )
 	{
-		// OpenVR submission flags
-		vr::EVRSubmitFlags nFlags = m_eActiveTextureType == vr::TextureType_Vulkan ? vr::Submit_VulkanTextureWithArrayData : vr::Submit_Default;
+		SubmitDescriptor &descriptor = pDescriptors[eye];
+
+		// The texture is laid out as VRTextureWithPoseAndDepth_t, the compositor only finds the depth info behind a pose
+		vr::EVRSubmitFlags nFlags = descriptor.nFlags;
+		if ( bHasRenderPose )
+		{
+			descriptor.texture.mDeviceToAbsoluteTracking = renderPose.hmdPose.mDeviceToAbsoluteTracking;
+			nFlags = (vr::EVRSubmitFlags )( nFlags | vr::Submit_TextureWithPose );
+		}
+		else
+		{
+			nFlags = (vr::EVRSubmitFlags )( nFlags & ~vr::Submit_TextureWithDepth );
+		}
 
 		// Submit the texture to the Compositor
-		vr::EVRCompositorError res = vr::VRCompositor()->Submit( eEye, &tex, &m_textureBounds, nFlags );
+		vr::EVRCompositorError res = vr::VRCompositor()->Submit( (vr::EVREye )eye, &descriptor.texture, &descriptor.bounds, nFlags );
 
 		if ( res != vr::VRCompositorError_None )
 		{
@@ -847,12 +1153,24 @@ bool OpenVRDisplayProvider::SubmitToCompositor( vr::EVREye eEye, int nStage )
 				default: break;
 			}
 			XR_TRACE( "[OpenVR] [Error] Unable to submit eye %i texture for stage %i: [%i - %s] handle: %p, type: %i\n", 
-				eEye, nStage, res, errorName, tex.handle, tex.eType );
-			return false;
+				eye, nStage, res, errorName, descriptor.texture.handle, descriptor.texture.eType );
+			bSubmitted = false;
 		}
 	}
 
-	return true;
+	return bSubmitted;
+}
+
+
+void OpenVRDisplayProvider::SetStageTextureBounds( int nStage, float flResolutionScale )
+{
+	// Only submit the part of the texture that was rendered to, Unity viewports start at the bottom left while texture bounds start at the top left
+	vr::VRTextureBounds_t textureBounds = m_textureBounds;
+	textureBounds.uMax = textureBounds.uMin + ( textureBounds.uMax - textureBounds.uMin ) * flResolutionScale;
+	textureBounds.vMin = textureBounds.vMax - ( textureBounds.vMax - textureBounds.vMin ) * flResolutionScale;
+
+	m_submitDescriptors[nStage][vr::Eye_Left].bounds = textureBounds;
+	m_submitDescriptors[nStage][vr::Eye_Right].bounds = textureBounds;
 }
 
 
@@ -895,15 +1213,17 @@ void OpenVRDisplayProvider::SetupRenderPass( const vr::EVREye eEye, const UnityX
 
 	// Setup base render pass properties
 	UnityXRNextFrameDesc::UnityXRRenderPass &renderPass = pTargetFrame->renderPasses[nRenderPasses];
-	renderPass.textureId = m_UnityTextures[m_nCurFrame % m_nNumStages][nTextureIndex];
+	renderPass.textureId = m_UnityTextures[m_nCurStage][nTextureIndex];
 	renderPass.renderParamsCount = nRenderParamsCount;
-	renderPass.cullingPassIndex = nRenderPasses;
+	renderPass.cullingPassIndex = m_bSharedCulling ? 0 : nRenderPasses;
 
-	// Setup base render pass parameters
+	// Setup base render pass parameters from the view config cache
+	const ViewConfig &viewConfig = m_viewConfigCache[eEye];
 	UnityXRNextFrameDesc::UnityXRRenderPass::UnityXRRenderParams &renderParams = renderPass.renderParams[nParamsCount];
-	renderParams.deviceAnchorToEyePose = GetEyePose( eEye );
-	renderParams.projection = GetProjection( eEye, pFrameHints->appSetup.zNear, pFrameHints->appSetup.zFar );
-	renderParams.viewportRect = { 0.0f, 0.0f, 1.0f, 1.0f };
+	renderParams.deviceAnchorToEyePose = viewConfig.eyePose;
+	renderParams.projection = viewConfig.projection;
+	float flResolutionScale = m_flStageResolutionScale[m_nCurStage];
+	renderParams.viewportRect = { 0.0f, 0.0f, flResolutionScale, flResolutionScale };
 	renderParams.textureArraySlice = nTextureArraySlice;
 
 	// Set an occlusion mesh (hidden area mesh) if there's a valid one
@@ -918,45 +1238,36 @@ void OpenVRDisplayProvider::SetupRenderPass( const vr::EVREye eEye, const UnityX
 }
 
 
+void OpenVRDisplayProvider::SetupHiddenAreaMeshes()
+{
+	// Weld duplicate vertices into compact vertex and index buffers, an empty mesh means the HMD doesn't have that type
+	for ( int type = 0; type < vr::k_eHiddenAreaMesh_Max; ++type )
+	{
+		for ( int eye = 0; eye < 2; ++eye )
+		{
+			const vr::HiddenAreaMesh_t &vrHiddenMesh = m_displayConfigCache.GetConfig().hiddenAreaMesh[type][eye];
+			WeldHiddenAreaMesh( vrHiddenMesh, (vr::EHiddenAreaMeshType )type, k_flDefaultHiddenAreaMeshWeldEpsilon, m_hiddenAreaMeshes[type][eye] );
+		}
+	}
+}
+
+
 UnityXROcclusionMeshId OpenVRDisplayProvider::SetupOcclusionMesh( vr::EVREye eEye )
 {
 	if ( !vr::VRSystem() )
 		return k_nInvalidUnityXROcclusionMeshId;
 
-	// Grab the hidden area mesh from SteamVR
-	vr::HiddenAreaMesh_t vrHiddenMesh = vr::VRSystem()->GetHiddenAreaMesh( eEye, vr::k_eHiddenAreaMesh_Standard );
+	// Grab the welded standard hidden area mesh
+	WeldedHiddenAreaMesh &weldedMesh = m_hiddenAreaMeshes[vr::k_eHiddenAreaMesh_Standard][eEye];
 
-	if ( vrHiddenMesh.pVertexData == NULL || vrHiddenMesh.unTriangleCount == 0 )
+	if ( weldedMesh.vIndices.empty() )
 	{
 		XR_TRACE( "[OpenVR] No hidden area mesh available for eye[%i] in active hmd\n", eEye );
 		return k_nInvalidUnityXROcclusionMeshId;
 	}
 
-	// Setup our vertex and index arrays
-	std::vector< uint32_t > vIndices( (long long )vrHiddenMesh.unTriangleCount * (long long )3, UINT32_MAX );
-	std::vector< UnityXRVector2 > vVertices;
-	vVertices.reserve( vIndices.size() );
-
-	for ( size_t v1 = 0; v1 < vIndices.size(); v1++ )										// Go through each vertex from OpenVR (may contain duplicates)
-	{
-		if ( vIndices[v1] != UINT32_MAX )                                                 // Skip if already assigned (i.e. was found to be a duplicate)
-			continue;
-
-		uint32_t nIndex = (uint32_t )vVertices.size();										// Record new index
-		vIndices[v1] = nIndex;
-
-		const auto &v = vrHiddenMesh.pVertexData[v1].v;									// Keep this vertex
-		vVertices.push_back( { v[0], v[1] } );
-
-		for ( size_t v2 = v1 + 1; v2 < vVertices.size(); v2++ )								// Check remaining for duplicate vertices
-		{
-			static const float k_flThreshold = 1e-9f;
-			if ( GetDistanceSquared2D( v, vrHiddenMesh.pVertexData[v2].v ) < k_flThreshold )
-			{
-				vIndices[v2] = nIndex;                                                      // Remap this index to point to similar earlier vertex
-			}
-		}
-	}
+	std::vector< UnityXRVector2 > &vVertices = weldedMesh.vVertices;
+	std::vector< uint32_t > &vIndices = weldedMesh.vIndices;
 
 	// Create a Unity occlusion mesh
 	UnityXROcclusionMeshId pOcclusionMeshId;
@@ -984,15 +1295,6 @@ UnityXROcclusionMeshId OpenVRDisplayProvider::SetupOcclusionMesh( vr::EVREye eEy
 }
 
 
-float OpenVRDisplayProvider::GetDistanceSquared2D( const float *pVector1, const float *pVector2 )
-{
-	float flDiffX = pVector2[0] - pVector1[0];
-	float flDiffY = pVector2[1] - pVector1[1];
-
-	return ( flDiffX * flDiffX ) + ( flDiffY * flDiffY );
-}
-
-
 const UnityXRVector2 OpenVRDisplayProvider::GetRecommendedMirrorResolution()
 {
 	float flWidth = vr::k_unHeadsetViewMaxWidth;
@@ -1016,15 +1318,22 @@ UnityXRPose OpenVRDisplayProvider::GetEyePose( int eye )
 	if ( eye > vr::Eye_Right )
 	{
 		// add depth information to identity matrix that'll serve as "middle eye" pose
-		float fHeadToEyeDepth = vr::VRSystem()->GetFloatTrackedDeviceProperty( vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_UserHeadToEyeDepthMeters_Float, nullptr );
-		vrMat.m[2][3] = fHeadToEyeDepth;
+		vrMat.m[2][3] = m_displayConfigCache.GetConfig().flHeadToEyeDepth;
 	}
 	else
 	{
 		// Get eye specific pose
-		vrMat = vr::VRSystem()->GetEyeToHeadTransform( ( eye == 0 ) ? vr::Eye_Left : vr::Eye_Right );
+		vrMat = m_displayConfigCache.GetConfig().eyeToHead[eye];
 	}
 
+	return HeadTransformToPose( vrMat );
+}
+
+
+UnityXRPose OpenVRDisplayProvider::HeadTransformToPose( const vr::HmdMatrix34_t &vrMat )
+{
+	UnityXRPose ret = { 0 };
+
 	UnityXRMatrix4x4 mat;
 	OpenVRMatrix3x4ToUnity( vrMat, mat );
 
@@ -1037,7 +1346,7 @@ UnityXRPose OpenVRDisplayProvider::GetEyePose( int eye )
 }
 
 
-UnityXRProjection OpenVRDisplayProvider::GetProjection( int eye, float flNear, float flFar )
+UnityXRProjection OpenVRDisplayProvider::GetProjection( int eye, float flNear, float flFar, const float *pRawProjection )
 {
 	UnityXRProjection ret;
 	ret.type = kUnityXRProjectionTypeMatrix;
@@ -1046,28 +1355,38 @@ UnityXRProjection OpenVRDisplayProvider::GetProjection( int eye, float flNear, f
 		return ret;
 
 	float vrL, vrR, vrT, vrB;
+	const DisplayConfig &displayConfig = m_displayConfigCache.GetConfig();
 
-	if ( eye > vr::Eye_Right )
+	if ( pRawProjection )
+	{
+		// Calculate the projection of a custom frustum (e.g. a quad view inset)
+		vrL = pRawProjection[0];
+		vrR = pRawProjection[1];
+		vrT = pRawProjection[2];
+		vrB = pRawProjection[3];
+	}
+	else if ( eye > vr::Eye_Right )
 	{
 		// Calculate combined left + right eye combined projection
-		float leftVrL, leftVrR, leftVrT, leftVrB, rightVrL, rightVrR, rightVrT, rightVrB;
-
-		// Get each eye's projection
-		vr::VRSystem()->GetProjectionRaw( vr::Eye_Left, &leftVrL, &leftVrR, &leftVrT, &leftVrB );
-		vr::VRSystem()->GetProjectionRaw( vr::Eye_Right, &rightVrL, &rightVrR, &rightVrT, &rightVrB );
+		const float *leftVr = displayConfig.rawProjection[vr::Eye_Left];
+		const float *rightVr = displayConfig.rawProjection[vr::Eye_Right];
 
 		// Use the max extent's for each eye 
-		vrL = leftVrL;
-		vrR = rightVrR;
-		vrT = rightVrT;
-		vrB = leftVrB;
+		vrL = leftVr[0];
+		vrR = rightVr[1];
+		vrT = rightVr[2];
+		vrB = leftVr[3];
 
 		//XR_TRACE( "COMBINED EYE PROJECTION: %f %f %f %f\nNear: %f Far: %f\n", vrL, vrR, vrT, vrB, flNear, flFar );
 	}
 	else
 	{
 		// Calculate eye specific projection
-		vr::VRSystem()->GetProjectionRaw( ( eye == 0 ) ? vr::Eye_Left : vr::Eye_Right, &vrL, &vrR, &vrT, &vrB );
+		const float *eyeVr = displayConfig.rawProjection[eye];
+		vrL = eyeVr[0];
+		vrR = eyeVr[1];
+		vrT = eyeVr[2];
+		vrB = eyeVr[3];
 
 		//XR_TRACE( "%i EYE PROJECTION: %f %f %f %f\nNear: %f Far: %f\n", eye, vrL, vrR, vrT, vrB, flNear, flFar );
 	}
@@ -1118,34 +1437,225 @@ UnityXRProjection OpenVRDisplayProvider::GetProjection( int eye, float flNear, f
 }
 
 
-void OpenVRDisplayProvider::SetupCullingPass( int eye, const UnityXRFrameSetupHints *frameHints, UnityXRNextFrameDesc::UnityXRCullingPass &cullingPass )
+void OpenVRDisplayProvider::SetupQuadViewPasses( UnityXRNextFrameDesc *pTargetFrame )
+{
+	// Wide views use passes 0 and 1 and the eye's own culling, the insets passes 2 and 3 with their narrower frustum
+	pTargetFrame->renderPassesCount = 4;
+
+	for ( int eye = 0; eye < 2; ++eye )
+	{
+		const ViewConfig &viewConfig = m_viewConfigCache[eye];
+
+		for ( int view = 0; view < 2; ++view )
+		{
+			bool bInset = view == 1;
+			int nPass = view * 2 + eye;
+
+			UnityXRNextFrameDesc::UnityXRCullingPass &cullingPass = pTargetFrame->cullingPasses[nPass];
+			if ( bInset )
+			{
+				cullingPass.separation = m_flCullingSeparation;
+				cullingPass.deviceAnchorToCullingPose = viewConfig.eyePose;
+				cullingPass.projection = viewConfig.insetProjection;
+			}
+			else
+			{
+				SetupCullingPass( eye, cullingPass );
+			}
+
+			UnityXRNextFrameDesc::UnityXRRenderPass &renderPass = pTargetFrame->renderPasses[nPass];
+			renderPass.textureId = bInset ? m_UnityInsetTextures[m_nCurStage][eye] : m_UnityWideTextures[m_nCurStage][eye];
+			renderPass.renderParamsCount = 1;
+			renderPass.cullingPassIndex = nPass;
+
+			UnityXRNextFrameDesc::UnityXRRenderPass::UnityXRRenderParams &renderParams = renderPass.renderParams[0];
+			renderParams.deviceAnchorToEyePose = viewConfig.eyePose;
+			renderParams.projection = bInset ? viewConfig.insetProjection : viewConfig.projection;
+			renderParams.viewportRect = { 0.0f, 0.0f, 1.0f, 1.0f };
+			renderParams.textureArraySlice = 0;
+
+			// The hidden area mesh covers the eye's whole frustum, it only lines up with the wide view
+			UnityXROcclusionMeshId occlusionMeshId = eye == vr::Eye_Left ? m_pOcclusionMeshLeftEye : m_pOcclusionMeshRightEye;
+			renderParams.occlusionMeshId = bInset ? k_nInvalidUnityXROcclusionMeshId : occlusionMeshId;
+		}
+	}
+}
+
+
+void *OpenVRDisplayProvider::GetNativeQuadViewTexture( int stage, int eye, bool bInset )
+{
+	void *&pNativeTexture = bInset ? m_pNativeInsetTextures[stage][eye] : m_pNativeWideTextures[stage][eye];
+
+	if ( pNativeTexture == nullptr )
+	{
+		UnityXRRenderTextureDesc unityDesc;
+		memset( &unityDesc, 0, sizeof( UnityXRRenderTextureDesc ) );
+
+		UnityXRRenderTextureId unityTexId = bInset ? m_UnityInsetTextures[stage][eye] : m_UnityWideTextures[stage][eye];
+		UnitySubsystemErrorCode res = s_pXRDisplay->QueryTextureDesc( s_DisplayHandle, unityTexId, &unityDesc );
+		if ( res != kUnitySubsystemErrorCodeSuccess )
+		{
+			XR_TRACE( "[OpenVR] Error querying quad view texture for stage %i eye %i: [%i]\n", stage, eye, res );
+			return nullptr;
+		}
+
+		pNativeTexture = unityDesc.color.nativePtr;
+	}
+
+	return pNativeTexture;
+}
+
+
+void OpenVRDisplayProvider::UpdateFoveation( float flViewportScale )
+{
+	FoveationProfile profile;
+	GetFoveationProfile( UserProjectSettings::GetFoveationLevel(), profile );
+
+	float gaze[2][2];
+	UserProjectSettings::GetFoveationGaze( vr::Eye_Left, gaze[vr::Eye_Left][0], gaze[vr::Eye_Left][1] );
+	UserProjectSettings::GetFoveationGaze( vr::Eye_Right, gaze[vr::Eye_Right][0], gaze[vr::Eye_Right][1] );
+
+	m_fragmentDensityMaps.Update( m_displayConfigCache.GetConfig().rawProjection, gaze, profile, flViewportScale );
+	m_fragmentDensityMaps.Flush();
+}
+
+
+vr::HmdMatrix44_t OpenVRDisplayProvider::GetDepthProjection( int eye, float flNear, float flFar )
+{
+	vr::HmdMatrix44_t ret = {};
+
+	if ( eye > vr::Eye_Right )
+		return ret;
+
+	const float *eyeVr = m_displayConfigCache.GetConfig().rawProjection[eye];
+	float vrL = eyeVr[0];
+	float vrR = eyeVr[1];
+	float vrT = eyeVr[2];
+	float vrB = eyeVr[3];
+
+	// Same as IVRSystem::GetProjectionMatrix, with near and far swapped for reversed Z
+	float nearval = flFar < k_flNear ? k_flFar : flFar;
+	float farval = flNear < k_flNear ? k_flNear : flNear;
+
+	float idx = 1.0f / ( vrR - vrL );
+	float idy = 1.0f / ( vrB - vrT );
+	float idz = 1.0f / ( farval - nearval );
+
+	ret.m[0][0] = 2.0f * idx;	ret.m[0][1] = 0.0f;			ret.m[0][2] = ( vrR + vrL ) * idx;	ret.m[0][3] = 0.0f;
+	ret.m[1][0] = 0.0f;			ret.m[1][1] = 2.0f * idy;	ret.m[1][2] = ( vrB + vrT ) * idy;	ret.m[1][3] = 0.0f;
+	ret.m[2][0] = 0.0f;			ret.m[2][1] = 0.0f;			ret.m[2][2] = -farval * idz;		ret.m[2][3] = -farval * nearval * idz;
+	ret.m[3][0] = 0.0f;			ret.m[3][1] = 0.0f;			ret.m[3][2] = -1.0f;				ret.m[3][3] = 0.0f;
+
+	return ret;
+}
+
+
+void OpenVRDisplayProvider::SetupCullingPass( int eye, UnityXRNextFrameDesc::UnityXRCullingPass &cullingPass )
+{
+	if ( !m_bViewConfigCacheValid )
+		return;
+
+	const ViewConfig &viewConfig = m_viewConfigCache[eye];
+	cullingPass.separation = m_flCullingSeparation;
+	cullingPass.deviceAnchorToCullingPose = viewConfig.cullingPose;
+	cullingPass.projection = viewConfig.cullingProjection;
+}
+
+
+void OpenVRDisplayProvider::UpdateViewConfigCache( const UnityXRFrameSetupHints *pFrameHints, float flIpd )
 {
 	if ( !vr::VRSystem() )
 		return;
 
-	float separation = 0;
+	if ( m_bViewConfigCacheValid
+		&& m_flCachedNear == pFrameHints->appSetup.zNear
+		&& m_flCachedFar == pFrameHints->appSetup.zFar
+		&& m_flCachedIpd == flIpd )
+	{
+		m_nViewConfigCacheHits++;
+		return;
+	}
+
+	m_nViewConfigCacheMisses++;
+
+	m_flCachedNear = pFrameHints->appSetup.zNear;
+	m_flCachedFar = pFrameHints->appSetup.zFar;
+	m_flCachedIpd = flIpd;
 
 	// get the actual separation; IPD in meters 
-	vr::ETrackedPropertyError err;
-	separation = vr::VRSystem()->GetFloatTrackedDeviceProperty( vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_UserIpdMeters_Float, &err );
+	m_flCullingSeparation = ( flIpd == 0.0f ) ? 0.0625f : flIpd; // default camera separation in legacy system
 
-	if ( separation == 0 || err != vr::TrackedProp_Success )
+	for ( int eye = 0; eye < k_nNumCachedViews; ++eye )
 	{
-		separation = 0.0625f; // default camera separation in legacy system
+		ViewConfig &viewConfig = m_viewConfigCache[eye];
+		viewConfig.eyePose = GetEyePose( eye );
+
+		const DisplayConfig &displayConfig = m_displayConfigCache.GetConfig();
+		UnionCullingFrustum unionFrustum;
+		if ( eye > vr::Eye_Right && GetUnionCullingFrustum( displayConfig.rawProjection, displayConfig.eyeToHead, m_flCachedNear, m_flCachedFar, unionFrustum ) )
+		{
+			// Combined view: the smallest head aligned frustum containing both (possibly canted) eye frustums
+			viewConfig.projection = GetProjection( eye, m_flCachedNear, m_flCachedFar, unionFrustum.rawProjection );
+			viewConfig.cullingProjection = GetProjection( eye, unionFrustum.flNear, unionFrustum.flFar, unionFrustum.rawProjection );
+
+			vr::HmdMatrix34_t apexMat = { { { 1.0f, 0.0f, 0.0f, unionFrustum.apex[0] }, { 0.0f, 1.0f, 0.0f, unionFrustum.apex[1] }, { 0.0f, 0.0f, 1.0f, unionFrustum.apex[2] } } };
+			viewConfig.cullingPose = HeadTransformToPose( apexMat );
+		}
+		else
+		{
+			viewConfig.projection = GetProjection( eye, m_flCachedNear, m_flCachedFar );
+			viewConfig.cullingProjection = viewConfig.projection;
+
+			float aspect = viewConfig.projection.data.matrix.columns[1].y / viewConfig.projection.data.matrix.columns[0].x;
+
+			float vertFov = RAD2DEG * ( 2.0f * (float )atan( 1.0f / viewConfig.projection.data.matrix.columns[1].y ) );
+			float eyePullback = 0.5f * m_flCullingSeparation / tanf( ( 0.5f * vertFov * aspect ) * DEG2RAD );
+
+			viewConfig.cullingPose = viewConfig.eyePose;
+			viewConfig.cullingPose.position.z = viewConfig.cullingPose.position.z - eyePullback;
+		}
+
+		viewConfig.depthProjection = GetDepthProjection( eye, m_flCachedNear, m_flCachedFar );
+
+		if ( m_bQuadViewActive && eye <= vr::Eye_Right )
+		{
+			viewConfig.insetProjection = GetProjection( eye, m_flCachedNear, m_flCachedFar, m_quadViewPlans[eye].insetRawProjection );
+		}
 	}
-	cullingPass.separation = separation;
 
-	UnityXRPose pose = GetEyePose( eye );
-	UnityXRProjection projection = GetProjection( eye, frameHints->appSetup.zNear, frameHints->appSetup.zFar );
+	m_bViewConfigCacheValid = true;
+}
+
 
-	float aspect = projection.data.matrix.columns[1].y / projection.data.matrix.columns[0].x;
+void OpenVRDisplayProvider::ValidateDisplayConfig()
+{
+	uint32_t nPrevEyeWidth = m_displayConfigCache.GetConfig().nRecommendedWidth;
+	uint32_t nPrevEyeHeight = m_displayConfigCache.GetConfig().nRecommendedHeight;
 
-	float vertFov = RAD2DEG * ( 2.0f * (float )atan( 1.0f / projection.data.matrix.columns[1].y ) );
-	float eyePullback = 0.5f * separation / tanf( ( 0.5f * vertFov * aspect ) * DEG2RAD );
+	if ( !m_displayConfigCache.Validate() )
+		return;
 
-	pose.position.z = pose.position.z - eyePullback;
-	cullingPass.deviceAnchorToCullingPose = pose;
-	cullingPass.projection = projection;
+	// Rebuild everything that was derived from the stale config
+	InvalidateViewConfigCache();
+
+	if ( m_pOcclusionMeshLeftEye != 0 )
+		s_pXRDisplay->DestroyOcclusionMesh( s_DisplayHandle, m_pOcclusionMeshLeftEye );
+
+	if ( m_pOcclusionMeshRightEye != 0 )
+		s_pXRDisplay->DestroyOcclusionMesh( s_DisplayHandle, m_pOcclusionMeshRightEye );
+
+	SetupHiddenAreaMeshes();
+	m_pOcclusionMeshLeftEye = SetupOcclusionMesh( vr::Eye_Left );
+	m_pOcclusionMeshRightEye = SetupOcclusionMesh( vr::Eye_Right );
+
+	if ( nPrevEyeWidth != m_displayConfigCache.GetConfig().nRecommendedWidth || nPrevEyeHeight != m_displayConfigCache.GetConfig().nRecommendedHeight )
+	{
+		if ( m_bTexturesCreated && s_DisplayHandle )
+			DestroyEyeTextures( s_DisplayHandle );
+
+		m_bTexturesCreated = false;
+		SetupMirror();
+	}
 }
 
 
@@ -1154,12 +1664,12 @@ UnitySubsystemErrorCode OpenVRDisplayProvider::CreateEyeTextures( const UnityXRF
 	if ( !vr::VRSystem() )
 		return kUnitySubsystemErrorCodeSuccess;	// Anything other than success will shutdown the provider, we probably don't want to do that here
 
-	// One texture per eye, per stage
-	int nNumTextures = 2;
+	m_nNumStages = UserProjectSettings::GetDisplayStageCount();
+	m_eyeTexturePool.SetBudget( (uint64_t )UserProjectSettings::GetEyeTexturePoolBudgetMB() * 1024 * 1024 );
 
-	// Grab texture size from OpenVR based on currently active HMD
-	uint32_t eyeWidth, eyeHeight;
-	vr::VRSystem()->GetRecommendedRenderTargetSize( &eyeWidth, &eyeHeight );
+	// Grab texture size from the display config of the currently active HMD
+	uint32_t eyeWidth = m_displayConfigCache.GetConfig().nRecommendedWidth;
+	uint32_t eyeHeight = m_displayConfigCache.GetConfig().nRecommendedHeight;
 
 	// Apply scale
 	float eyeWidthScaled = eyeWidth * frameHints->appSetup.textureResolutionScale;
@@ -1169,12 +1679,81 @@ UnitySubsystemErrorCode OpenVRDisplayProvider::CreateEyeTextures( const UnityXRF
 
 	bool bUseTextureArrays = m_bUseSinglePass;
 
+	// Foveated rendering needs the shading rate extension, which only works on Vulkan with VK_EXT_fragment_density_map
+	m_bFoveationRequested = UserProjectSettings::GetFoveationLevel() != FoveationLevel_Off;
+	m_bFoveationActive = m_bFoveationRequested && s_pXRDisplayShadingRate && m_fragmentDensityMaps.IsSupported();
+
+	if ( m_bFoveationRequested && !m_bFoveationActive )
+	{
+		XR_TRACE( "[OpenVR] Foveated rendering requires Vulkan with VK_EXT_fragment_density_map, rendering at full rate\n" );
+	}
+
+	// Quad view renders each eye as a wide view and an inset, composited into a separate eye texture with Vulkan transfers
+	m_bQuadViewRequested = UserProjectSettings::GetQuadViewEnabled();
+	m_flQuadViewInsetFraction = UserProjectSettings::GetQuadViewInsetFraction();
+	m_flQuadViewWideScale = UserProjectSettings::GetQuadViewWideScale();
+	m_bQuadViewActive = m_bQuadViewRequested && !m_bUseSinglePass && m_quadViewCompositor.IsSupported();
+
+	for ( int eye = 0; eye < 2 && m_bQuadViewActive; ++eye )
+	{
+		m_bQuadViewActive = PlanQuadView( m_displayConfigCache.GetConfig().rawProjection[eye], eyeWidth, eyeHeight, m_flQuadViewInsetFraction, m_flQuadViewWideScale, m_quadViewPlans[eye] );
+	}
+
+	if ( m_bQuadViewActive )
+	{
+		m_flQuadViewShadedPixelRatioValue = ( GetQuadViewShadedPixelRatio( m_quadViewPlans[vr::Eye_Left], eyeWidth, eyeHeight )
+			+ GetQuadViewShadedPixelRatio( m_quadViewPlans[vr::Eye_Right], eyeWidth, eyeHeight ) ) * 0.5f;
+
+		XR_TRACE( "[OpenVR] Quad view: wide %ux%u, inset %ux%u, shading %.0f%% of the pixels\n", m_quadViewPlans[vr::Eye_Left].nWideWidth, m_quadViewPlans[vr::Eye_Left].nWideHeight,
+			m_quadViewPlans[vr::Eye_Left].nInsetWidth, m_quadViewPlans[vr::Eye_Left].nInsetHeight, m_flQuadViewShadedPixelRatioValue * 100.0f );
+
+		// The inset projections are part of the view config
+		InvalidateViewConfigCache();
+		m_bFoveationActive = false;
+	}
+	else if ( m_bQuadViewRequested )
+	{
+		XR_TRACE( "[OpenVR] Quad view requires Vulkan multi-pass rendering and valid parameters, rendering the eye textures directly\n" );
+	}
+
 	if ( m_bUseSinglePass )
 	{
 		XR_TRACE( "[OpenVR] Single-Pass mode: Creating texture array with 2 slices\n" );
 	}
 
 	// Create textures
+	UnitySubsystemErrorCode res = AcquireEyeTextures( eyeWidth, eyeHeight, bUseTextureArrays );
+
+	// Unity refuses shading rate textures if it didn't enable the extension on its device, redo every stage at full rate so they all match
+	if ( res != kUnitySubsystemErrorCodeSuccess && m_bFoveationActive )
+	{
+		XR_TRACE( "[OpenVR] Unable to create foveated eye textures: [%i], rendering at full rate\n", res );
+
+		DestroyEyeTextures( s_DisplayHandle );
+		m_bFoveationActive = false;
+		res = AcquireEyeTextures( eyeWidth, eyeHeight, bUseTextureArrays );
+	}
+
+	if ( res != kUnitySubsystemErrorCodeSuccess )
+	{
+		// Hand the textures acquired so far back to the pool, they'd stay marked in use otherwise
+		DestroyEyeTextures( s_DisplayHandle );
+		return res;
+	}
+
+	ResetStageRing();
+	BuildSubmitDescriptors();
+
+	m_bTexturesCreated = true;
+	return kUnitySubsystemErrorCodeSuccess;
+}
+
+
+UnitySubsystemErrorCode OpenVRDisplayProvider::AcquireEyeTextures( uint32_t eyeWidth, uint32_t eyeHeight, bool bUseTextureArrays )
+{
+	// One texture per eye, per stage
+	int nNumTextures = 2;
+
 	for ( int stage = 0; stage < m_nNumStages; ++stage )
 	{
 		int nTextureCount = bUseTextureArrays ? 1 : nNumTextures;
@@ -1190,6 +1769,12 @@ UnitySubsystemErrorCode OpenVRDisplayProvider::CreateEyeTextures( const UnityXRF
 			unityDesc.width = eyeWidth;
 			unityDesc.height = eyeHeight;
 
+			// With quad view the eye texture only receives the composite
+			if ( m_bQuadViewActive )
+			{
+				unityDesc.depthFormat = kUnityXRDepthTextureFormatNone;
+			}
+
 			if ( m_bIsUsingRGB )
 			{
 				unityDesc.flags |= kUnityXRRenderTextureFlagsSRGB;
@@ -1211,9 +1796,20 @@ UnitySubsystemErrorCode OpenVRDisplayProvider::CreateEyeTextures( const UnityXRF
 				apiName, stage, eye, eyeWidth, eyeHeight, unityDesc.textureArrayLength, 
 				(unityDesc.flags & kUnityXRRenderTextureFlagsSRGB) ? 1 : 0, unityDesc.depthFormat );
 
-			// Create an UnityXRRenderTextureId for the native texture so we can tell unity to render to it later.
+			// Get an UnityXRRenderTextureId for the native texture so we can tell unity to render to it later, reusing a pooled one if possible.
 			UnityXRRenderTextureId unityTexId;
-			UnitySubsystemErrorCode res = s_pXRDisplay->CreateTexture( s_DisplayHandle, &unityDesc, &unityTexId );
+			UnitySubsystemErrorCode res;
+
+			if ( m_bFoveationActive )
+			{
+				void *pDensityMap = m_fragmentDensityMaps.GetDensityMap( eyeWidth, eyeHeight, bUseTextureArrays ? 2 : 1, eye );
+				res = pDensityMap ? m_eyeTexturePool.Acquire( unityDesc, &unityTexId, pDensityMap ) : kUnitySubsystemErrorCodeFailure;
+			}
+			else
+			{
+				res = m_eyeTexturePool.Acquire( unityDesc, &unityTexId );
+			}
+
 			if ( res != kUnitySubsystemErrorCodeSuccess )
 			{
 				XR_TRACE( "[OpenVR] Error creating texture: [%i]\n", res );
@@ -1237,10 +1833,37 @@ UnitySubsystemErrorCode OpenVRDisplayProvider::CreateEyeTextures( const UnityXRF
 				m_pNativeColorTextures[stage][eye] = nullptr;
 				m_pNativeDepthTextures[stage][eye] = nullptr;
 			}
+
+			if ( m_bQuadViewActive )
+			{
+				const QuadViewPlan &plan = m_quadViewPlans[eye];
+
+				UnityXRRenderTextureDesc viewDesc = unityDesc;
+				viewDesc.depthFormat = kUnityXRDepthTextureFormat24bitOrGreater;
+				viewDesc.width = plan.nWideWidth;
+				viewDesc.height = plan.nWideHeight;
+
+				res = m_eyeTexturePool.Acquire( viewDesc, &m_UnityWideTextures[stage][eye] );
+				if ( res == kUnitySubsystemErrorCodeSuccess )
+				{
+					viewDesc.width = plan.nInsetWidth;
+					viewDesc.height = plan.nInsetHeight;
+					res = m_eyeTexturePool.Acquire( viewDesc, &m_UnityInsetTextures[stage][eye] );
+				}
+
+				if ( res != kUnitySubsystemErrorCodeSuccess )
+				{
+					XR_TRACE( "[OpenVR] Error creating quad view texture: [%i]\n", res );
+					return res;
+				}
+
+				m_pNativeWideTextures[stage][eye] = nullptr;
+				m_pNativeInsetTextures[stage][eye] = nullptr;
+				m_bQuadViewStagePrepared[stage] = false;
+			}
 		}
 	}
 
-	m_bTexturesCreated = true;
 	return kUnitySubsystemErrorCodeSuccess;
 }
 
@@ -1251,17 +1874,117 @@ void OpenVRDisplayProvider::DestroyEyeTextures( UnitySubsystemHandle handle )
 	{
 		for ( int eye = 0; eye < 2; ++eye )
 		{
-			if ( m_UnityTextures[i][eye] != 0 )
+			// Single pass shares one texture array between both eyes
+			if ( m_UnityTextures[i][eye] != 0 && ( eye == 0 || m_UnityTextures[i][eye] != m_UnityTextures[i][0] ) )
 			{
-				s_pXRDisplay->DestroyTexture( handle, m_UnityTextures[i][eye] );
+				m_eyeTexturePool.Release( m_UnityTextures[i][eye] );
 			}
+
+			// The inset is missing if creating the textures failed in between
+			if ( m_UnityWideTextures[i][eye] != 0 )
+			{
+				m_eyeTexturePool.Release( m_UnityWideTextures[i][eye] );
+			}
+
+			if ( m_UnityInsetTextures[i][eye] != 0 )
+			{
+				m_eyeTexturePool.Release( m_UnityInsetTextures[i][eye] );
+			}
+		}
+
+		for ( int eye = 0; eye < 2; ++eye )
+		{
+			m_UnityTextures[i][eye] = 0;
+			m_UnityWideTextures[i][eye] = 0;
+			m_UnityInsetTextures[i][eye] = 0;
+			m_pNativeWideTextures[i][eye] = nullptr;
+			m_pNativeInsetTextures[i][eye] = nullptr;
+			m_pNativeColorTextures[i][eye] = nullptr;
+			m_pNativeDepthTextures[i][eye] = nullptr;
+			m_submitDescriptors[i][eye].bResolved = false;
 		}
 	}
 
+	m_nCurStage = -1;
 	m_bTexturesCreated = false;
 }
 
 
+void OpenVRDisplayProvider::ResetStageRing()
+{
+	for ( int i = 0; i < m_nNumStages; ++i )
+	{
+		m_nFreeStages[i] = i;
+		m_nStageSubmitFrameIndex[i] = 0;
+	}
+
+	m_nNumFreeStages = m_nNumStages;
+
+	for ( int i = 0; i < k_nMaxNumStages; ++i )
+	{
+		m_flStageResolutionScale[i] = 1.0f;
+		m_stageRenderPoses[i] = {};
+		m_bStageHasRenderPose[i] = false;
+	}
+
+	m_nNumInFlightStages = 0;
+	m_nCurStage = -1;
+	m_nLastSubmittedStage = 0;
+}
+
+
+void OpenVRDisplayProvider::ReclaimStages( uint32_t nCompositorFrameIndex )
+{
+	// A stage submitted during compositor frame N is read while compositing frame N + 1, so it's only safe to reuse from frame N + 2
+	while ( m_nNumInFlightStages > 0 )
+	{
+		int nStage = m_nInFlightStages[0];
+		if ( (int32_t )( nCompositorFrameIndex - m_nStageSubmitFrameIndex[nStage] ) <= 1 )
+			break;
+
+		m_nFreeStages[m_nNumFreeStages++] = nStage;
+
+		m_nNumInFlightStages--;
+		memmove( &m_nInFlightStages[0], &m_nInFlightStages[1], m_nNumInFlightStages * sizeof( int ) );
+	}
+}
+
+
+int OpenVRDisplayProvider::AcquireStage()
+{
+	int nStage = 0;
+
+	if ( m_nNumFreeStages > 0 )
+	{
+		nStage = m_nFreeStages[0];
+
+		m_nNumFreeStages--;
+		memmove( &m_nFreeStages[0], &m_nFreeStages[1], m_nNumFreeStages * sizeof( int ) );
+	}
+	else if ( m_nNumInFlightStages > 0 )
+	{
+		// Starved, the oldest submitted stage is the one the compositor is most likely done with
+		nStage = m_nInFlightStages[0];
+		m_nNumStarvedFrames++;
+
+		m_nNumInFlightStages--;
+		memmove( &m_nInFlightStages[0], &m_nInFlightStages[1], m_nNumInFlightStages * sizeof( int ) );
+	}
+
+	return nStage;
+}
+
+
+void OpenVRDisplayProvider::SubmitStage( int nStage, uint32_t nCompositorFrameIndex )
+{
+	m_nStageSubmitFrameIndex[nStage] = nCompositorFrameIndex;
+	m_nInFlightStages[m_nNumInFlightStages++] = nStage;
+
+	// Stages can be acquired out of order once more than two are in use, so the mirror follows the submits
+	m_nLastSubmittedStage = nStage;
+}
+
+
 void *OpenVRDisplayProvider::GetNativeEyeTexture( int stage, int eye )
 {
 	if ( m_pNativeColorTextures[stage][eye] == nullptr )
@@ -1528,6 +2251,7 @@ bool RegisterDisplayLifecycleProvider( OpenVRProviderContext *pOpenProviderConte
 	XR_TRACE( "[OpenVR] Display lifecyle provider registered\n" );
 
 	s_pXRDisplay = UnityInterfaces::Get().GetInterface< IUnityXRDisplayInterface >();
+	s_pXRDisplayShadingRate = UnityInterfaces::Get().GetInterface< IUnityXRDisplayShadingRateExt >();
 	s_pProviderContext = pOpenProviderContext;
 	s_pXRStats = (IUnityXRStats * )s_pProviderContext->interfaces->GetInterface( UNITY_GET_INTERFACE_GUID( IUnityXRStats ) );
 
@@ -5,6 +5,14 @@
 
 #include "OpenVRSystem.h"
 #include "OpenVRProviderContext.h"
+#include "DisplayConfigCache.h"
+#include "OcclusionMesh.h"
+#include "DynamicResolution.h"
+#include "RenderTexturePool.h"
+#include "FragmentDensityMap.h"
+#include "QuadViewCompositor.h"
+#include "CullingFrustum.h"
+#include "Input/PoseBuffer.h"
 
 #include "UnityInterfaces.h"
 #include "CommonTypes.h"
@@ -89,6 +97,12 @@ public:
 		m_nMirrorMode = val;
 	}
 
+	/// Get a welded hidden area mesh of the active HMD
+	/// @param[in] EHiddenAreaMeshType eType - Standard, Inverse or LineLoop
+	/// @param[in] EVREye eEye - The eye the mesh belongs to
+	/// @return const WeldedHiddenAreaMesh& - The mesh, empty if the HMD doesn't have one
+	const WeldedHiddenAreaMesh &GetHiddenAreaMesh( vr::EHiddenAreaMeshType eType, vr::EVREye eEye ) const { return m_hiddenAreaMeshes[eType][eEye]; }
+
 private:
 	int old_m_nMirrorMode;
 
@@ -98,11 +112,46 @@ private:
 	/// Tries to update the mirror mode if we haven't had a failure
 	void TryUpdateMirrorMode( bool skipResolutionCheck = false );
 
-	/// Submit a texture to the compositor
-	/// @param[in] EVREye eEye - For which eye to process the texture
-	/// @param[in] int32_t stage - The stage for this frame to pull the correct texture from m_NativeColorTextures
-	/// @return bool - If the submit to the compositor succeeded
-	bool SubmitToCompositor( vr::EVREye eEye, int nStage );
+	/// Submit both eye textures of a stage to the compositor from its pre-resolved submit descriptors
+	/// @param[in] int32_t stage - The stage for this frame
+	/// @return bool - If the submits to the compositor succeeded
+	bool SubmitStageToCompositor( int nStage );
+
+	/// Fill in the parts of the submit descriptors that don't depend on the native textures, called after the eye textures are created
+	void BuildSubmitDescriptors();
+
+	/// Build the projection the compositor uses for the submitted depth of an eye, Unity's D3D depth buffers use reversed Z
+	/// @param[in] int eye - 0:Left, 1:Right
+	/// @param[in] float flNear - the near projection value (clipping area) of the camera
+	/// @param[in] float flFar - the far projection value (clipping area) of the camera
+	/// @return HmdMatrix44_t - Row major projection with depth going from 1 at the near plane to 0 at the far plane
+	vr::HmdMatrix44_t GetDepthProjection( int eye, float flNear, float flFar );
+
+	/// Resolve the native texture handles of a submit descriptor, done once per texture
+	/// @param[in] int nStage - The stage of the descriptor
+	/// @param[in] int nEye - 0:Left, 1:Right
+	/// @return bool - If the native texture is available
+	bool ResolveSubmitDescriptor( int nStage, int nEye );
+
+	/// Set the texture bounds a stage gets submitted with
+	/// @param[in] int nStage - The stage for this frame
+	/// @param[in] float flResolutionScale - The viewport scale the stage is rendered with
+	void SetStageTextureBounds( int nStage, float flResolutionScale );
+
+	/// Set up the four culling and render passes of quad view rendering (wide views first, then the insets)
+	/// @param[out] UnityXRNextFrameDesc* pTargetFrame - The frame to set the passes for
+	void SetupQuadViewPasses( UnityXRNextFrameDesc *pTargetFrame );
+
+	/// Get the native wide view or inset texture of a stage, resolved on first use
+	/// @param[in] int stage - The stage the texture belongs to
+	/// @param[in] int eye - 0:Left, 1:Right
+	/// @param[in] bool bInset - true for the inset, false for the wide view
+	/// @return void* - The native texture
+	void *GetNativeQuadViewTexture( int stage, int eye, bool bInset );
+
+	/// Regenerate the fragment density maps from the foveation level, gaze and eye projections and queue their upload
+	/// @param[in] float flViewportScale - Viewport scale of the stage about to be rendered
+	void UpdateFoveation( float flViewportScale );
 
 	/// Set the render pass properties and parameters that will be used in the target frame
 	/// @param[in] EVREye eEye - Which eye to set this render param for
@@ -110,17 +159,14 @@ private:
 	/// @param[in] UnityXRNextFrameDesc* nextFrame - The target frame
 	void SetupRenderPass( const vr::EVREye eEye, const UnityXRFrameSetupHints *pFrameHints, UnityXRNextFrameDesc *pTargetFrame );
 
+	/// Weld every hidden area mesh type of both eyes from the display config
+	void SetupHiddenAreaMeshes();
+
 	/// Set the occlusion mesh (hidden area mesh) for a given eye
 	/// @param[in] EVREye eEye - Target eye for the occlusion mesh
 	/// @return bool - If we got an occlusion mesh properly setup for the target eye
 	UnityXROcclusionMeshId SetupOcclusionMesh( vr::EVREye eEye );
 
-	/// Get the distance squared between two Vectors
-	/// @param[in] const float* pVector1 - The origin vector
-	/// @param[in] const float* pVector2 - The target vector
-	/// @return float - distance squared between two vectors
-	float GetDistanceSquared2D( const float *pVector1, const float *pVector2 );
-
 	/// Get the recommended resolution (VRHeadsetView size) for the mirror
 	/// @param[out] const UnityXRVector2 - The recommended width (x) and height (y) of the mirror view
 	const UnityXRVector2 GetRecommendedMirrorResolution();
@@ -130,26 +176,67 @@ private:
 	/// @return UnityXRPose - Position and Rotation (quaternion)
 	UnityXRPose GetEyePose( int eye );
 
+	/// Convert a head space transform to a Unity pose
+	/// @param[in] const vr::HmdMatrix34_t& vrMat - Transform in OpenVR head space
+	/// @return UnityXRPose - Position and Rotation (quaternion)
+	UnityXRPose HeadTransformToPose( const vr::HmdMatrix34_t &vrMat );
+
 	/// Helper function to calculate the projection matrix for a given eye
 	/// @param[in] int eye - 0:Left, 1:Right
 	/// @param[in] float flNear - the near projection value (clipping area) of the camera (can be changed during runtime)
 	/// @param[in] float flNear - the far projection value (clipping area) of the camera (can be changed during runtime)
+	/// @param[in] const float* pRawProjection - Left, right, top and bottom tangents to use instead of the eye's, nullptr for the eye's own
 	/// @return UnityXRProjection 
-	UnityXRProjection GetProjection( int eye, float flNear, float flFar );
+	UnityXRProjection GetProjection( int eye, float flNear, float flFar, const float *pRawProjection = nullptr );
 
-	/// Setup the culling pass for this application
+	/// Setup the culling pass for this application from the view config cache
+	/// @param[in] int eye - 0:Left, 1:Right, 2:Combined (single pass)
 	/// @param[in][return] UnityXRNextFrameDesc::UnityXRCullingPass& cullingPass 
-	void SetupCullingPass( int eye, const UnityXRFrameSetupHints *frameHints, UnityXRNextFrameDesc::UnityXRCullingPass &cullingPass );
+	void SetupCullingPass( int eye, UnityXRNextFrameDesc::UnityXRCullingPass &cullingPass );
+
+	/// Rebuild the cached eye poses and projections if the near/far planes or the IPD changed since they were last computed
+	/// @param[in] const UnityXRFrameSetupHints* frameHints - Frame info (near/far planes)
+	/// @param[in] float flIpd - The current IPD of the HMD in meters
+	void UpdateViewConfigCache( const UnityXRFrameSetupHints *pFrameHints, float flIpd );
+
+	/// Force the view config cache to be rebuilt on the next frame
+	void InvalidateViewConfigCache() { m_bViewConfigCacheValid = false; }
+
+	/// Check the display config cache against the live runtime and rebuild anything that was derived from stale values
+	void ValidateDisplayConfig();
 
 	/// Create the eye textures that will be passed to the compositor
 	/// @param[in] const UnityXRFrameSetupHints* frameHint - Details about the frame (fram number, frame in flight, singlepass, etc)
 	/// @return UnitySubsystemErrorCode 
 	UnitySubsystemErrorCode CreateEyeTextures( const UnityXRFrameSetupHints *frameHints );
 
+	/// Acquire the color (and quad view) textures of every stage from the pool, foveated if m_bFoveationActive
+	/// @param[in] uint32_t eyeWidth - Width of an eye texture
+	/// @param[in] uint32_t eyeHeight - Height of an eye texture
+	/// @param[in] bool bUseTextureArrays - One texture array for both eyes (single pass)
+	/// @return UnitySubsystemErrorCode - The first error, the textures acquired until then are left in place for DestroyEyeTextures
+	UnitySubsystemErrorCode AcquireEyeTextures( uint32_t eyeWidth, uint32_t eyeHeight, bool bUseTextureArrays );
+
 	/// Destroy the textures Unity uses to submit to the compositor
 	/// @param[in] UnitySubsystemHandle handle - The handle for this display provider
 	void DestroyEyeTextures( UnitySubsystemHandle handle );
 
+	/// Put every stage back on the free list, used after the eye textures have been (re)created
+	void ResetStageRing();
+
+	/// Move the submitted stages that the compositor has finished with back to the free list
+	/// @param[in] uint32_t nCompositorFrameIndex - The compositor's current frame index
+	void ReclaimStages( uint32_t nCompositorFrameIndex );
+
+	/// Take the oldest free stage for the next frame, falling back to the oldest in-flight stage if the ring is starved
+	/// @return int - The stage to render the next frame into
+	int AcquireStage();
+
+	/// Hand a stage over to the compositor after it has been submitted
+	/// @param[in] int nStage - The submitted stage
+	/// @param[in] uint32_t nCompositorFrameIndex - The compositor frame index at the time of submission
+	void SubmitStage( int nStage, uint32_t nCompositorFrameIndex );
+
 	/// Get the eye textures Unity uses to submit to the compositor
 	/// @param[in] int stage - The stage of the render pass 
 	/// @param[in] int eye - 0:Left, 1:Right
@@ -162,6 +249,12 @@ private:
 
 	void SetupOverlayMirror();
 
+	/// HMD display config (render target size, projections, eye transforms, hidden area meshes), persisted between sessions
+	DisplayConfigCache m_displayConfigCache;
+
+	/// Welded hidden area meshes per type (Standard, Inverse, LineLoop) and eye, the standard one backs the occlusion meshes
+	WeldedHiddenAreaMesh m_hiddenAreaMeshes[vr::k_eHiddenAreaMesh_Max][2];
+
 	/// The occlusion mesh (hidden area mesh) handle for the left eye. 0 if none.
 	UnityXROcclusionMeshId m_pOcclusionMeshLeftEye = 0;
 
@@ -236,6 +329,9 @@ private:
 	/// Whether the application is using single pass or multi pass (can be changed in runtime)
 	bool m_bUseSinglePass = false;
 
+	/// Whether both multi-pass render passes share the combined culling pass (read from the settings every frame)
+	bool m_bSharedCulling = false;
+
 	bool m_bIsOverlayApplication = false;
 
 	/// The current frame number, will revert to 0 at UINT32MAX
@@ -245,10 +341,74 @@ private:
 	uint32_t m_nOpenVRMirrorAttempts = 0;
 
 	/// Maximum number of stages per render pass
-	static const int k_nMaxNumStages = 3;
+	static const int k_nMaxNumStages = k_nMaxDisplayStageCount;
+
+	/// The number of stages per render pass, picked up from UserProjectSettings::GetDisplayStageCount() when the eye textures are created
+	int m_nNumStages = k_nDefaultDisplayStageCount;
+
+	/// The stage the current frame renders into, -1 if none has been acquired since the last submit
+	int m_nCurStage = -1;
+
+	/// The stage that was submitted to the compositor last (read by the mirror on the main thread)
+	int m_nLastSubmittedStage = 0;
+
+	/// Stages the compositor is done with, oldest first
+	int m_nFreeStages[k_nMaxNumStages];
+	int m_nNumFreeStages = 0;
+
+	/// Stages that have been submitted and may still be read by the compositor, oldest first
+	int m_nInFlightStages[k_nMaxNumStages];
+	int m_nNumInFlightStages = 0;
+
+	/// The compositor frame index (Compositor_FrameTiming::m_nFrameIndex) each stage was submitted in
+	uint32_t m_nStageSubmitFrameIndex[k_nMaxNumStages];
+
+	/// Number of frames that found no free stage and had to reuse one the compositor may still be reading
+	uint32_t m_nNumStarvedFrames = 0;
+
+	/// Keeps recently used eye textures alive so resolution changes don't have to recreate them
+	RenderTexturePool m_eyeTexturePool;
+
+	/// Fragment density maps the eye textures are created with when foveated rendering is on
+	FragmentDensityMapCache m_fragmentDensityMaps;
+
+	/// If foveated rendering was requested when the eye textures were created
+	bool m_bFoveationRequested = false;
+
+	/// If the eye textures were created with fragment density maps
+	bool m_bFoveationActive = false;
+
+	/// Composites the quad view wide views and insets into the eye textures
+	QuadViewCompositor m_quadViewCompositor;
+
+	/// Quad view settings the eye textures were created with
+	bool m_bQuadViewRequested = false;
+	float m_flQuadViewInsetFraction = 0.0f;
+	float m_flQuadViewWideScale = 0.0f;
+
+	/// If the eye textures are rendered as quad views
+	bool m_bQuadViewActive = false;
 
-	/// The default number of stage per render pass
-	int m_nNumStages = 2;
+	/// Layout of the quad views per eye
+	QuadViewPlan m_quadViewPlans[2];
+
+	/// Wide view and inset textures per stage and eye, composited into m_UnityTextures
+	UnityXRRenderTextureId m_UnityWideTextures[k_nMaxNumStages][2];
+	UnityXRRenderTextureId m_UnityInsetTextures[k_nMaxNumStages][2];
+	void *m_pNativeWideTextures[k_nMaxNumStages][2];
+	void *m_pNativeInsetTextures[k_nMaxNumStages][2];
+
+	/// If the eye textures of a stage have been moved into the layout quad view compositing expects
+	bool m_bQuadViewStagePrepared[k_nMaxNumStages];
+
+	/// Shaded pixels relative to rendering the eye textures directly, averaged over both eyes
+	float m_flQuadViewShadedPixelRatioValue = 1.0f;
+
+	/// Drives the eye viewport scale from the compositor frame timing
+	DynamicResolutionController m_dynamicResolution;
+
+	/// The viewport scale each stage was last rendered with, so the matching texture bounds get submitted
+	float m_flStageResolutionScale[k_nMaxNumStages];
 
 	/// The currently active mirror mode 
 	int m_nMirrorMode = kUnityXRMirrorBlitRightEye;
@@ -262,20 +422,114 @@ private:
 	/// Holds the native depth texture if any, based on device (DX11/12)
 	void *m_pNativeDepthTextures[k_nMaxNumStages][2];
 
-	/// Holds the Vulkan Image from Unity
-	UnityVulkanImage m_unityVulkanImage = {};
+	/// Unity's Vulkan interface, cached at GfxThread_Start
+	IUnityGraphicsVulkan *m_pUnityVulkan = nullptr;
 
-	/// Holds the OpenVR Vulkan Texture Array data for submitting to the compositor
-	vr::VRVulkanTextureArrayData_t m_vrVulkanTexture = {};
+	/// Unity's Vulkan instance, device and queue, cached at GfxThread_Start
+	UnityVulkanInstance m_unityVulkanInstance = {};
 
 	#ifndef __linux__
-	/// Holds the OpenVR DirectX 12 Texture data for submitting to the compositor
-	vr::D3D12TextureData_t m_vrD3D12Texture = {};
+	/// Unity's D3D12 command queue, cached at GfxThread_Start
+	ID3D12CommandQueue *m_pD3D12CommandQueue = nullptr;
 	#endif
 
+	/// Everything needed to submit one eye of one stage, resolved ahead of time so submitting is just the Submit call
+	struct SubmitDescriptor
+	{
+		/// The texture passed to IVRCompositor::Submit, its handle points at vulkanTexture/d3d12Texture where needed
+		vr::VRTextureWithPoseAndDepth_t texture;
+
+		/// Holds the OpenVR Vulkan Texture Array data for submitting to the compositor
+		vr::VRVulkanTextureArrayData_t vulkanTexture;
+
+		#ifndef __linux__
+		/// Holds the OpenVR DirectX 12 Texture data for submitting to the compositor
+		vr::D3D12TextureData_t d3d12Texture;
+
+		/// Holds the OpenVR DirectX 12 depth texture data for submitting to the compositor
+		vr::D3D12TextureData_t d3d12DepthTexture;
+		#endif
+
+		/// Part of the texture that was rendered to this frame
+		vr::VRTextureBounds_t bounds;
+
+		/// OpenVR submission flags
+		vr::EVRSubmitFlags nFlags;
+
+		/// The device native texture
+		void *pNativeTexture;
+
+		/// If the native texture handles have been resolved
+		bool bResolved;
+	};
+
+	/// Submit descriptors per stage and eye
+	SubmitDescriptor m_submitDescriptors[k_nMaxNumStages][2];
+
+	/// HMD pose each stage was rendered with, latched when its frame was populated
+	RenderPose m_stageRenderPoses[k_nMaxNumStages];
+
+	/// If the pose in m_stageRenderPoses belongs to the frame currently in the stage
+	bool m_bStageHasRenderPose[k_nMaxNumStages];
+
+	/// Sequence of the last render pose latched for a frame
+	uint64_t m_nLastLatchedRenderPoseSequence = 0;
+
+	/// Age of the render pose when the last frame was submitted
+	float m_flLastPoseAgeAtSubmitMs = 0.0f;
+
+	/// Time between the last vsync and submitting the last frame
+	float m_flLastSubmitAfterVsyncMs = 0.0f;
+
+	/// If the depth buffers are submitted along with the eye textures (Submit_TextureWithDepth)
+	bool m_bSubmitDepth = false;
+
 	/// Holds the Unity equivalent eye textures per stage (0:Left, 1: Right, Single Pass only uses left with texture array size of 2)
 	UnityXRRenderTextureId m_UnityTextures[k_nMaxNumStages][2];
 
 	/// Holds the Unity equivalent eye depth textures per stage (0:Left, 1: Right, Single Pass only uses left with texture array size of 2)
 	UnityXRRenderTextureId m_UnityDepthTextures[k_nMaxNumStages][2];
+
+	/// Precomputed render data for a single view
+	struct ViewConfig
+	{
+		/// Eye to head pose in Unity coordinates
+		UnityXRPose eyePose;
+
+		/// Projection for the current near/far planes
+		UnityXRProjection projection;
+
+		/// Eye pose pulled back so the culling frustum contains both eyes
+		UnityXRPose cullingPose;
+
+		/// Projection of the culling frustum, for the combined view with the near and far planes measured from its pulled back apex
+		UnityXRProjection cullingProjection;
+
+		/// Projection the compositor needs to interpret the submitted (reversed Z) depth buffer
+		vr::HmdMatrix44_t depthProjection;
+
+		/// Projection of the quad view inset
+		UnityXRProjection insetProjection;
+	};
+
+	/// Number of cached views (0:Left, 1:Right, 2:Combined for single pass and shared multi-pass culling)
+	static const int k_nNumCachedViews = 3;
+
+	/// Cached per view poses and projections, only rebuilt when the cache key changes
+	ViewConfig m_viewConfigCache[k_nNumCachedViews];
+
+	/// Whether m_viewConfigCache holds valid data for the cached key below
+	bool m_bViewConfigCacheValid = false;
+
+	/// View config cache key (near/far planes and IPD the cache was built with)
+	float m_flCachedNear = 0.0f;
+	float m_flCachedFar = 0.0f;
+	float m_flCachedIpd = 0.0f;
+
+	/// The camera separation used for culling, derived from the cached IPD
+	float m_flCullingSeparation = 0.0f;
+
+	/// View config cache counters, reported through XR Stats
+	uint32_t m_nViewConfigCacheHits = 0;
+	uint32_t m_nViewConfigCacheMisses = 0;
 };
@@ -0,0 +1,428 @@
+#ifndef __linux__
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <fstream>
+
+#include "DisplayConfigCache.h"
+#include "OcclusionMesh.h"
+#include "CommonTypes.h"
+
+#ifndef __linux__
+std::wstring UTF8to16( const std::string &in );
+#endif
+
+
+static const uint32_t k_unDisplayConfigCacheMagic = 0x4344564F; // 'OVDC'
+
+/// On-disk layout of the cache file. The hidden area mesh vertices follow the header, ordered by mesh type and then eye.
+struct DisplayConfigCacheHeader
+{
+	uint32_t nMagic;
+	uint32_t nVersion;
+	char rchKey[k_unDisplayConfigCacheKeyMax];
+	uint32_t nRecommendedWidth;
+	uint32_t nRecommendedHeight;
+	float rawProjection[2][4];
+	vr::HmdMatrix34_t eyeToHead[2];
+	float flHeadToEyeDepth;
+	float flIpd;
+	uint32_t nHiddenAreaTriangleCount[vr::k_eHiddenAreaMesh_Max][2];
+};
+
+
+DisplayConfigCache::DisplayConfigCache()
+{
+}
+
+
+DisplayConfigCache::~DisplayConfigCache()
+{
+	Close();
+}
+
+
+bool DisplayConfigCache::Load( const std::string &sFilePath )
+{
+	Close();
+	m_sFilePath = sFilePath;
+
+	if ( !m_sFilePath.empty() && MapFile() )
+	{
+		// A few string properties are enough to tell if the cache was written for another HMD or runtime
+		std::string sLiveKey;
+		if ( vr::VRSystem() )
+		{
+			QueryKey( vr::VRSystem(), sLiveKey );
+		}
+
+		if ( sLiveKey.empty() || sLiveKey == m_sKey )
+		{
+			// Trust the cached values until Validate() gets called, which then only has to catch in-session changes
+			m_bHasConfig = true;
+			m_bValidated = false;
+			return true;
+		}
+
+		XR_TRACE( "[OpenVR] Display config cache was written for %s, connected HMD is %s\n", m_sKey.c_str(), sLiveKey.c_str() );
+		UnmapFile();
+		m_config = DisplayConfig();
+		m_sKey.clear();
+	}
+
+	// No usable cache, query the runtime this once and persist it for the next session
+	m_bValidated = true;
+	m_bHasConfig = QueryRuntime( m_config, m_sKey, m_vHiddenAreaVertices );
+
+	if ( m_bHasConfig )
+	{
+		WriteFile();
+	}
+
+	return m_bHasConfig;
+}
+
+
+void DisplayConfigCache::Close()
+{
+	UnmapFile();
+
+	m_config = DisplayConfig();
+	m_sKey.clear();
+	for ( auto &vTypeVertices : m_vHiddenAreaVertices )
+	{
+		vTypeVertices[0].clear();
+		vTypeVertices[1].clear();
+	}
+	m_bHasConfig = false;
+	m_bValidated = false;
+}
+
+
+bool DisplayConfigCache::Validate()
+{
+	m_bValidated = true;
+
+	DisplayConfig liveConfig;
+	std::string sLiveKey;
+	std::vector< vr::HmdVector2_t > vLiveHiddenAreaVertices[vr::k_eHiddenAreaMesh_Max][2];
+
+	if ( !QueryRuntime( liveConfig, sLiveKey, vLiveHiddenAreaVertices ) )
+		return false;
+
+	bool bConfigChanged = !m_bHasConfig || !IsSameConfig( m_config, liveConfig );
+
+	if ( !bConfigChanged && sLiveKey == m_sKey )
+		return false;
+
+	XR_TRACE( "[OpenVR] Display config cache is out of date (%s), updating it\n", sLiveKey.c_str() );
+
+	// The file is about to be rewritten so it can't stay mapped
+	UnmapFile();
+
+	m_sKey = sLiveKey;
+	m_config = liveConfig;
+	for ( int type = 0; type < vr::k_eHiddenAreaMesh_Max; ++type )
+	{
+		for ( int eye = 0; eye < 2; ++eye )
+		{
+			m_vHiddenAreaVertices[type][eye].swap( vLiveHiddenAreaVertices[type][eye] );
+			m_config.hiddenAreaMesh[type][eye].pVertexData = m_vHiddenAreaVertices[type][eye].empty() ? nullptr : m_vHiddenAreaVertices[type][eye].data();
+		}
+	}
+	m_bHasConfig = true;
+
+	WriteFile();
+
+	return bConfigChanged;
+}
+
+
+void DisplayConfigCache::QueryKey( vr::IVRSystem *pSystem, std::string &sKey )
+{
+	char rchModel[vr::k_unMaxPropertyStringSize] = { 0 };
+	char rchSerial[vr::k_unMaxPropertyStringSize] = { 0 };
+	pSystem->GetStringTrackedDeviceProperty( vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_ModelNumber_String, rchModel, sizeof( rchModel ) );
+	pSystem->GetStringTrackedDeviceProperty( vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_SerialNumber_String, rchSerial, sizeof( rchSerial ) );
+
+	const char *pchRuntimeVersion = pSystem->GetRuntimeVersion();
+	sKey = std::string( rchModel ) + "|" + rchSerial + "|" + ( pchRuntimeVersion ? pchRuntimeVersion : "" );
+	if ( sKey.size() >= k_unDisplayConfigCacheKeyMax )
+	{
+		sKey.resize( k_unDisplayConfigCacheKeyMax - 1 );
+	}
+}
+
+
+bool DisplayConfigCache::QueryRuntime( DisplayConfig &config, std::string &sKey, std::vector< vr::HmdVector2_t > vHiddenAreaVertices[vr::k_eHiddenAreaMesh_Max][2] )
+{
+	vr::IVRSystem *pSystem = vr::VRSystem();
+	if ( !pSystem )
+		return false;
+
+	QueryKey( pSystem, sKey );
+
+	pSystem->GetRecommendedRenderTargetSize( &config.nRecommendedWidth, &config.nRecommendedHeight );
+	config.flHeadToEyeDepth = pSystem->GetFloatTrackedDeviceProperty( vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_UserHeadToEyeDepthMeters_Float, nullptr );
+
+	vr::ETrackedPropertyError err;
+	config.flIpd = pSystem->GetFloatTrackedDeviceProperty( vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_UserIpdMeters_Float, &err );
+	if ( err != vr::TrackedProp_Success )
+	{
+		config.flIpd = 0.0f;
+	}
+
+	for ( int eye = 0; eye < 2; ++eye )
+	{
+		vr::EVREye eEye = ( eye == 0 ) ? vr::Eye_Left : vr::Eye_Right;
+		float *pProjection = config.rawProjection[eye];
+		pSystem->GetProjectionRaw( eEye, &pProjection[0], &pProjection[1], &pProjection[2], &pProjection[3] );
+		config.eyeToHead[eye] = pSystem->GetEyeToHeadTransform( eEye );
+
+		// Copy the hidden area meshes, the runtime only guarantees its buffer until the next call
+		for ( int type = 0; type < vr::k_eHiddenAreaMesh_Max; ++type )
+		{
+			vr::EHiddenAreaMeshType eType = (vr::EHiddenAreaMeshType )type;
+			vr::HiddenAreaMesh_t hiddenAreaMesh = pSystem->GetHiddenAreaMesh( eEye, eType );
+			if ( hiddenAreaMesh.pVertexData != nullptr && hiddenAreaMesh.unTriangleCount > 0 )
+			{
+				vHiddenAreaVertices[type][eye].assign( hiddenAreaMesh.pVertexData, hiddenAreaMesh.pVertexData + GetHiddenAreaMeshVertexCount( hiddenAreaMesh, eType ) );
+				config.hiddenAreaMesh[type][eye].pVertexData = vHiddenAreaVertices[type][eye].data();
+				config.hiddenAreaMesh[type][eye].unTriangleCount = hiddenAreaMesh.unTriangleCount;
+			}
+			else
+			{
+				vHiddenAreaVertices[type][eye].clear();
+				config.hiddenAreaMesh[type][eye] = { nullptr, 0 };
+			}
+		}
+	}
+
+	return true;
+}
+
+
+bool DisplayConfigCache::IsSameConfig( const DisplayConfig &config1, const DisplayConfig &config2 )
+{
+	if ( config1.nRecommendedWidth != config2.nRecommendedWidth
+		|| config1.nRecommendedHeight != config2.nRecommendedHeight
+		|| config1.flHeadToEyeDepth != config2.flHeadToEyeDepth
+		|| config1.flIpd != config2.flIpd
+		|| memcmp( config1.rawProjection, config2.rawProjection, sizeof( config1.rawProjection ) ) != 0
+		|| memcmp( config1.eyeToHead, config2.eyeToHead, sizeof( config1.eyeToHead ) ) != 0 )
+	{
+		return false;
+	}
+
+	for ( int type = 0; type < vr::k_eHiddenAreaMesh_Max; ++type )
+	{
+		for ( int eye = 0; eye < 2; ++eye )
+		{
+			const vr::HiddenAreaMesh_t &mesh1 = config1.hiddenAreaMesh[type][eye];
+			const vr::HiddenAreaMesh_t &mesh2 = config2.hiddenAreaMesh[type][eye];
+
+			if ( mesh1.unTriangleCount != mesh2.unTriangleCount )
+				return false;
+
+			if ( mesh1.unTriangleCount > 0
+				&& memcmp( mesh1.pVertexData, mesh2.pVertexData, GetHiddenAreaMeshVertexCount( mesh1, (vr::EHiddenAreaMeshType )type ) * sizeof( vr::HmdVector2_t ) ) != 0 )
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+bool DisplayConfigCache::MapFile()
+{
+	UnmapFile();
+
+#ifndef __linux__
+	HANDLE hFile = CreateFileW( UTF8to16( m_sFilePath ).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+	if ( hFile == INVALID_HANDLE_VALUE )
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if ( !GetFileSizeEx( hFile, &fileSize ) || fileSize.QuadPart < (LONGLONG )sizeof( DisplayConfigCacheHeader ) )
+	{
+		CloseHandle( hFile );
+		return false;
+	}
+
+	HANDLE hFileMapping = CreateFileMappingW( hFile, nullptr, PAGE_READONLY, 0, 0, nullptr );
+	if ( hFileMapping == nullptr )
+	{
+		CloseHandle( hFile );
+		return false;
+	}
+
+	m_pMappedData = (const uint8_t * )MapViewOfFile( hFileMapping, FILE_MAP_READ, 0, 0, 0 );
+	m_nMappedSize = (size_t )fileSize.QuadPart;
+	m_hFile = hFile;
+	m_hFileMapping = hFileMapping;
+#else
+	int fd = open( m_sFilePath.c_str(), O_RDONLY );
+	if ( fd < 0 )
+		return false;
+
+	struct stat fileInfo;
+	if ( fstat( fd, &fileInfo ) != 0 || fileInfo.st_size < (off_t )sizeof( DisplayConfigCacheHeader ) )
+	{
+		close( fd );
+		return false;
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	void *pData = mmap( nullptr, (size_t )fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );
+
+	m_pMappedData = ( pData == MAP_FAILED ) ? nullptr : (const uint8_t * )pData;
+	m_nMappedSize = (size_t )fileInfo.st_size;
+#endif
+
+	if ( m_pMappedData == nullptr )
+	{
+		UnmapFile();
+		return false;
+	}
+
+	const DisplayConfigCacheHeader *pHeader = (const DisplayConfigCacheHeader * )m_pMappedData;
+	size_t nVertexDataSize = 0;
+	for ( int type = 0; type < vr::k_eHiddenAreaMesh_Max; ++type )
+	{
+		for ( int eye = 0; eye < 2; ++eye )
+		{
+			vr::HiddenAreaMesh_t mesh = { nullptr, pHeader->nHiddenAreaTriangleCount[type][eye] };
+			nVertexDataSize += GetHiddenAreaMeshVertexCount( mesh, (vr::EHiddenAreaMeshType )type ) * sizeof( vr::HmdVector2_t );
+		}
+	}
+
+	if ( pHeader->nMagic != k_unDisplayConfigCacheMagic
+		|| pHeader->nVersion != k_unDisplayConfigCacheVersion
+		|| memchr( pHeader->rchKey, '\0', sizeof( pHeader->rchKey ) ) == nullptr
+		|| m_nMappedSize != sizeof( DisplayConfigCacheHeader ) + nVertexDataSize )
+	{
+		XR_TRACE( "[OpenVR] Ignoring incompatible display config cache at %s\n", m_sFilePath.c_str() );
+		UnmapFile();
+		return false;
+	}
+
+	m_sKey = pHeader->rchKey;
+	m_config.nRecommendedWidth = pHeader->nRecommendedWidth;
+	m_config.nRecommendedHeight = pHeader->nRecommendedHeight;
+	memcpy( m_config.rawProjection, pHeader->rawProjection, sizeof( m_config.rawProjection ) );
+	memcpy( m_config.eyeToHead, pHeader->eyeToHead, sizeof( m_config.eyeToHead ) );
+	m_config.flHeadToEyeDepth = pHeader->flHeadToEyeDepth;
+	m_config.flIpd = pHeader->flIpd;
+
+	// Point the hidden area meshes straight into the mapping
+	const vr::HmdVector2_t *pVertexData = (const vr::HmdVector2_t * )( m_pMappedData + sizeof( DisplayConfigCacheHeader ) );
+	for ( int type = 0; type < vr::k_eHiddenAreaMesh_Max; ++type )
+	{
+		for ( int eye = 0; eye < 2; ++eye )
+		{
+			vr::HiddenAreaMesh_t &mesh = m_config.hiddenAreaMesh[type][eye];
+			mesh.unTriangleCount = pHeader->nHiddenAreaTriangleCount[type][eye];
+			mesh.pVertexData = mesh.unTriangleCount > 0 ? pVertexData : nullptr;
+			pVertexData += GetHiddenAreaMeshVertexCount( mesh, (vr::EHiddenAreaMeshType )type );
+		}
+	}
+
+	XR_TRACE( "[OpenVR] Loaded display config cache for %s\n", m_sKey.c_str() );
+
+	return true;
+}
+
+
+void DisplayConfigCache::UnmapFile()
+{
+	// Anything that pointed into the mapping has to go with it
+	for ( int type = 0; type < vr::k_eHiddenAreaMesh_Max; ++type )
+	{
+		for ( int eye = 0; eye < 2; ++eye )
+		{
+			if ( m_pMappedData && m_vHiddenAreaVertices[type][eye].empty() )
+			{
+				m_config.hiddenAreaMesh[type][eye] = { nullptr, 0 };
+			}
+		}
+	}
+
+#ifndef __linux__
+	if ( m_pMappedData )
+		UnmapViewOfFile( m_pMappedData );
+
+	if ( m_hFileMapping )
+		CloseHandle( (HANDLE )m_hFileMapping );
+
+	if ( m_hFile )
+		CloseHandle( (HANDLE )m_hFile );
+
+	m_hFileMapping = nullptr;
+	m_hFile = nullptr;
+#else
+	if ( m_pMappedData )
+		munmap( (void * )m_pMappedData, m_nMappedSize );
+#endif
+
+	m_pMappedData = nullptr;
+	m_nMappedSize = 0;
+}
+
+
+void DisplayConfigCache::WriteFile()
+{
+	if ( m_sFilePath.empty() )
+		return;
+
+	DisplayConfigCacheHeader header = {};
+	header.nMagic = k_unDisplayConfigCacheMagic;
+	header.nVersion = k_unDisplayConfigCacheVersion;
+	strncpy( header.rchKey, m_sKey.c_str(), sizeof( header.rchKey ) - 1 );
+	header.nRecommendedWidth = m_config.nRecommendedWidth;
+	header.nRecommendedHeight = m_config.nRecommendedHeight;
+	memcpy( header.rawProjection, m_config.rawProjection, sizeof( header.rawProjection ) );
+	memcpy( header.eyeToHead, m_config.eyeToHead, sizeof( header.eyeToHead ) );
+	header.flHeadToEyeDepth = m_config.flHeadToEyeDepth;
+	header.flIpd = m_config.flIpd;
+	for ( int type = 0; type < vr::k_eHiddenAreaMesh_Max; ++type )
+	{
+		header.nHiddenAreaTriangleCount[type][0] = m_config.hiddenAreaMesh[type][0].unTriangleCount;
+		header.nHiddenAreaTriangleCount[type][1] = m_config.hiddenAreaMesh[type][1].unTriangleCount;
+	}
+
+#ifndef __linux__
+	std::ofstream outfile( UTF8to16( m_sFilePath ), std::ios::binary | std::ios::trunc );
+#else
+	std::ofstream outfile( m_sFilePath, std::ios::binary | std::ios::trunc );
+#endif
+
+	if ( !outfile.is_open() )
+	{
+		XR_TRACE( "[OpenVR] Unable to write display config cache to %s\n", m_sFilePath.c_str() );
+		return;
+	}
+
+	outfile.write( (const char * )&header, sizeof( header ) );
+	for ( int type = 0; type < vr::k_eHiddenAreaMesh_Max; ++type )
+	{
+		for ( int eye = 0; eye < 2; ++eye )
+		{
+			const vr::HiddenAreaMesh_t &mesh = m_config.hiddenAreaMesh[type][eye];
+			if ( mesh.unTriangleCount > 0 )
+			{
+				outfile.write( (const char * )mesh.pVertexData, (std::streamsize )( GetHiddenAreaMeshVertexCount( mesh, (vr::EHiddenAreaMeshType )type ) * sizeof( vr::HmdVector2_t ) ) );
+			}
+		}
+	}
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "OpenVR/openvr.h"
+
+/// Bump whenever the layout of DisplayConfigCacheHeader or the data following it changes
+static const uint32_t k_unDisplayConfigCacheVersion = 2;
+
+/// Max length of the HMD model|serial|runtime version key stored in the cache file
+static const uint32_t k_unDisplayConfigCacheKeyMax = 256;
+
+/// HMD display configuration that only changes when the headset, the runtime or the user's IPD changes
+struct DisplayConfig
+{
+	/// Recommended render target size per eye
+	uint32_t nRecommendedWidth = 0;
+	uint32_t nRecommendedHeight = 0;
+
+	/// Raw projection tangents per eye - left, right, top, bottom
+	float rawProjection[2][4] = {};
+
+	/// Eye to head transform per eye
+	vr::HmdMatrix34_t eyeToHead[2] = {};
+
+	/// Prop_UserHeadToEyeDepthMeters_Float of the HMD, used for the combined eye pose
+	float flHeadToEyeDepth = 0.0f;
+
+	/// Prop_UserIpdMeters_Float of the HMD at the time the eye to head transforms were queried
+	float flIpd = 0.0f;
+
+	/// Hidden area mesh per type (Standard, Inverse, LineLoop) and eye, points either into the mapped cache file or into memory owned by the cache
+	vr::HiddenAreaMesh_t hiddenAreaMesh[vr::k_eHiddenAreaMesh_Max][2] = {};
+};
+
+/// Versioned, memory-mapped on-disk cache of the HMD display configuration.
+/// On start the cache file is mapped and, if it was written for the connected HMD model, serial and runtime version,
+/// its contents are used as-is so the first frame can be populated without the full set of display queries.
+/// Validate() then compares the cached values against the live runtime and rewrites the file if anything changed
+/// during the session (e.g. the IPD).
+class DisplayConfigCache
+{
+public:
+	DisplayConfigCache();
+	~DisplayConfigCache();
+
+	/// Map the cache file at the given path. If there is no usable cache for the connected HMD and runtime, query the runtime once and write a new one.
+	/// @param[in] const std::string& sFilePath - Path to the cache file, caching to disk is disabled if empty
+	/// @return bool - If a display configuration is available (from the cache or the runtime)
+	bool Load( const std::string &sFilePath );
+
+	/// Unmap the cache file and drop the current configuration
+	void Close();
+
+	/// Compare the loaded configuration against the live runtime, switching to (and persisting) the live one on mismatch
+	/// @return bool - true if the display configuration changed and anything derived from it needs to be rebuilt
+	bool Validate();
+
+	/// If the loaded configuration has been checked against the live runtime
+	bool IsValidated() const { return m_bValidated; }
+
+	/// If a display configuration is available
+	bool HasConfig() const { return m_bHasConfig; }
+
+	/// The current display configuration
+	const DisplayConfig &GetConfig() const { return m_config; }
+
+private:
+	/// Build the key identifying the connected HMD and runtime
+	/// @param[in] IVRSystem* pSystem - The live runtime
+	/// @param[out] std::string& sKey - HMD model|serial|runtime version
+	static void QueryKey( vr::IVRSystem *pSystem, std::string &sKey );
+
+	/// Query the display configuration from the live runtime
+	/// @param[out] DisplayConfig& config - The live configuration, hidden area meshes point into vHiddenAreaVertices
+	/// @param[out] std::string& sKey - HMD model|serial|runtime version
+	/// @param[out] std::vector< vr::HmdVector2_t > vHiddenAreaVertices[][2] - Storage for the hidden area mesh vertices per type and eye
+	/// @return bool - false if OpenVR isn't available
+	static bool QueryRuntime( DisplayConfig &config, std::string &sKey, std::vector< vr::HmdVector2_t > vHiddenAreaVertices[vr::k_eHiddenAreaMesh_Max][2] );
+
+	/// Compare two display configurations, including the hidden area mesh vertices
+	static bool IsSameConfig( const DisplayConfig &config1, const DisplayConfig &config2 );
+
+	/// Map m_sFilePath into memory and point m_config into it
+	/// @return bool - false if the file doesn't exist or doesn't hold a valid cache for this version
+	bool MapFile();
+
+	/// Release the file mapping
+	void UnmapFile();
+
+	/// Write the current configuration to m_sFilePath
+	void WriteFile();
+
+	std::string m_sFilePath;
+	std::string m_sKey;
+	DisplayConfig m_config;
+
+	/// Hidden area mesh vertices of a configuration that was queried from the runtime rather than mapped
+	std::vector< vr::HmdVector2_t > m_vHiddenAreaVertices[vr::k_eHiddenAreaMesh_Max][2];
+
+	/// The mapped cache file
+	const uint8_t *m_pMappedData = nullptr;
+	size_t m_nMappedSize = 0;
+	#ifndef __linux__
+	void *m_hFile = nullptr;
+	void *m_hFileMapping = nullptr;
+	#endif
+
+	bool m_bHasConfig = false;
+	bool m_bValidated = false;
+};
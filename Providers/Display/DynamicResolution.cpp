@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <cmath>
+
+#include "DynamicResolution.h"
+
+
+/// Takes a fixed step down when over budget and a smaller step up when there's plenty of headroom
+class StepDynamicResolutionPolicy : public IDynamicResolutionPolicy
+{
+public:
+	void Reset() override {}
+
+	float Update( float flCurrentScale, float flGpuLoad, bool bMissedFrame ) override
+	{
+		static const float k_flStepDown = 0.05f;
+		static const float k_flStepUp = 0.02f;
+		static const float k_flUpperLoad = 0.95f;
+		static const float k_flLowerLoad = 0.75f;
+
+		if ( bMissedFrame || flGpuLoad > k_flUpperLoad )
+			return flCurrentScale - k_flStepDown;
+
+		if ( flGpuLoad < k_flLowerLoad )
+			return flCurrentScale + k_flStepUp;
+
+		return flCurrentScale;
+	}
+};
+
+
+/// Only reacts after the load has been out of band for a number of consecutive frames, then jumps straight to
+/// the scale that should hit the target load (GPU cost is roughly proportional to the pixel count, i.e. scale squared)
+class HysteresisDynamicResolutionPolicy : public IDynamicResolutionPolicy
+{
+public:
+	void Reset() override
+	{
+		m_nFramesOverBudget = 0;
+		m_nFramesUnderBudget = 0;
+	}
+
+	float Update( float flCurrentScale, float flGpuLoad, bool bMissedFrame ) override
+	{
+		static const float k_flUpperLoad = 0.92f;
+		static const float k_flLowerLoad = 0.7f;
+		static const uint32_t k_nFramesBeforeDecrease = 2;
+		static const uint32_t k_nFramesBeforeIncrease = 45;
+
+		m_nFramesOverBudget = ( bMissedFrame || flGpuLoad > k_flUpperLoad ) ? m_nFramesOverBudget + 1 : 0;
+		m_nFramesUnderBudget = ( !bMissedFrame && flGpuLoad < k_flLowerLoad ) ? m_nFramesUnderBudget + 1 : 0;
+
+		// Drop right away on a missed frame, reprojection is what we're trying to avoid
+		if ( bMissedFrame || m_nFramesOverBudget >= k_nFramesBeforeDecrease || m_nFramesUnderBudget >= k_nFramesBeforeIncrease )
+		{
+			Reset();
+
+			float flLoad = std::max( flGpuLoad, bMissedFrame ? 1.0f : 0.01f );
+			return flCurrentScale * sqrtf( k_flDynamicResolutionTargetGpuLoad / flLoad );
+		}
+
+		return flCurrentScale;
+	}
+
+private:
+	uint32_t m_nFramesOverBudget = 0;
+	uint32_t m_nFramesUnderBudget = 0;
+};
+
+
+/// PID controller on the difference between the target and the measured GPU load
+class PIDDynamicResolutionPolicy : public IDynamicResolutionPolicy
+{
+public:
+	void Reset() override
+	{
+		m_flIntegral = 0.0f;
+		m_flPrevError = 0.0f;
+	}
+
+	float Update( float flCurrentScale, float flGpuLoad, bool bMissedFrame ) override
+	{
+		static const float k_flKp = 0.1f;
+		static const float k_flKi = 0.01f;
+		static const float k_flKd = 0.05f;
+		static const float k_flMaxIntegral = 2.0f;
+		static const float k_flMissedFrameLoad = 1.2f;
+
+		// Treat a missed frame as a large overshoot, the measured GPU time alone doesn't always show it
+		float flLoad = bMissedFrame ? std::max( flGpuLoad, k_flMissedFrameLoad ) : flGpuLoad;
+		float flError = k_flDynamicResolutionTargetGpuLoad - flLoad;
+
+		m_flIntegral = std::clamp( m_flIntegral + flError, -k_flMaxIntegral, k_flMaxIntegral );
+		float flDerivative = flError - m_flPrevError;
+		m_flPrevError = flError;
+
+		return flCurrentScale + ( k_flKp * flError ) + ( k_flKi * m_flIntegral ) + ( k_flKd * flDerivative );
+	}
+
+private:
+	float m_flIntegral = 0.0f;
+	float m_flPrevError = 0.0f;
+};
+
+
+DynamicResolutionController::DynamicResolutionController()
+{
+}
+
+
+void DynamicResolutionController::SetPolicy( EVRDynamicResolutionPolicy ePolicy )
+{
+	if ( ePolicy == m_ePolicy )
+		return;
+
+	XR_TRACE( "[OpenVR] Dynamic resolution policy set to %i\n", ePolicy );
+
+	m_ePolicy = ePolicy;
+	m_flScale = m_flMaxScale;
+
+	switch ( ePolicy )
+	{
+	case DynamicResolutionPolicy_Step:
+		m_pPolicy.reset( new StepDynamicResolutionPolicy() );
+		break;
+
+	case DynamicResolutionPolicy_Hysteresis:
+		m_pPolicy.reset( new HysteresisDynamicResolutionPolicy() );
+		break;
+
+	case DynamicResolutionPolicy_PID:
+		m_pPolicy.reset( new PIDDynamicResolutionPolicy() );
+		break;
+
+	default:
+		m_ePolicy = DynamicResolutionPolicy_Disabled;
+		m_pPolicy.reset();
+		m_flScale = 1.0f;
+		break;
+	}
+}
+
+
+void DynamicResolutionController::SetScaleRange( float flMinScale, float flMaxScale )
+{
+	m_flMaxScale = std::clamp( flMaxScale, k_flDynamicResolutionMinScale, 1.0f );
+	m_flMinScale = std::clamp( flMinScale, k_flDynamicResolutionMinScale, m_flMaxScale );
+
+	if ( m_pPolicy )
+	{
+		m_flScale = std::clamp( m_flScale, m_flMinScale, m_flMaxScale );
+	}
+}
+
+
+void DynamicResolutionController::Update( const vr::Compositor_FrameTiming &frameTiming, float flDisplayFrequency )
+{
+	if ( !m_pPolicy || flDisplayFrequency <= 0.0f || frameTiming.m_nFrameIndex == m_nLastFrameIndex )
+		return;
+
+	m_nLastFrameIndex = frameTiming.m_nFrameIndex;
+
+	float flFrameBudgetMs = 1000.0f / flDisplayFrequency;
+	float flGpuLoad = frameTiming.m_flTotalRenderGpuMs / flFrameBudgetMs;
+
+	// Presenting the same frame more than once means the compositor had to reproject it
+	bool bMissedFrame = frameTiming.m_nNumDroppedFrames > 0 || frameTiming.m_nNumFramePresents > 1;
+
+	m_flScale = std::clamp( m_pPolicy->Update( m_flScale, flGpuLoad, bMissedFrame ), m_flMinScale, m_flMaxScale );
+}
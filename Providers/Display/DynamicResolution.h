@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+
+#include "UserProjectSettings.h"
+
+/// GPU frame time, as a fraction of the frame budget, the controllers try to settle at
+static const float k_flDynamicResolutionTargetGpuLoad = 0.85f;
+
+/// Lowest scale the controller is allowed to go to, regardless of the configured floor
+static const float k_flDynamicResolutionMinScale = 0.1f;
+
+/// Strategy for turning the GPU load of the last frame into a new resolution scale
+class IDynamicResolutionPolicy
+{
+public:
+	virtual ~IDynamicResolutionPolicy() {}
+
+	/// Drop any state accumulated from previous frames
+	virtual void Reset() = 0;
+
+	/// Compute the resolution scale for the next frame
+	/// @param[in] float flCurrentScale - The scale the last frame was rendered with
+	/// @param[in] float flGpuLoad - GPU frame time of the last frame divided by the frame budget
+	/// @param[in] bool bMissedFrame - If the compositor had to drop or reproject a frame
+	/// @return float - The new, unclamped, resolution scale
+	virtual float Update( float flCurrentScale, float flGpuLoad, bool bMissedFrame ) = 0;
+};
+
+/// Closed loop controller that scales the eye viewports to keep the GPU within the compositor's frame budget.
+/// The eye textures stay allocated at full size, only the rendered viewport and the submitted texture bounds shrink.
+class DynamicResolutionController
+{
+public:
+	DynamicResolutionController();
+
+	/// Switch to a different policy, resets the scale to the ceiling
+	/// @param[in] EVRDynamicResolutionPolicy ePolicy - The policy to use, DynamicResolutionPolicy_Disabled to always render at full size
+	void SetPolicy( EVRDynamicResolutionPolicy ePolicy );
+
+	/// Get the active policy
+	EVRDynamicResolutionPolicy GetPolicy() const { return m_ePolicy; }
+
+	/// Set the floor and ceiling of the resolution scale
+	/// @param[in] float flMinScale - The lowest scale the controller may pick
+	/// @param[in] float flMaxScale - The highest scale the controller may pick, at most 1 as the eye textures don't grow
+	void SetScaleRange( float flMinScale, float flMaxScale );
+
+	/// Feed the controller the compositor timing of the last frame
+	/// @param[in] const Compositor_FrameTiming& frameTiming - Compositor timing for the most recent frame
+	/// @param[in] float flDisplayFrequency - Display refresh rate in Hz, used to derive the frame budget
+	void Update( const vr::Compositor_FrameTiming &frameTiming, float flDisplayFrequency );
+
+	/// Get the resolution scale the next frame should be rendered with
+	float GetScale() const { return m_flScale; }
+
+private:
+	EVRDynamicResolutionPolicy m_ePolicy = DynamicResolutionPolicy_Disabled;
+	std::unique_ptr< IDynamicResolutionPolicy > m_pPolicy;
+
+	float m_flMinScale = k_flDefaultDynamicResolutionMinScale;
+	float m_flMaxScale = k_flDefaultDynamicResolutionMaxScale;
+	float m_flScale = 1.0f;
+
+	/// Compositor frame index of the last sample, so a frame is only ever accounted for once
+	uint32_t m_nLastFrameIndex = 0;
+};
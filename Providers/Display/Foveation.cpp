@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Foveation.h"
+
+
+bool GetFoveationProfile( EVRFoveationLevel eLevel, FoveationProfile &profile )
+{
+	switch ( eLevel )
+	{
+	case FoveationLevel_Low:
+		profile = { 0.6f, 1.4f, 0.5f };
+		return true;
+
+	case FoveationLevel_Medium:
+		profile = { 0.45f, 1.1f, 0.5f };
+		return true;
+
+	case FoveationLevel_High:
+		profile = { 0.3f, 0.8f, 0.25f };
+		return true;
+
+	default:
+		profile = { 0.0f, 0.0f, 1.0f };
+		return false;
+	}
+}
+
+
+void BuildFragmentDensityMap( const float rawProjection[4], float flGazeX, float flGazeY, const FoveationProfile &profile,
+	uint32_t nWidth, uint32_t nHeight, float flViewportScale, bool bBottomUp, uint8_t *pDensity )
+{
+	float flLeft = rawProjection[0];
+	float flRight = rawProjection[1];
+	float flTop = rawProjection[2];
+	float flBottom = rawProjection[3];
+
+	// GetProjectionRaw tangents grow downwards
+	float flCenterX = flGazeX;
+	float flCenterY = -flGazeY;
+
+	float flFalloff = std::max( profile.flOuterRadius - profile.flInnerRadius, 0.0001f );
+
+	// The view is rendered into the first rows and columns of the texture, nothing else gets shaded
+	flViewportScale = std::clamp( flViewportScale, 0.01f, 1.0f );
+	uint32_t nViewWidth = std::clamp( (uint32_t )ceilf( nWidth * flViewportScale ), 1u, nWidth );
+	uint32_t nViewHeight = std::clamp( (uint32_t )ceilf( nHeight * flViewportScale ), 1u, nHeight );
+
+	if ( nViewWidth < nWidth || nViewHeight < nHeight )
+	{
+		memset( pDensity, (uint8_t )( profile.flMinDensity * 255.0f + 0.5f ), nWidth * nHeight * 2 );
+	}
+
+	float flStepX = ( flRight - flLeft ) / ( nWidth * flViewportScale );
+	float flStepY = ( flBottom - flTop ) / ( nHeight * flViewportScale );
+
+	for ( uint32_t y = 0; y < nViewHeight; ++y )
+	{
+		uint32_t nRow = bBottomUp ? nViewHeight - 1 - y : y;
+		float flDy = flTop + ( y + 0.5f ) * flStepY - flCenterY;
+
+		uint8_t *pRow = pDensity + nRow * nWidth * 2;
+		for ( uint32_t x = 0; x < nViewWidth; ++x )
+		{
+			float flDx = flLeft + ( x + 0.5f ) * flStepX - flCenterX;
+			float flDistance = sqrtf( flDx * flDx + flDy * flDy );
+
+			// Smoothstep from full rate at the inner radius to the minimum at the outer radius
+			float t = std::clamp( ( flDistance - profile.flInnerRadius ) / flFalloff, 0.0f, 1.0f );
+			t = t * t * ( 3.0f - 2.0f * t );
+			float flDensity = 1.0f + ( profile.flMinDensity - 1.0f ) * t;
+
+			uint8_t nDensity = (uint8_t )( flDensity * 255.0f + 0.5f );
+			pRow[x * 2 + 0] = nDensity;
+			pRow[x * 2 + 1] = nDensity;
+		}
+	}
+}
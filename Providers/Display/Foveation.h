@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "UserProjectSettings.h"
+
+/// Shape of a radial foveation profile. Radii are in tangent space, so the profile covers the same part of the
+/// field of view regardless of the eye texture resolution.
+struct FoveationProfile
+{
+	/// Distance from the center up to which everything is shaded at full rate
+	float flInnerRadius;
+
+	/// Distance from the center beyond which everything is shaded at the minimum rate
+	float flOuterRadius;
+
+	/// Shading density at and beyond the outer radius, 1 being full rate
+	float flMinDensity;
+};
+
+/// Get the radial profile for a foveation level
+/// @param[in] EVRFoveationLevel eLevel - The requested level
+/// @param[out] FoveationProfile& profile - The profile for the level
+/// @return bool - false if foveation is off
+bool GetFoveationProfile( EVRFoveationLevel eLevel, FoveationProfile &profile );
+
+/// Fill a fragment density map (two 8 bit channels per texel, horizontal and vertical density) with a radial profile
+/// centered on the gaze. With no gaze (0, 0) the profile is centered on the projection center of the eye, which
+/// is off-center in the texture for the asymmetric frustums most HMDs have. With a viewport scale below 1 the view
+/// only covers the bottom left of the texture, the texels outside of it get the minimum density.
+/// @param[in] const float rawProjection[4] - Left, right, top and bottom tangents of the eye as returned by IVRSystem::GetProjectionRaw
+/// @param[in] float flGazeX - Tangent of the horizontal gaze angle, positive to the right
+/// @param[in] float flGazeY - Tangent of the vertical gaze angle, positive up
+/// @param[in] const FoveationProfile& profile - Shape of the profile
+/// @param[in] uint32_t nWidth - Width of the density map in texels
+/// @param[in] uint32_t nHeight - Height of the density map in texels
+/// @param[in] float flViewportScale - Fraction of the texture width and height the view is rendered into
+/// @param[in] bool bBottomUp - Write the bottom row of the view first, to match textures Unity renders upside down
+/// @param[out] uint8_t* pDensity - nWidth * nHeight * 2 bytes
+void BuildFragmentDensityMap( const float rawProjection[4], float flGazeX, float flGazeY, const FoveationProfile &profile,
+	uint32_t nWidth, uint32_t nHeight, float flViewportScale, bool bBottomUp, uint8_t *pDensity );
@@ -0,0 +1,382 @@
+#include <algorithm>
+#include <cstring>
+
+#include "FragmentDensityMap.h"
+#include "CommonTypes.h"
+
+// Largest update vkCmdUpdateBuffer accepts in one call
+static const uint32_t k_nMaxUpdateBufferSize = 65536;
+
+// Preferred density map texel size in pixels, clamped to what the device supports
+static const uint32_t k_nPreferredTexelSize = 32;
+
+
+bool FragmentDensityMapCache::Initialize( IUnityGraphicsVulkan *pUnityVulkan )
+{
+	if ( !pUnityVulkan )
+	{
+		m_bSupported = false;
+		return false;
+	}
+
+	UnityVulkanInstance instance = pUnityVulkan->Instance();
+
+	// Keep the existing maps, the eye textures created with them may outlive a graphics thread restart
+	if ( m_bSupported && m_pUnityVulkan == pUnityVulkan && m_device == instance.device )
+		return true;
+
+	m_pUnityVulkan = pUnityVulkan;
+	m_bSupported = false;
+
+	if ( !instance.getInstanceProcAddr || !instance.device || !instance.graphicsQueue )
+		return false;
+
+	m_device = instance.device;
+	m_queue = instance.graphicsQueue;
+
+	PFN_vkGetPhysicalDeviceFeatures2 vkGetPhysicalDeviceFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2 )instance.getInstanceProcAddr( instance.instance, "vkGetPhysicalDeviceFeatures2" );
+	if ( !vkGetPhysicalDeviceFeatures2 )
+	{
+		vkGetPhysicalDeviceFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2 )instance.getInstanceProcAddr( instance.instance, "vkGetPhysicalDeviceFeatures2KHR" );
+	}
+
+	PFN_vkGetPhysicalDeviceProperties2 vkGetPhysicalDeviceProperties2 = (PFN_vkGetPhysicalDeviceProperties2 )instance.getInstanceProcAddr( instance.instance, "vkGetPhysicalDeviceProperties2" );
+	if ( !vkGetPhysicalDeviceProperties2 )
+	{
+		vkGetPhysicalDeviceProperties2 = (PFN_vkGetPhysicalDeviceProperties2 )instance.getInstanceProcAddr( instance.instance, "vkGetPhysicalDeviceProperties2KHR" );
+	}
+
+	PFN_vkGetPhysicalDeviceFormatProperties vkGetPhysicalDeviceFormatProperties = (PFN_vkGetPhysicalDeviceFormatProperties )instance.getInstanceProcAddr( instance.instance, "vkGetPhysicalDeviceFormatProperties" );
+	PFN_vkGetPhysicalDeviceMemoryProperties vkGetPhysicalDeviceMemoryProperties = (PFN_vkGetPhysicalDeviceMemoryProperties )instance.getInstanceProcAddr( instance.instance, "vkGetPhysicalDeviceMemoryProperties" );
+	PFN_vkGetDeviceProcAddr vkGetDeviceProcAddr = (PFN_vkGetDeviceProcAddr )instance.getInstanceProcAddr( instance.instance, "vkGetDeviceProcAddr" );
+
+	if ( !vkGetPhysicalDeviceFeatures2 || !vkGetPhysicalDeviceProperties2 || !vkGetPhysicalDeviceFormatProperties || !vkGetPhysicalDeviceMemoryProperties || !vkGetDeviceProcAddr )
+	{
+		XR_TRACE( "[OpenVR] Foveated rendering unavailable, missing Vulkan 1.1 physical device queries\n" );
+		return false;
+	}
+
+	// The device has to support the extension, Unity only creates shading rate textures if it also enabled it
+	VkPhysicalDeviceFragmentDensityMapFeaturesEXT densityMapFeatures = {};
+	densityMapFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_DENSITY_MAP_FEATURES_EXT;
+
+	VkPhysicalDeviceFeatures2 features = {};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &densityMapFeatures;
+	vkGetPhysicalDeviceFeatures2( instance.physicalDevice, &features );
+
+	if ( !densityMapFeatures.fragmentDensityMap )
+	{
+		XR_TRACE( "[OpenVR] Foveated rendering unavailable, VK_EXT_fragment_density_map isn't supported\n" );
+		return false;
+	}
+
+	VkFormatProperties formatProperties = {};
+	vkGetPhysicalDeviceFormatProperties( instance.physicalDevice, VK_FORMAT_R8G8_UNORM, &formatProperties );
+	if ( ( formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_FRAGMENT_DENSITY_MAP_BIT_EXT ) == 0 )
+	{
+		XR_TRACE( "[OpenVR] Foveated rendering unavailable, R8G8 density maps aren't supported\n" );
+		return false;
+	}
+
+	VkPhysicalDeviceFragmentDensityMapPropertiesEXT densityMapProperties = {};
+	densityMapProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_DENSITY_MAP_PROPERTIES_EXT;
+
+	VkPhysicalDeviceProperties2 properties = {};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &densityMapProperties;
+	vkGetPhysicalDeviceProperties2( instance.physicalDevice, &properties );
+
+	m_texelSize.width = std::clamp( k_nPreferredTexelSize, std::max( densityMapProperties.minFragmentDensityTexelSize.width, 1u ), std::max( densityMapProperties.maxFragmentDensityTexelSize.width, 1u ) );
+	m_texelSize.height = std::clamp( k_nPreferredTexelSize, std::max( densityMapProperties.minFragmentDensityTexelSize.height, 1u ), std::max( densityMapProperties.maxFragmentDensityTexelSize.height, 1u ) );
+
+	vkGetPhysicalDeviceMemoryProperties( instance.physicalDevice, &m_memoryProperties );
+
+	m_vkCreateImage = (PFN_vkCreateImage )vkGetDeviceProcAddr( m_device, "vkCreateImage" );
+	m_vkDestroyImage = (PFN_vkDestroyImage )vkGetDeviceProcAddr( m_device, "vkDestroyImage" );
+	m_vkGetImageMemoryRequirements = (PFN_vkGetImageMemoryRequirements )vkGetDeviceProcAddr( m_device, "vkGetImageMemoryRequirements" );
+	m_vkBindImageMemory = (PFN_vkBindImageMemory )vkGetDeviceProcAddr( m_device, "vkBindImageMemory" );
+	m_vkCreateBuffer = (PFN_vkCreateBuffer )vkGetDeviceProcAddr( m_device, "vkCreateBuffer" );
+	m_vkDestroyBuffer = (PFN_vkDestroyBuffer )vkGetDeviceProcAddr( m_device, "vkDestroyBuffer" );
+	m_vkGetBufferMemoryRequirements = (PFN_vkGetBufferMemoryRequirements )vkGetDeviceProcAddr( m_device, "vkGetBufferMemoryRequirements" );
+	m_vkBindBufferMemory = (PFN_vkBindBufferMemory )vkGetDeviceProcAddr( m_device, "vkBindBufferMemory" );
+	m_vkAllocateMemory = (PFN_vkAllocateMemory )vkGetDeviceProcAddr( m_device, "vkAllocateMemory" );
+	m_vkFreeMemory = (PFN_vkFreeMemory )vkGetDeviceProcAddr( m_device, "vkFreeMemory" );
+	m_vkQueueWaitIdle = (PFN_vkQueueWaitIdle )vkGetDeviceProcAddr( m_device, "vkQueueWaitIdle" );
+	m_vkCmdPipelineBarrier = (PFN_vkCmdPipelineBarrier )vkGetDeviceProcAddr( m_device, "vkCmdPipelineBarrier" );
+	m_vkCmdUpdateBuffer = (PFN_vkCmdUpdateBuffer )vkGetDeviceProcAddr( m_device, "vkCmdUpdateBuffer" );
+	m_vkCmdCopyBufferToImage = (PFN_vkCmdCopyBufferToImage )vkGetDeviceProcAddr( m_device, "vkCmdCopyBufferToImage" );
+
+	m_bSupported = m_vkCreateImage && m_vkDestroyImage && m_vkGetImageMemoryRequirements && m_vkBindImageMemory
+		&& m_vkCreateBuffer && m_vkDestroyBuffer && m_vkGetBufferMemoryRequirements && m_vkBindBufferMemory
+		&& m_vkAllocateMemory && m_vkFreeMemory && m_vkQueueWaitIdle && m_vkCmdPipelineBarrier && m_vkCmdUpdateBuffer && m_vkCmdCopyBufferToImage;
+
+	XR_TRACE( "[OpenVR] Fragment density maps %s, texel size %ux%u\n", m_bSupported ? "supported" : "unavailable", m_texelSize.width, m_texelSize.height );
+
+	return m_bSupported;
+}
+
+
+void FragmentDensityMapCache::Shutdown()
+{
+	// Unity's command buffers read the maps while rendering and the uploads read the staging buffers, neither is fenced by us
+	if ( !m_vMaps.empty() && m_queue != VK_NULL_HANDLE )
+	{
+		m_vkQueueWaitIdle( m_queue );
+	}
+
+	for ( std::unique_ptr< DensityMap > &pMap : m_vMaps )
+	{
+		Destroy( *pMap );
+	}
+
+	m_vMaps.clear();
+	m_bSupported = false;
+}
+
+
+void *FragmentDensityMapCache::GetDensityMap( uint32_t nTextureWidth, uint32_t nTextureHeight, uint32_t nLayers, int eye )
+{
+	if ( !m_bSupported )
+		return nullptr;
+
+	if ( nLayers > 1 )
+	{
+		eye = 0;
+	}
+
+	for ( std::unique_ptr< DensityMap > &pMap : m_vMaps )
+	{
+		if ( pMap->nTextureWidth == nTextureWidth && pMap->nTextureHeight == nTextureHeight && pMap->nLayers == nLayers && pMap->eye == eye )
+			return &pMap->image;
+	}
+
+	std::unique_ptr< DensityMap > pMap( new DensityMap() );
+	DensityMap &map = *pMap;
+	map.nTextureWidth = nTextureWidth;
+	map.nTextureHeight = nTextureHeight;
+	map.nLayers = nLayers;
+	map.eye = eye;
+	map.nWidth = ( nTextureWidth + m_texelSize.width - 1 ) / m_texelSize.width;
+	map.nHeight = ( nTextureHeight + m_texelSize.height - 1 ) / m_texelSize.height;
+	map.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+	map.vDensity.resize( ( ( map.nWidth * map.nHeight * nLayers * 2 ) + 3 ) & ~3u, 0 );
+
+	VkImageCreateInfo imageInfo = {};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.format = VK_FORMAT_R8G8_UNORM;
+	imageInfo.extent = { map.nWidth, map.nHeight, 1 };
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = nLayers;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage = VK_IMAGE_USAGE_FRAGMENT_DENSITY_MAP_BIT_EXT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	// Uploads go through vkCmdUpdateBuffer, so the data is captured when the command is recorded and no host visible memory is needed
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = map.vDensity.size();
+	bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	bool bSuccess = m_vkCreateImage( m_device, &imageInfo, nullptr, &map.image ) == VK_SUCCESS
+		&& m_vkCreateBuffer( m_device, &bufferInfo, nullptr, &map.buffer ) == VK_SUCCESS;
+
+	if ( bSuccess )
+	{
+		VkMemoryRequirements imageRequirements;
+		m_vkGetImageMemoryRequirements( m_device, map.image, &imageRequirements );
+
+		VkMemoryAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = imageRequirements.size;
+		allocInfo.memoryTypeIndex = FindMemoryType( imageRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT );
+
+		bSuccess = allocInfo.memoryTypeIndex != UINT32_MAX
+			&& m_vkAllocateMemory( m_device, &allocInfo, nullptr, &map.imageMemory ) == VK_SUCCESS
+			&& m_vkBindImageMemory( m_device, map.image, map.imageMemory, 0 ) == VK_SUCCESS;
+	}
+
+	if ( bSuccess )
+	{
+		VkMemoryRequirements bufferRequirements;
+		m_vkGetBufferMemoryRequirements( m_device, map.buffer, &bufferRequirements );
+
+		VkMemoryAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = bufferRequirements.size;
+		allocInfo.memoryTypeIndex = FindMemoryType( bufferRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT );
+
+		bSuccess = allocInfo.memoryTypeIndex != UINT32_MAX
+			&& m_vkAllocateMemory( m_device, &allocInfo, nullptr, &map.bufferMemory ) == VK_SUCCESS
+			&& m_vkBindBufferMemory( m_device, map.buffer, map.bufferMemory, 0 ) == VK_SUCCESS;
+	}
+
+	if ( !bSuccess )
+	{
+		XR_TRACE( "[OpenVR] [Error] Unable to create a %ux%u fragment density map\n", map.nWidth, map.nHeight );
+		Destroy( map );
+		return nullptr;
+	}
+
+	XR_TRACE( "[OpenVR] Created %ux%u fragment density map (layers: %u, eye: %i)\n", map.nWidth, map.nHeight, nLayers, eye );
+
+	Generate( map );
+	m_vMaps.push_back( std::move( pMap ) );
+
+	return &m_vMaps.back()->image;
+}
+
+
+void FragmentDensityMapCache::Update( const float rawProjection[2][4], const float gaze[2][2], const FoveationProfile &profile, float flViewportScale )
+{
+	if ( memcmp( m_rawProjection, rawProjection, sizeof( m_rawProjection ) ) == 0
+		&& memcmp( m_gaze, gaze, sizeof( m_gaze ) ) == 0
+		&& memcmp( &m_profile, &profile, sizeof( FoveationProfile ) ) == 0
+		&& m_flViewportScale == flViewportScale )
+	{
+		return;
+	}
+
+	memcpy( m_rawProjection, rawProjection, sizeof( m_rawProjection ) );
+	memcpy( m_gaze, gaze, sizeof( m_gaze ) );
+	m_profile = profile;
+	m_flViewportScale = flViewportScale;
+
+	for ( std::unique_ptr< DensityMap > &pMap : m_vMaps )
+	{
+		Generate( *pMap );
+	}
+}
+
+
+void FragmentDensityMapCache::Flush()
+{
+	bool bAnyDirty = false;
+	for ( const std::unique_ptr< DensityMap > &pMap : m_vMaps )
+	{
+		bAnyDirty = bAnyDirty || pMap->bDirty;
+	}
+
+	if ( !bAnyDirty )
+		return;
+
+	// Copies can't be recorded inside a render pass
+	m_pUnityVulkan->EnsureOutsideRenderPass();
+
+	UnityVulkanRecordingState recordingState;
+	if ( !m_pUnityVulkan->CommandRecordingState( &recordingState, kUnityVulkanGraphicsQueueAccess_DontCare ) )
+		return;
+
+	VkCommandBuffer commandBuffer = recordingState.commandBuffer;
+
+	for ( std::unique_ptr< DensityMap > &pMap : m_vMaps )
+	{
+		DensityMap &map = *pMap;
+		if ( !map.bDirty )
+			continue;
+
+		// The previous upload has to be done reading the buffer before it gets overwritten
+		VkBufferMemoryBarrier bufferBarrier = {};
+		bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		bufferBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		bufferBarrier.buffer = map.buffer;
+		bufferBarrier.offset = 0;
+		bufferBarrier.size = VK_WHOLE_SIZE;
+		m_vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 1, &bufferBarrier, 0, nullptr );
+
+		for ( size_t nOffset = 0; nOffset < map.vDensity.size(); nOffset += k_nMaxUpdateBufferSize )
+		{
+			size_t nSize = std::min( map.vDensity.size() - nOffset, (size_t )k_nMaxUpdateBufferSize );
+			m_vkCmdUpdateBuffer( commandBuffer, map.buffer, nOffset, nSize, map.vDensity.data() + nOffset );
+		}
+
+		bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		bufferBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+		VkImageMemoryBarrier imageBarrier = {};
+		imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		imageBarrier.srcAccessMask = map.layout == VK_IMAGE_LAYOUT_UNDEFINED ? 0 : VK_ACCESS_FRAGMENT_DENSITY_MAP_READ_BIT_EXT;
+		imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		imageBarrier.oldLayout = map.layout;
+		imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageBarrier.image = map.image;
+		imageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, map.nLayers };
+
+		VkPipelineStageFlags srcStages = VK_PIPELINE_STAGE_TRANSFER_BIT | ( map.layout == VK_IMAGE_LAYOUT_UNDEFINED ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_FRAGMENT_DENSITY_PROCESS_BIT_EXT );
+		m_vkCmdPipelineBarrier( commandBuffer, srcStages, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 1, &bufferBarrier, 1, &imageBarrier );
+
+		// Layers are stored one after the other, tightly packed
+		VkBufferImageCopy region = {};
+		region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, map.nLayers };
+		region.imageExtent = { map.nWidth, map.nHeight, 1 };
+		m_vkCmdCopyBufferToImage( commandBuffer, map.buffer, map.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region );
+
+		imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		imageBarrier.dstAccessMask = VK_ACCESS_FRAGMENT_DENSITY_MAP_READ_BIT_EXT;
+		imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		imageBarrier.newLayout = VK_IMAGE_LAYOUT_FRAGMENT_DENSITY_MAP_OPTIMAL_EXT;
+		m_vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_DENSITY_PROCESS_BIT_EXT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier );
+
+		map.layout = VK_IMAGE_LAYOUT_FRAGMENT_DENSITY_MAP_OPTIMAL_EXT;
+		map.bDirty = false;
+	}
+}
+
+
+uint32_t FragmentDensityMapCache::FindMemoryType( uint32_t nTypeBits, VkMemoryPropertyFlags properties ) const
+{
+	for ( uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; ++i )
+	{
+		if ( ( nTypeBits & ( 1u << i ) ) && ( m_memoryProperties.memoryTypes[i].propertyFlags & properties ) == properties )
+			return i;
+	}
+
+	return UINT32_MAX;
+}
+
+
+void FragmentDensityMapCache::Generate( DensityMap &map )
+{
+	uint32_t nLayerSize = map.nWidth * map.nHeight * 2;
+
+	for ( uint32_t layer = 0; layer < map.nLayers; ++layer )
+	{
+		// Texture arrays hold one eye per layer
+		int eye = map.nLayers > 1 ? (int )std::min( layer, 1u ) : map.eye;
+
+		// Unity renders into its textures upside down (bottom row first)
+		BuildFragmentDensityMap( m_rawProjection[eye], m_gaze[eye][0], m_gaze[eye][1], m_profile, map.nWidth, map.nHeight, m_flViewportScale, true, map.vDensity.data() + layer * nLayerSize );
+	}
+
+	map.bDirty = true;
+}
+
+
+void FragmentDensityMapCache::Destroy( DensityMap &map )
+{
+	if ( map.image != VK_NULL_HANDLE )
+		m_vkDestroyImage( m_device, map.image, nullptr );
+
+	if ( map.imageMemory != VK_NULL_HANDLE )
+		m_vkFreeMemory( m_device, map.imageMemory, nullptr );
+
+	if ( map.buffer != VK_NULL_HANDLE )
+		m_vkDestroyBuffer( m_device, map.buffer, nullptr );
+
+	if ( map.bufferMemory != VK_NULL_HANDLE )
+		m_vkFreeMemory( m_device, map.bufferMemory, nullptr );
+
+	map.image = VK_NULL_HANDLE;
+	map.imageMemory = VK_NULL_HANDLE;
+	map.buffer = VK_NULL_HANDLE;
+	map.bufferMemory = VK_NULL_HANDLE;
+}
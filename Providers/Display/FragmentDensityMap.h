@@ -0,0 +1,111 @@
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "Foveation.h"
+
+#include "ProviderInterface/IUnityGraphics.h"
+#include "ProviderInterface/IUnityGraphicsVulkan.h"
+
+/// Vulkan fragment density maps (VK_EXT_fragment_density_map) for the eye textures, handed to Unity through
+/// IUnityXRDisplayShadingRateExt::CreateTextureWithShadingRate. Maps are created per eye texture size and kept
+/// until Shutdown, as pooled eye textures keep referencing them after they've been released.
+class FragmentDensityMapCache
+{
+public:
+	/// Load the Vulkan entry points and check if the device can use fragment density maps. Does nothing if already
+	/// initialized for the same device, the maps stay alive across graphics thread restarts.
+	/// @param[in] IUnityGraphicsVulkan* pUnityVulkan - Unity's Vulkan interface
+	/// @return bool - false if fragment density maps aren't supported
+	bool Initialize( IUnityGraphicsVulkan *pUnityVulkan );
+
+	/// Wait for Unity's graphics queue to finish and destroy all density maps, the textures using them must have been destroyed already
+	void Shutdown();
+
+	/// If the device can use fragment density maps
+	bool IsSupported() const { return m_bSupported; }
+
+	/// Get the density map for an eye texture, creating it the first time
+	/// @param[in] uint32_t nTextureWidth - Width of the eye texture in pixels
+	/// @param[in] uint32_t nTextureHeight - Height of the eye texture in pixels
+	/// @param[in] uint32_t nLayers - 2 for a single pass texture array, 1 otherwise
+	/// @param[in] int eye - 0:Left, 1:Right, ignored for texture arrays where layer N is eye N
+	/// @return void* - Pointer to the VkImage, nullptr on failure
+	void *GetDensityMap( uint32_t nTextureWidth, uint32_t nTextureHeight, uint32_t nLayers, int eye );
+
+	/// Regenerate the density maps if the profile, gaze, projection or viewport scale changed since the last call
+	/// @param[in] const float rawProjection[2][4] - Raw projection of both eyes
+	/// @param[in] const float gaze[2][2] - Gaze tangents of both eyes
+	/// @param[in] const FoveationProfile& profile - Shape of the profile
+	/// @param[in] float flViewportScale - Viewport scale of the stage about to be rendered
+	void Update( const float rawProjection[2][4], const float gaze[2][2], const FoveationProfile &profile, float flViewportScale );
+
+	/// Record the upload of regenerated density maps into Unity's current command buffer, must be called on the graphics thread
+	void Flush();
+
+private:
+	struct DensityMap
+	{
+		VkImage image;
+		VkDeviceMemory imageMemory;
+		VkBuffer buffer;
+		VkDeviceMemory bufferMemory;
+		VkImageLayout layout;
+
+		uint32_t nTextureWidth;
+		uint32_t nTextureHeight;
+		uint32_t nLayers;
+		int eye;
+
+		uint32_t nWidth;
+		uint32_t nHeight;
+
+		/// Density values of all layers, padded to a multiple of 4 bytes for vkCmdUpdateBuffer
+		std::vector< uint8_t > vDensity;
+
+		/// If vDensity changed since the last upload
+		bool bDirty;
+	};
+
+	/// Find a memory type matching the requirements, or UINT32_MAX
+	uint32_t FindMemoryType( uint32_t nTypeBits, VkMemoryPropertyFlags properties ) const;
+
+	/// Fill the density values of a map from the last profile, gaze and projection
+	void Generate( DensityMap &map );
+
+	/// Free the Vulkan objects of a map
+	void Destroy( DensityMap &map );
+
+	IUnityGraphicsVulkan *m_pUnityVulkan = nullptr;
+	VkDevice m_device = VK_NULL_HANDLE;
+	VkQueue m_queue = VK_NULL_HANDLE;
+	VkPhysicalDeviceMemoryProperties m_memoryProperties = {};
+	VkExtent2D m_texelSize = { 32, 32 };
+	bool m_bSupported = false;
+
+	PFN_vkCreateImage m_vkCreateImage = nullptr;
+	PFN_vkDestroyImage m_vkDestroyImage = nullptr;
+	PFN_vkGetImageMemoryRequirements m_vkGetImageMemoryRequirements = nullptr;
+	PFN_vkBindImageMemory m_vkBindImageMemory = nullptr;
+	PFN_vkCreateBuffer m_vkCreateBuffer = nullptr;
+	PFN_vkDestroyBuffer m_vkDestroyBuffer = nullptr;
+	PFN_vkGetBufferMemoryRequirements m_vkGetBufferMemoryRequirements = nullptr;
+	PFN_vkBindBufferMemory m_vkBindBufferMemory = nullptr;
+	PFN_vkAllocateMemory m_vkAllocateMemory = nullptr;
+	PFN_vkFreeMemory m_vkFreeMemory = nullptr;
+	PFN_vkQueueWaitIdle m_vkQueueWaitIdle = nullptr;
+	PFN_vkCmdPipelineBarrier m_vkCmdPipelineBarrier = nullptr;
+	PFN_vkCmdUpdateBuffer m_vkCmdUpdateBuffer = nullptr;
+	PFN_vkCmdCopyBufferToImage m_vkCmdCopyBufferToImage = nullptr;
+
+	/// Maps are heap allocated so the VkImage pointers handed to Unity stay valid
+	std::vector< std::unique_ptr< DensityMap > > m_vMaps;
+
+	/// Inputs the maps were last generated from
+	float m_rawProjection[2][4] = {};
+	float m_gaze[2][2] = {};
+	FoveationProfile m_profile = { 0.0f, 0.0f, 1.0f };
+	float m_flViewportScale = 1.0f;
+};
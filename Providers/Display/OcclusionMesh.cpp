@@ -0,0 +1,96 @@
+#include <cmath>
+#include <unordered_map>
+
+#include "OcclusionMesh.h"
+
+
+static const uint32_t k_nInvalidVertexIndex = UINT32_MAX;
+
+/// Pack a 2D grid cell coordinate into a single hash key
+static inline uint64_t GetGridCellKey( int32_t nCellX, int32_t nCellY )
+{
+	return ( (uint64_t )(uint32_t )nCellX << 32 ) | (uint64_t )(uint32_t )nCellY;
+}
+
+
+bool WeldHiddenAreaMesh( const vr::HiddenAreaMesh_t &hiddenAreaMesh, vr::EHiddenAreaMeshType eType, float flEpsilon, WeldedHiddenAreaMesh &weldedMesh )
+{
+	weldedMesh.vVertices.clear();
+	weldedMesh.vIndices.clear();
+
+	if ( hiddenAreaMesh.pVertexData == nullptr || hiddenAreaMesh.unTriangleCount == 0 )
+		return false;
+
+	size_t nInputVertexCount = GetHiddenAreaMeshVertexCount( hiddenAreaMesh, eType );
+
+	if ( flEpsilon <= 0.0f )
+	{
+		flEpsilon = k_flDefaultHiddenAreaMeshWeldEpsilon;
+	}
+
+	const float flInvCellSize = 1.0f / flEpsilon;
+	const float flEpsilonSquared = flEpsilon * flEpsilon;
+
+	weldedMesh.vIndices.resize( nInputVertexCount );
+	weldedMesh.vVertices.reserve( nInputVertexCount );
+
+	// Grid cell -> first welded vertex in that cell, further vertices in the same cell are chained through vNextInCell
+	std::unordered_map< uint64_t, uint32_t > cellHeads;
+	cellHeads.reserve( nInputVertexCount );
+	std::vector< uint32_t > vNextInCell;
+	vNextInCell.reserve( nInputVertexCount );
+
+	for ( size_t nInputIndex = 0; nInputIndex < nInputVertexCount; nInputIndex++ )
+	{
+		const float *v = hiddenAreaMesh.pVertexData[nInputIndex].v;
+		int32_t nCellX = (int32_t )std::floor( v[0] * flInvCellSize );
+		int32_t nCellY = (int32_t )std::floor( v[1] * flInvCellSize );
+
+		// A vertex within epsilon of this one can only live in this cell or one of its 8 neighbours
+		uint32_t nWeldedIndex = k_nInvalidVertexIndex;
+		for ( int32_t dy = -1; dy <= 1 && nWeldedIndex == k_nInvalidVertexIndex; dy++ )
+		{
+			for ( int32_t dx = -1; dx <= 1 && nWeldedIndex == k_nInvalidVertexIndex; dx++ )
+			{
+				auto cell = cellHeads.find( GetGridCellKey( nCellX + dx, nCellY + dy ) );
+				if ( cell == cellHeads.end() )
+					continue;
+
+				for ( uint32_t nCandidate = cell->second; nCandidate != k_nInvalidVertexIndex; nCandidate = vNextInCell[nCandidate] )
+				{
+					const UnityXRVector2 &candidate = weldedMesh.vVertices[nCandidate];
+					float flDiffX = candidate.x - v[0];
+					float flDiffY = candidate.y - v[1];
+
+					if ( ( flDiffX * flDiffX ) + ( flDiffY * flDiffY ) < flEpsilonSquared )
+					{
+						nWeldedIndex = nCandidate;
+						break;
+					}
+				}
+			}
+		}
+
+		// No match, keep this vertex and push it at the head of its cell chain
+		if ( nWeldedIndex == k_nInvalidVertexIndex )
+		{
+			nWeldedIndex = (uint32_t )weldedMesh.vVertices.size();
+			weldedMesh.vVertices.push_back( { v[0], v[1] } );
+
+			auto insertResult = cellHeads.emplace( GetGridCellKey( nCellX, nCellY ), nWeldedIndex );
+			if ( insertResult.second )
+			{
+				vNextInCell.push_back( k_nInvalidVertexIndex );
+			}
+			else
+			{
+				vNextInCell.push_back( insertResult.first->second );
+				insertResult.first->second = nWeldedIndex;
+			}
+		}
+
+		weldedMesh.vIndices[nInputIndex] = nWeldedIndex;
+	}
+
+	return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "OpenVR/openvr.h"
+#include "ProviderInterface/UnityXRTypes.h"
+
+/// Default distance (in normalized viewport units) under which two hidden area mesh vertices are welded together
+static const float k_flDefaultHiddenAreaMeshWeldEpsilon = 0.00003f;
+
+/// A hidden area mesh with duplicate vertices welded together
+struct WeldedHiddenAreaMesh
+{
+	/// Unique vertices
+	std::vector< UnityXRVector2 > vVertices;
+
+	/// Triangle list indices (Standard, Inverse) or the ordered loop indices (LineLoop) into vVertices
+	std::vector< uint32_t > vIndices;
+};
+
+/// Number of vertices in an OpenVR hidden area mesh
+/// @param[in] const HiddenAreaMesh_t& hiddenAreaMesh - The mesh returned by IVRSystem::GetHiddenAreaMesh
+/// @param[in] EHiddenAreaMeshType eType - The type the mesh was requested with (LineLoop meshes store a vertex count instead of a triangle count)
+/// @return size_t - The number of entries in hiddenAreaMesh.pVertexData
+inline size_t GetHiddenAreaMeshVertexCount( const vr::HiddenAreaMesh_t &hiddenAreaMesh, vr::EHiddenAreaMeshType eType )
+{
+	return ( eType == vr::k_eHiddenAreaMesh_LineLoop ) ? (size_t )hiddenAreaMesh.unTriangleCount : (size_t )hiddenAreaMesh.unTriangleCount * 3;
+}
+
+/// Weld the duplicate vertices of an OpenVR hidden area mesh into a compact vertex and index buffer.
+/// Vertices are bucketed in a spatial hash grid with a cell size of flEpsilon, so each vertex only gets compared
+/// against the vertices of its neighbouring cells which keeps this linear in the number of input vertices.
+/// @param[in] const HiddenAreaMesh_t& hiddenAreaMesh - The mesh returned by IVRSystem::GetHiddenAreaMesh
+/// @param[in] EHiddenAreaMeshType eType - The type the mesh was requested with (LineLoop meshes store a vertex count instead of a triangle count)
+/// @param[in] float flEpsilon - Vertices closer than this are considered to be the same vertex
+/// @param[out] WeldedHiddenAreaMesh& weldedMesh - The welded mesh
+/// @return bool - false if the input mesh is empty
+bool WeldHiddenAreaMesh( const vr::HiddenAreaMesh_t &hiddenAreaMesh, vr::EHiddenAreaMeshType eType, float flEpsilon, WeldedHiddenAreaMesh &weldedMesh );
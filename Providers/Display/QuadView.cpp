@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <cmath>
+
+#include "QuadView.h"
+
+
+bool PlanQuadView( const float rawProjection[4], uint32_t nEyeWidth, uint32_t nEyeHeight, float flInsetFraction, float flWideScale, QuadViewPlan &plan )
+{
+	if ( nEyeWidth == 0 || nEyeHeight == 0 || flInsetFraction <= 0.0f || flInsetFraction >= 1.0f || flWideScale <= 0.0f || flWideScale >= 1.0f )
+		return false;
+
+	float flLeft = rawProjection[0];
+	float flRight = rawProjection[1];
+	float flTop = rawProjection[2];
+	float flBottom = rawProjection[3];
+
+	float flWidth = flRight - flLeft;
+	float flHeight = flBottom - flTop;
+	if ( flWidth <= 0.0f || flHeight <= 0.0f )
+		return false;
+
+	plan.nInsetWidth = std::clamp( (uint32_t )lroundf( nEyeWidth * flInsetFraction ), 1u, nEyeWidth );
+	plan.nInsetHeight = std::clamp( (uint32_t )lroundf( nEyeHeight * flInsetFraction ), 1u, nEyeHeight );
+
+	// Center the inset on the projection center (where the lens is sharpest), but keep it inside the eye's frustum
+	float flCenterX = -flLeft / flWidth * nEyeWidth;
+	float flCenterY = -flTop / flHeight * nEyeHeight;
+
+	long nInsetX = lroundf( flCenterX - plan.nInsetWidth * 0.5f );
+	long nInsetY = lroundf( flCenterY - plan.nInsetHeight * 0.5f );
+	plan.nInsetX = (uint32_t )std::clamp( nInsetX, 0l, (long )( nEyeWidth - plan.nInsetWidth ) );
+	plan.nInsetY = (uint32_t )std::clamp( nInsetY, 0l, (long )( nEyeHeight - plan.nInsetHeight ) );
+
+	// Derive the inset frustum from the snapped pixel rect so it lines up exactly with the eye texture
+	plan.insetRawProjection[0] = flLeft + flWidth * plan.nInsetX / nEyeWidth;
+	plan.insetRawProjection[1] = flLeft + flWidth * ( plan.nInsetX + plan.nInsetWidth ) / nEyeWidth;
+	plan.insetRawProjection[2] = flTop + flHeight * plan.nInsetY / nEyeHeight;
+	plan.insetRawProjection[3] = flTop + flHeight * ( plan.nInsetY + plan.nInsetHeight ) / nEyeHeight;
+
+	plan.nWideWidth = std::max( (uint32_t )lroundf( nEyeWidth * flWideScale ), 1u );
+	plan.nWideHeight = std::max( (uint32_t )lroundf( nEyeHeight * flWideScale ), 1u );
+
+	return true;
+}
+
+
+float GetQuadViewShadedPixelRatio( const QuadViewPlan &plan, uint32_t nEyeWidth, uint32_t nEyeHeight )
+{
+	if ( nEyeWidth == 0 || nEyeHeight == 0 )
+		return 1.0f;
+
+	float flShaded = (float )plan.nWideWidth * plan.nWideHeight + (float )plan.nInsetWidth * plan.nInsetHeight;
+	return flShaded / ( (float )nEyeWidth * nEyeHeight );
+}
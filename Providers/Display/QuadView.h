@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+
+/// Layout of the two views an eye is split into for quad view rendering: a low resolution wide view covering
+/// the eye's whole frustum and a full resolution inset around the projection center. The inset is aligned to
+/// whole eye texture pixels so it can be copied into the eye texture without resampling.
+struct QuadViewPlan
+{
+	/// Left, right, top and bottom tangents of the inset, in the same convention as IVRSystem::GetProjectionRaw
+	float insetRawProjection[4];
+
+	/// Size of the wide view texture
+	uint32_t nWideWidth;
+	uint32_t nWideHeight;
+
+	/// Size of the inset texture, also the size of the area it covers in the eye texture
+	uint32_t nInsetWidth;
+	uint32_t nInsetHeight;
+
+	/// Position of the inset in the eye texture, in pixels from the top left of the view
+	uint32_t nInsetX;
+	uint32_t nInsetY;
+};
+
+/// Plan the wide and inset views of an eye
+/// @param[in] const float rawProjection[4] - Left, right, top and bottom tangents of the eye as returned by IVRSystem::GetProjectionRaw
+/// @param[in] uint32_t nEyeWidth - Width of the eye texture the views get composited into
+/// @param[in] uint32_t nEyeHeight - Height of the eye texture the views get composited into
+/// @param[in] float flInsetFraction - Part of the field of view (per axis) the inset covers, between 0 and 1
+/// @param[in] float flWideScale - Resolution scale (per axis) of the wide view, between 0 and 1
+/// @param[out] QuadViewPlan& plan - The planned views
+/// @return bool - false if the parameters don't make quad view rendering worthwhile
+bool PlanQuadView( const float rawProjection[4], uint32_t nEyeWidth, uint32_t nEyeHeight, float flInsetFraction, float flWideScale, QuadViewPlan &plan );
+
+/// Number of pixels shaded for the two views of a plan, relative to rendering the eye texture directly
+/// @param[in] const QuadViewPlan& plan - The planned views
+/// @param[in] uint32_t nEyeWidth - Width of the eye texture
+/// @param[in] uint32_t nEyeHeight - Height of the eye texture
+/// @return float - Shaded pixel ratio, 0.5 means half the pixels get shaded
+float GetQuadViewShadedPixelRatio( const QuadViewPlan &plan, uint32_t nEyeWidth, uint32_t nEyeHeight );
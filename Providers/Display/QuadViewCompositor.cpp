@@ -0,0 +1,274 @@
+#include <algorithm>
+
+#include "QuadViewCompositor.h"
+#include "CommonTypes.h"
+
+// Longest the submit thread waits for a stage's previous composite before giving up, in nanoseconds
+static const uint64_t k_nCompositeFenceTimeoutNs = 100000000;
+
+
+bool QuadViewCompositor::Initialize( IUnityGraphicsVulkan *pUnityVulkan )
+{
+	if ( !pUnityVulkan )
+	{
+		m_bSupported = false;
+		return false;
+	}
+
+	UnityVulkanInstance instance = pUnityVulkan->Instance();
+
+	// Every graphics thread start lands here, the pool and fences are only released by Shutdown
+	if ( m_commandPool != VK_NULL_HANDLE && m_device == instance.device )
+		return m_bSupported;
+
+	m_pUnityVulkan = pUnityVulkan;
+	m_bSupported = false;
+
+	if ( !instance.getInstanceProcAddr || !instance.device || !instance.graphicsQueue )
+		return false;
+
+	PFN_vkGetDeviceProcAddr vkGetDeviceProcAddr = (PFN_vkGetDeviceProcAddr )instance.getInstanceProcAddr( instance.instance, "vkGetDeviceProcAddr" );
+	if ( !vkGetDeviceProcAddr )
+		return false;
+
+	m_device = instance.device;
+	m_queue = instance.graphicsQueue;
+
+	m_vkCreateCommandPool = (PFN_vkCreateCommandPool )vkGetDeviceProcAddr( m_device, "vkCreateCommandPool" );
+	m_vkDestroyCommandPool = (PFN_vkDestroyCommandPool )vkGetDeviceProcAddr( m_device, "vkDestroyCommandPool" );
+	m_vkAllocateCommandBuffers = (PFN_vkAllocateCommandBuffers )vkGetDeviceProcAddr( m_device, "vkAllocateCommandBuffers" );
+	m_vkBeginCommandBuffer = (PFN_vkBeginCommandBuffer )vkGetDeviceProcAddr( m_device, "vkBeginCommandBuffer" );
+	m_vkEndCommandBuffer = (PFN_vkEndCommandBuffer )vkGetDeviceProcAddr( m_device, "vkEndCommandBuffer" );
+	m_vkResetCommandBuffer = (PFN_vkResetCommandBuffer )vkGetDeviceProcAddr( m_device, "vkResetCommandBuffer" );
+	m_vkCreateFence = (PFN_vkCreateFence )vkGetDeviceProcAddr( m_device, "vkCreateFence" );
+	m_vkDestroyFence = (PFN_vkDestroyFence )vkGetDeviceProcAddr( m_device, "vkDestroyFence" );
+	m_vkWaitForFences = (PFN_vkWaitForFences )vkGetDeviceProcAddr( m_device, "vkWaitForFences" );
+	m_vkResetFences = (PFN_vkResetFences )vkGetDeviceProcAddr( m_device, "vkResetFences" );
+	m_vkQueueSubmit = (PFN_vkQueueSubmit )vkGetDeviceProcAddr( m_device, "vkQueueSubmit" );
+	m_vkCmdPipelineBarrier = (PFN_vkCmdPipelineBarrier )vkGetDeviceProcAddr( m_device, "vkCmdPipelineBarrier" );
+	m_vkCmdBlitImage = (PFN_vkCmdBlitImage )vkGetDeviceProcAddr( m_device, "vkCmdBlitImage" );
+	m_vkCmdCopyImage = (PFN_vkCmdCopyImage )vkGetDeviceProcAddr( m_device, "vkCmdCopyImage" );
+
+	if ( !m_vkCreateCommandPool || !m_vkDestroyCommandPool || !m_vkAllocateCommandBuffers || !m_vkBeginCommandBuffer || !m_vkEndCommandBuffer
+		|| !m_vkResetCommandBuffer || !m_vkCreateFence || !m_vkDestroyFence || !m_vkWaitForFences || !m_vkResetFences || !m_vkQueueSubmit
+		|| !m_vkCmdPipelineBarrier || !m_vkCmdBlitImage || !m_vkCmdCopyImage )
+	{
+		XR_TRACE( "[OpenVR] Quad view compositing unavailable, missing Vulkan entry points\n" );
+		return false;
+	}
+
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	poolInfo.queueFamilyIndex = instance.queueFamilyIndex;
+
+	if ( m_vkCreateCommandPool( m_device, &poolInfo, nullptr, &m_commandPool ) != VK_SUCCESS )
+	{
+		XR_TRACE( "[OpenVR] [Error] Unable to create the quad view command pool\n" );
+		return false;
+	}
+
+	m_bSupported = true;
+	return true;
+}
+
+
+void QuadViewCompositor::Shutdown()
+{
+	for ( StageCommands &stageCommands : m_vStageCommands )
+	{
+		if ( stageCommands.bSubmitted )
+		{
+			m_vkWaitForFences( m_device, 1, &stageCommands.fence, VK_TRUE, k_nCompositeFenceTimeoutNs );
+		}
+
+		m_vkDestroyFence( m_device, stageCommands.fence, nullptr );
+	}
+
+	m_vStageCommands.clear();
+
+	// Destroying the pool frees its command buffers
+	if ( m_commandPool != VK_NULL_HANDLE )
+	{
+		m_vkDestroyCommandPool( m_device, m_commandPool, nullptr );
+		m_commandPool = VK_NULL_HANDLE;
+	}
+
+	m_bSupported = false;
+}
+
+
+void QuadViewCompositor::Prepare( void *pEyeTexture )
+{
+	if ( !m_bSupported || !pEyeTexture )
+		return;
+
+	// Recorded into Unity's command buffer, so Unity keeps tracking the layout the compositor reads the texture in
+	UnityVulkanImage image;
+	m_pUnityVulkan->AccessTexture( pEyeTexture, UnityVulkanWholeImage, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, kUnityVulkanResourceAccess_PipelineBarrier, &image );
+}
+
+
+bool QuadViewCompositor::Composite( int nStage, void *const pWideTextures[2], void *const pInsetTextures[2], void *const pEyeTextures[2], const QuadViewPlan plans[2] )
+{
+	if ( !m_bSupported || nStage < 0 )
+		return false;
+
+	UnityVulkanImage wideImages[2];
+	UnityVulkanImage insetImages[2];
+	UnityVulkanImage eyeImages[2];
+
+	for ( int eye = 0; eye < 2; ++eye )
+	{
+		if ( !AccessImage( pWideTextures[eye], wideImages[eye] ) || !AccessImage( pInsetTextures[eye], insetImages[eye] ) || !AccessImage( pEyeTextures[eye], eyeImages[eye] ) )
+		{
+			XR_TRACE( "[OpenVR] [Error] Unable to get the quad view images for stage %i and eye %i\n", nStage, eye );
+			return false;
+		}
+
+		// Nothing has been rendered (or prepared) yet, and the images couldn't be moved back into an undefined layout
+		if ( wideImages[eye].layout == VK_IMAGE_LAYOUT_UNDEFINED || insetImages[eye].layout == VK_IMAGE_LAYOUT_UNDEFINED || eyeImages[eye].layout == VK_IMAGE_LAYOUT_UNDEFINED )
+			return false;
+	}
+
+	while ( (int )m_vStageCommands.size() <= nStage )
+	{
+		StageCommands stageCommands = {};
+
+		VkCommandBufferAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.commandPool = m_commandPool;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandBufferCount = 1;
+
+		VkFenceCreateInfo fenceInfo = {};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+		if ( m_vkAllocateCommandBuffers( m_device, &allocInfo, &stageCommands.commandBuffer ) != VK_SUCCESS
+			|| m_vkCreateFence( m_device, &fenceInfo, nullptr, &stageCommands.fence ) != VK_SUCCESS )
+		{
+			XR_TRACE( "[OpenVR] [Error] Unable to create the quad view command buffer for stage %i\n", nStage );
+			return false;
+		}
+
+		m_vStageCommands.push_back( stageCommands );
+	}
+
+	// The stage ring only hands this stage out again once the compositor is done with it, so this rarely waits
+	StageCommands &stageCommands = m_vStageCommands[nStage];
+	if ( stageCommands.bSubmitted )
+	{
+		if ( m_vkWaitForFences( m_device, 1, &stageCommands.fence, VK_TRUE, k_nCompositeFenceTimeoutNs ) != VK_SUCCESS )
+		{
+			XR_TRACE( "[OpenVR] [Error] Timed out waiting on the previous quad view composite of stage %i\n", nStage );
+			return false;
+		}
+
+		m_vkResetFences( m_device, 1, &stageCommands.fence );
+		stageCommands.bSubmitted = false;
+	}
+
+	VkCommandBuffer commandBuffer = stageCommands.commandBuffer;
+	m_vkResetCommandBuffer( commandBuffer, 0 );
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	m_vkBeginCommandBuffer( commandBuffer, &beginInfo );
+
+	// Move everything into transfer layouts, then back into the layouts Unity tracks them in
+	VkImageMemoryBarrier barriers[6];
+	UnityVulkanImage *pImages[6] = { &wideImages[0], &wideImages[1], &insetImages[0], &insetImages[1], &eyeImages[0], &eyeImages[1] };
+
+	for ( int i = 0; i < 6; ++i )
+	{
+		bool bDestination = i >= 4;
+
+		VkImageMemoryBarrier &barrier = barriers[i];
+		barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+		barrier.dstAccessMask = bDestination ? VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.oldLayout = pImages[i]->layout;
+		barrier.newLayout = bDestination ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = pImages[i]->image;
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+	}
+
+	m_vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 6, barriers );
+
+	for ( int eye = 0; eye < 2; ++eye )
+	{
+		const UnityVulkanImage &wideImage = wideImages[eye];
+		const UnityVulkanImage &insetImage = insetImages[eye];
+		const UnityVulkanImage &eyeImage = eyeImages[eye];
+		const QuadViewPlan &plan = plans[eye];
+
+		VkImageBlit blit = {};
+		blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		blit.srcOffsets[1] = { (int32_t )wideImage.extent.width, (int32_t )wideImage.extent.height, 1 };
+		blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		blit.dstOffsets[1] = { (int32_t )eyeImage.extent.width, (int32_t )eyeImage.extent.height, 1 };
+		m_vkCmdBlitImage( commandBuffer, wideImage.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, eyeImage.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR );
+
+		// Unity renders upside down (bottom row first), the plan is in view space
+		uint32_t nInsetWidth = std::min( plan.nInsetWidth, insetImage.extent.width );
+		uint32_t nInsetHeight = std::min( plan.nInsetHeight, insetImage.extent.height );
+		if ( plan.nInsetX + nInsetWidth > eyeImage.extent.width || plan.nInsetY + nInsetHeight > eyeImage.extent.height )
+			continue;
+
+		VkImageCopy copy = {};
+		copy.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		copy.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		copy.dstOffset = { (int32_t )plan.nInsetX, (int32_t )( eyeImage.extent.height - plan.nInsetY - nInsetHeight ), 0 };
+		copy.extent = { nInsetWidth, nInsetHeight, 1 };
+
+		// The blit and the copy both write the eye image
+		VkImageMemoryBarrier eyeBarrier = barriers[4 + eye];
+		eyeBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		eyeBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		eyeBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		m_vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &eyeBarrier );
+
+		m_vkCmdCopyImage( commandBuffer, insetImage.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, eyeImage.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy );
+	}
+
+	for ( int i = 0; i < 6; ++i )
+	{
+		VkImageMemoryBarrier &barrier = barriers[i];
+		barrier.srcAccessMask = barrier.dstAccessMask;
+		barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+		std::swap( barrier.oldLayout, barrier.newLayout );
+	}
+
+	m_vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 6, barriers );
+
+	m_vkEndCommandBuffer( commandBuffer );
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+
+	if ( m_vkQueueSubmit( m_queue, 1, &submitInfo, stageCommands.fence ) != VK_SUCCESS )
+	{
+		XR_TRACE( "[OpenVR] [Error] Unable to submit the quad view composite of stage %i\n", nStage );
+		return false;
+	}
+
+	stageCommands.bSubmitted = true;
+	return true;
+}
+
+
+bool QuadViewCompositor::AccessImage( void *pNativeTexture, UnityVulkanImage &image )
+{
+	if ( !pNativeTexture )
+		return false;
+
+	return m_pUnityVulkan->AccessTexture( pNativeTexture, UnityVulkanWholeImage, VK_IMAGE_LAYOUT_UNDEFINED,
+		0, 0, kUnityVulkanResourceAccess_ObserveOnly, &image );
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "QuadView.h"
+
+#include "ProviderInterface/IUnityGraphics.h"
+#include "ProviderInterface/IUnityGraphicsVulkan.h"
+
+/// Composites the wide and inset views of quad view rendering into the eye textures that get submitted.
+/// The wide view is upscaled over the whole eye texture (vkCmdBlitImage) and the inset copied on top of it
+/// (vkCmdCopyImage). The work is submitted to Unity's graphics queue from the submit callback, the same
+/// thread and queue the compositor uses during IVRCompositor::Submit.
+class QuadViewCompositor
+{
+public:
+	/// Load the Vulkan entry points and create the command pool, does nothing if that was already done for the same device
+	/// @param[in] IUnityGraphicsVulkan* pUnityVulkan - Unity's Vulkan interface
+	/// @return bool - false if compositing isn't possible
+	bool Initialize( IUnityGraphicsVulkan *pUnityVulkan );
+
+	/// Wait for outstanding work and destroy all Vulkan objects
+	void Shutdown();
+
+	/// If the compositor was initialized
+	bool IsSupported() const { return m_bSupported; }
+
+	/// Move an eye texture into the layout it's submitted in, once before it's first composited into
+	/// @param[in] void* pEyeTexture - Native eye texture
+	void Prepare( void *pEyeTexture );
+
+	/// Composite both eyes of a stage
+	/// @param[in] int nStage - The stage, each stage has its own command buffer
+	/// @param[in] void* const pWideTextures[2] - Native wide view textures
+	/// @param[in] void* const pInsetTextures[2] - Native inset textures
+	/// @param[in] void* const pEyeTextures[2] - Native eye textures that get submitted
+	/// @param[in] const QuadViewPlan plans[2] - Layout of the views of both eyes
+	/// @return bool - false if nothing was composited
+	bool Composite( int nStage, void *const pWideTextures[2], void *const pInsetTextures[2], void *const pEyeTextures[2], const QuadViewPlan plans[2] );
+
+private:
+	struct StageCommands
+	{
+		VkCommandBuffer commandBuffer;
+		VkFence fence;
+		bool bSubmitted;
+	};
+
+	/// Get the Vulkan image and the layout Unity tracks it in
+	bool AccessImage( void *pNativeTexture, UnityVulkanImage &image );
+
+	IUnityGraphicsVulkan *m_pUnityVulkan = nullptr;
+	VkDevice m_device = VK_NULL_HANDLE;
+	VkQueue m_queue = VK_NULL_HANDLE;
+	VkCommandPool m_commandPool = VK_NULL_HANDLE;
+	bool m_bSupported = false;
+
+	std::vector< StageCommands > m_vStageCommands;
+
+	PFN_vkCreateCommandPool m_vkCreateCommandPool = nullptr;
+	PFN_vkDestroyCommandPool m_vkDestroyCommandPool = nullptr;
+	PFN_vkAllocateCommandBuffers m_vkAllocateCommandBuffers = nullptr;
+	PFN_vkBeginCommandBuffer m_vkBeginCommandBuffer = nullptr;
+	PFN_vkEndCommandBuffer m_vkEndCommandBuffer = nullptr;
+	PFN_vkResetCommandBuffer m_vkResetCommandBuffer = nullptr;
+	PFN_vkCreateFence m_vkCreateFence = nullptr;
+	PFN_vkDestroyFence m_vkDestroyFence = nullptr;
+	PFN_vkWaitForFences m_vkWaitForFences = nullptr;
+	PFN_vkResetFences m_vkResetFences = nullptr;
+	PFN_vkQueueSubmit m_vkQueueSubmit = nullptr;
+	PFN_vkCmdPipelineBarrier m_vkCmdPipelineBarrier = nullptr;
+	PFN_vkCmdBlitImage m_vkCmdBlitImage = nullptr;
+	PFN_vkCmdCopyImage m_vkCmdCopyImage = nullptr;
+};
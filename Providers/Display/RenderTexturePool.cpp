@@ -0,0 +1,180 @@
+#include "RenderTexturePool.h"
+#include "CommonTypes.h"
+
+
+void RenderTexturePool::Initialize( IUnityXRDisplayInterface *pXRDisplay, IUnityXRDisplayShadingRateExt *pXRDisplayShadingRate, UnitySubsystemHandle handle )
+{
+	m_pXRDisplay = pXRDisplay;
+	m_pXRDisplayShadingRate = pXRDisplayShadingRate;
+	m_handle = handle;
+}
+
+
+UnitySubsystemErrorCode RenderTexturePool::Acquire( const UnityXRRenderTextureDesc &desc, UnityXRRenderTextureId *pTextureId, void *pShadingRateTexture )
+{
+	// Reuse the most recently released matching texture
+	PooledTexture *pBest = nullptr;
+	for ( PooledTexture &pooledTexture : m_vTextures )
+	{
+		if ( !pooledTexture.bInUse && pooledTexture.pShadingRateTexture == pShadingRateTexture && IsSameBucket( pooledTexture.desc, desc ) && ( !pBest || pooledTexture.nLastUsed > pBest->nLastUsed ) )
+		{
+			pBest = &pooledTexture;
+		}
+	}
+
+	if ( pBest )
+	{
+		pBest->bInUse = true;
+		pBest->nLastUsed = ++m_nUseCounter;
+		*pTextureId = pBest->textureId;
+		m_nNumHits++;
+		return kUnitySubsystemErrorCodeSuccess;
+	}
+
+	UnityXRRenderTextureId textureId;
+	UnitySubsystemErrorCode res;
+	if ( pShadingRateTexture )
+	{
+		if ( !m_pXRDisplayShadingRate )
+			return kUnitySubsystemErrorCodeNotSupported;
+
+		UnityXRTextureData shadingRateTexture;
+		shadingRateTexture.nativePtr = pShadingRateTexture;
+		res = m_pXRDisplayShadingRate->CreateTextureWithShadingRate( m_handle, &desc, &shadingRateTexture, &textureId );
+	}
+	else
+	{
+		res = m_pXRDisplay->CreateTexture( m_handle, &desc, &textureId );
+	}
+
+	if ( res != kUnitySubsystemErrorCodeSuccess )
+		return res;
+
+	PooledTexture pooledTexture;
+	pooledTexture.textureId = textureId;
+	pooledTexture.desc = desc;
+	pooledTexture.pShadingRateTexture = pShadingRateTexture;
+	pooledTexture.nSizeBytes = GetTextureSizeBytes( desc );
+	pooledTexture.nLastUsed = ++m_nUseCounter;
+	pooledTexture.bInUse = true;
+	m_vTextures.push_back( pooledTexture );
+	m_nSizeBytes += pooledTexture.nSizeBytes;
+
+	// Make room for the new texture by dropping idle ones
+	Evict();
+
+	*pTextureId = textureId;
+	return kUnitySubsystemErrorCodeSuccess;
+}
+
+
+void RenderTexturePool::Release( UnityXRRenderTextureId textureId )
+{
+	for ( PooledTexture &pooledTexture : m_vTextures )
+	{
+		if ( pooledTexture.textureId == textureId )
+		{
+			pooledTexture.bInUse = false;
+			break;
+		}
+	}
+
+	Evict();
+}
+
+
+void RenderTexturePool::SetBudget( uint64_t nBudgetBytes )
+{
+	if ( nBudgetBytes == m_nBudgetBytes )
+		return;
+
+	m_nBudgetBytes = nBudgetBytes;
+	Evict();
+}
+
+
+void RenderTexturePool::Clear()
+{
+	for ( const PooledTexture &pooledTexture : m_vTextures )
+	{
+		m_pXRDisplay->DestroyTexture( m_handle, pooledTexture.textureId );
+	}
+
+	m_vTextures.clear();
+	m_nSizeBytes = 0;
+}
+
+
+bool RenderTexturePool::IsSameBucket( const UnityXRRenderTextureDesc &desc1, const UnityXRRenderTextureDesc &desc2 )
+{
+	return desc1.width == desc2.width
+		&& desc1.height == desc2.height
+		&& desc1.textureArrayLength == desc2.textureArrayLength
+		&& desc1.colorFormat == desc2.colorFormat
+		&& desc1.depthFormat == desc2.depthFormat
+		&& desc1.flags == desc2.flags;
+}
+
+
+uint64_t RenderTexturePool::GetTextureSizeBytes( const UnityXRRenderTextureDesc &desc )
+{
+	uint64_t nBytesPerPixel = 0;
+
+	switch ( desc.colorFormat )
+	{
+	case kUnityXRRenderTextureFormatRGBA32:
+	case kUnityXRRenderTextureFormatBGRA32:
+		nBytesPerPixel += 4;
+		break;
+
+	case kUnityXRRenderTextureFormatRGB565:
+		nBytesPerPixel += 2;
+		break;
+
+	default:
+		break;
+	}
+
+	switch ( desc.depthFormat )
+	{
+	case kUnityXRDepthTextureFormat24bitOrGreater:
+		nBytesPerPixel += 4;
+		break;
+
+	case kUnityXRDepthTextureFormat16bit:
+		nBytesPerPixel += 2;
+		break;
+
+	default:
+		break;
+	}
+
+	uint64_t nSlices = desc.textureArrayLength > 0 ? desc.textureArrayLength : 1;
+	return (uint64_t )desc.width * (uint64_t )desc.height * nSlices * nBytesPerPixel;
+}
+
+
+void RenderTexturePool::Evict()
+{
+	while ( m_nSizeBytes > m_nBudgetBytes )
+	{
+		// Find the least recently used idle texture, textures in use can't be evicted
+		size_t nOldest = m_vTextures.size();
+		for ( size_t i = 0; i < m_vTextures.size(); ++i )
+		{
+			if ( !m_vTextures[i].bInUse && ( nOldest == m_vTextures.size() || m_vTextures[i].nLastUsed < m_vTextures[nOldest].nLastUsed ) )
+			{
+				nOldest = i;
+			}
+		}
+
+		if ( nOldest == m_vTextures.size() )
+			break;
+
+		XR_TRACE( "[OpenVR] Evicting pooled eye texture %ux%u\n", m_vTextures[nOldest].desc.width, m_vTextures[nOldest].desc.height );
+
+		m_pXRDisplay->DestroyTexture( m_handle, m_vTextures[nOldest].textureId );
+		m_nSizeBytes -= m_vTextures[nOldest].nSizeBytes;
+		m_vTextures.erase( m_vTextures.begin() + nOldest );
+	}
+}
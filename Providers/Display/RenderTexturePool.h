@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "UserProjectSettings.h"
+#include "ProviderInterface/IUnityXRDisplay.h"
+#include "ProviderInterface/IUnityXRDisplayShadingRateExt.h"
+
+/// Pool of Unity render textures bucketed by size and format.
+/// Released textures are kept around so switching back to a recently used resolution doesn't have to go through
+/// IUnityXRDisplayInterface::CreateTexture again. Idle textures are destroyed least recently used first whenever
+/// the pool goes over its VRAM budget.
+class RenderTexturePool
+{
+public:
+	/// Set the display interfaces and subsystem the textures get created for
+	/// @param[in] IUnityXRDisplayInterface* pXRDisplay - The display interface
+	/// @param[in] IUnityXRDisplayShadingRateExt* pXRDisplayShadingRate - The shading rate extension, nullptr if not available
+	/// @param[in] UnitySubsystemHandle handle - The display subsystem
+	void Initialize( IUnityXRDisplayInterface *pXRDisplay, IUnityXRDisplayShadingRateExt *pXRDisplayShadingRate, UnitySubsystemHandle handle );
+
+	/// Get an idle texture matching the description, or create a new one
+	/// @param[in] const UnityXRRenderTextureDesc& desc - Description of the texture (native pointers are ignored when matching)
+	/// @param[out] UnityXRRenderTextureId* pTextureId - The pooled texture
+	/// @param[in] void* pShadingRateTexture - Native shading rate image to create the texture with, nullptr for none
+	/// @return UnitySubsystemErrorCode - The result of CreateTexture if a new texture had to be created
+	UnitySubsystemErrorCode Acquire( const UnityXRRenderTextureDesc &desc, UnityXRRenderTextureId *pTextureId, void *pShadingRateTexture = nullptr );
+
+	/// Return a texture to the pool, it stays allocated until it gets evicted
+	/// @param[in] UnityXRRenderTextureId textureId - A texture previously returned by Acquire
+	void Release( UnityXRRenderTextureId textureId );
+
+	/// Set the VRAM budget and evict idle textures until the pool fits in it
+	/// @param[in] uint64_t nBudgetBytes - Budget in bytes
+	void SetBudget( uint64_t nBudgetBytes );
+
+	/// Destroy every texture in the pool, including the ones still in use
+	void Clear();
+
+	/// Number of Acquire calls that were served from the pool
+	uint32_t GetNumHits() const { return m_nNumHits; }
+
+	/// Estimated VRAM taken by all textures in the pool
+	uint64_t GetSizeBytes() const { return m_nSizeBytes; }
+
+private:
+	struct PooledTexture
+	{
+		UnityXRRenderTextureId textureId;
+		UnityXRRenderTextureDesc desc;
+		void *pShadingRateTexture;
+		uint64_t nSizeBytes;
+		uint64_t nLastUsed;
+		bool bInUse;
+	};
+
+	/// If two descriptions would create interchangeable textures
+	static bool IsSameBucket( const UnityXRRenderTextureDesc &desc1, const UnityXRRenderTextureDesc &desc2 );
+
+	/// Estimate the VRAM used by a texture with the given description
+	static uint64_t GetTextureSizeBytes( const UnityXRRenderTextureDesc &desc );
+
+	/// Destroy least recently used idle textures until the pool fits in the budget
+	void Evict();
+
+	IUnityXRDisplayInterface *m_pXRDisplay = nullptr;
+	IUnityXRDisplayShadingRateExt *m_pXRDisplayShadingRate = nullptr;
+	UnitySubsystemHandle m_handle = 0;
+
+	std::vector< PooledTexture > m_vTextures;
+	uint64_t m_nSizeBytes = 0;
+	uint64_t m_nBudgetBytes = (uint64_t )k_unDefaultEyeTexturePoolBudgetMB * 1024 * 1024;
+	uint64_t m_nUseCounter = 0;
+	uint32_t m_nNumHits = 0;
+};
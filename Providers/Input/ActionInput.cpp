@@ -0,0 +1,98 @@
+#include <cstring>
+#include <string>
+
+#include "ActionInput.h"
+#include "CommonTypes.h"
+
+
+bool ActionInput::Initialize( const char *pchActionSetPath, const char *const *ppchActionNames, const EActionType *pActionTypes, uint32_t unNumActions )
+{
+	m_bInitialized = false;
+
+	if ( vr::VRInput() == nullptr || unNumActions > k_unMaxActions )
+		return false;
+
+	vr::EVRInputError eError = vr::VRInput()->GetActionSetHandle( pchActionSetPath, &m_ulActionSet );
+	if ( eError != vr::VRInputError_None || m_ulActionSet == vr::k_ulInvalidActionSetHandle )
+	{
+		XR_TRACE( "[OpenVR] [ERROR] GetActionSetHandle( %s ) failed: %d\n", pchActionSetPath, eError );
+		return false;
+	}
+
+	static const char *const k_pchHandPaths[Hand_Count] = { "/user/hand/left", "/user/hand/right" };
+	for ( int nHand = 0; nHand < Hand_Count; ++nHand )
+	{
+		if ( vr::VRInput()->GetInputSourceHandle( k_pchHandPaths[nHand], &m_ulHandSources[nHand] ) != vr::VRInputError_None )
+			return false;
+	}
+
+	std::string actionPath;
+	for ( uint32_t unAction = 0; unAction < unNumActions; ++unAction )
+	{
+		actionPath = std::string( pchActionSetPath ) + "/in/" + ppchActionNames[unAction];
+		eError = vr::VRInput()->GetActionHandle( actionPath.c_str(), &m_ulActions[unAction] );
+		if ( eError != vr::VRInputError_None )
+		{
+			XR_TRACE( "[OpenVR] [ERROR] GetActionHandle( %s ) failed: %d\n", actionPath.c_str(), eError );
+			m_ulActions[unAction] = vr::k_ulInvalidActionHandle;
+		}
+		m_actionTypes[unAction] = pActionTypes[unAction];
+	}
+
+	m_unNumActions = unNumActions;
+	memset( m_values, 0, sizeof( m_values ) );
+	m_bInitialized = true;
+
+	XR_TRACE( "[OpenVR] Native action input initialized with %u actions from %s\n", unNumActions, pchActionSetPath );
+	return true;
+}
+
+
+void ActionInput::Update()
+{
+	if ( !m_bInitialized )
+		return;
+
+	// One set, active for every device
+	vr::VRActiveActionSet_t activeSet = {};
+	activeSet.ulActionSet = m_ulActionSet;
+	activeSet.ulRestrictedToDevice = vr::k_ulInvalidInputValueHandle;
+
+	if ( vr::VRInput()->UpdateActionState( &activeSet, sizeof( activeSet ), 1 ) != vr::VRInputError_None )
+	{
+		memset( m_values, 0, sizeof( m_values ) );
+		return;
+	}
+
+	for ( int nHand = 0; nHand < Hand_Count; ++nHand )
+	{
+		for ( uint32_t unAction = 0; unAction < m_unNumActions; ++unAction )
+		{
+			ActionValue &value = m_values[nHand][unAction];
+			value = {};
+
+			if ( m_ulActions[unAction] == vr::k_ulInvalidActionHandle )
+				continue;
+
+			if ( m_actionTypes[unAction] == ActionType_Digital )
+			{
+				vr::InputDigitalActionData_t digitalData;
+				if ( vr::VRInput()->GetDigitalActionData( m_ulActions[unAction], &digitalData, sizeof( digitalData ), m_ulHandSources[nHand] ) == vr::VRInputError_None && digitalData.bActive )
+				{
+					value.bActive = true;
+					value.x = digitalData.bState ? 1.0f : 0.0f;
+				}
+			}
+			else
+			{
+				vr::InputAnalogActionData_t analogData;
+				if ( vr::VRInput()->GetAnalogActionData( m_ulActions[unAction], &analogData, sizeof( analogData ), m_ulHandSources[nHand] ) == vr::VRInputError_None && analogData.bActive )
+				{
+					value.bActive = true;
+					value.x = analogData.x;
+					value.y = analogData.y;
+				}
+			}
+		}
+	}
+}
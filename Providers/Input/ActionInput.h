@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "OpenVR/openvr.h"
+
+/// Controller state read natively through IVRInput. Actions live in one action set of the application's action manifest,
+/// which is activated for both hands with a single UpdateActionState call per frame. The state of every action is then
+/// read once per hand and kept until the next update, so device state updates don't call into the runtime.
+/// Main thread only.
+class ActionInput
+{
+public:
+	enum EHand
+	{
+		Hand_Left,
+		Hand_Right,
+		Hand_Count
+	};
+
+	enum EActionType
+	{
+		ActionType_Digital,
+		ActionType_Analog
+	};
+
+	/// Most actions Initialize accepts
+	static const uint32_t k_unMaxActions = 32;
+
+	/// Value of an action for one hand
+	struct ActionValue
+	{
+		/// If the action is bound for the hand, the values are 0 otherwise
+		bool bActive;
+
+		/// Digital actions are 0 or 1 in x, analog actions have up to two axes
+		float x, y;
+	};
+
+	/// Look up the handles of an action set and its actions
+	/// @param[in] const char* pchActionSetPath - Path of the action set in the action manifest, e.g. /actions/unityxr
+	/// @param[in] const char* const* ppchActionNames - Name of every action, the action path is <action set>/in/<name>
+	/// @param[in] const EActionType* pActionTypes - Type of every action
+	/// @param[in] uint32_t unNumActions - Number of actions, at most k_unMaxActions
+	/// @return bool - false if IVRInput isn't available or doesn't know the action set
+	bool Initialize( const char *pchActionSetPath, const char *const *ppchActionNames, const EActionType *pActionTypes, uint32_t unNumActions );
+
+	bool IsInitialized() const { return m_bInitialized; }
+
+	/// Update the action state and read every action for both hands, call once per frame
+	void Update();
+
+	/// Value of an action as of the last Update
+	/// @param[in] EHand eHand - The hand
+	/// @param[in] uint32_t unAction - Index of the action as passed to Initialize
+	/// @return const ActionValue& - The value, inactive if the last update failed
+	const ActionValue &GetValue( EHand eHand, uint32_t unAction ) const { return m_values[eHand][unAction]; }
+
+private:
+	bool m_bInitialized = false;
+
+	vr::VRActionSetHandle_t m_ulActionSet = vr::k_ulInvalidActionSetHandle;
+	vr::VRInputValueHandle_t m_ulHandSources[Hand_Count] = {};
+
+	uint32_t m_unNumActions = 0;
+	vr::VRActionHandle_t m_ulActions[k_unMaxActions] = {};
+	EActionType m_actionTypes[k_unMaxActions] = {};
+
+	ActionValue m_values[Hand_Count][k_unMaxActions] = {};
+};
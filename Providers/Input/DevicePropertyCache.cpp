@@ -0,0 +1,42 @@
+#include <cstring>
+
+#include "DevicePropertyCache.h"
+#include "OpenVRSystem.h"
+
+
+static bool FetchStringProperty( vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, char ( &value )[kUnityXRStringSize] )
+{
+	uint32_t unSize = OpenVRSystem::Get().GetSystem()->GetStringTrackedDeviceProperty( unDeviceIndex, prop, value, sizeof( value ) );
+	if ( unSize == 0 )
+	{
+		value[0] = '\0';
+		return false;
+	}
+	return true;
+}
+
+
+const DeviceProperties *DevicePropertyCache::Get( vr::TrackedDeviceIndex_t unDeviceIndex )
+{
+	if ( unDeviceIndex >= vr::k_unMaxTrackedDeviceCount )
+		return nullptr;
+
+	DeviceProperties &properties = m_properties[unDeviceIndex];
+	uint64_t nBit = 1ull << unDeviceIndex;
+	if ( m_nValidMask & nBit )
+		return &properties;
+
+	properties.bHasModelNumber = FetchStringProperty( unDeviceIndex, vr::Prop_ModelNumber_String, properties.modelNumber );
+	properties.bHasSerialNumber = FetchStringProperty( unDeviceIndex, vr::Prop_SerialNumber_String, properties.serialNumber );
+	properties.bHasManufacturerName = FetchStringProperty( unDeviceIndex, vr::Prop_ManufacturerName_String, properties.manufacturerName );
+	properties.bHasControllerType = FetchStringProperty( unDeviceIndex, vr::Prop_ControllerType_String, properties.controllerType );
+
+	properties.bIsLogitechVirtual = strcmp( properties.serialNumber, "LOGITECH_STYLUS_VIRTUAL" ) == 0;
+	properties.bIsLogitech = strcmp( properties.manufacturerName, "Logitech" ) == 0;
+
+	// Devices that are still starting up may not have all properties yet, ask again next time
+	if ( properties.bHasModelNumber && properties.bHasSerialNumber && properties.bHasManufacturerName && properties.bHasControllerType )
+		m_nValidMask |= nBit;
+
+	return &properties;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "OpenVR/openvr.h"
+#include "ProviderInterface/UnityXRTypes.h"
+
+/// String properties of a tracked device, as needed to describe it to Unity
+struct DeviceProperties
+{
+	char modelNumber[kUnityXRStringSize];
+	char serialNumber[kUnityXRStringSize];
+	char manufacturerName[kUnityXRStringSize];
+	char controllerType[kUnityXRStringSize];
+
+	/// If the runtime returned the property, the strings are empty otherwise
+	bool bHasModelNumber;
+	bool bHasSerialNumber;
+	bool bHasManufacturerName;
+	bool bHasControllerType;
+
+	/// Logitech reports two devices for the stylus, the virtual one (by serial number) is the one to use
+	bool bIsLogitechVirtual;
+	bool bIsLogitech;
+};
+
+/// Per OpenVR index cache of the device properties FillDeviceDefinition needs. All properties of a device are fetched
+/// together the first time any of them is asked for and kept across reconnects, OpenVR doesn't hand an index to
+/// another device during a session. Entries are dropped when the native event pump sees VREvent_PropertyChanged.
+/// The string comparisons the definition depends on are resolved once at fetch time. Main thread only.
+class DevicePropertyCache
+{
+public:
+	/// Properties of a device, fetched from the runtime if they aren't cached
+	/// @param[in] vr::TrackedDeviceIndex_t unDeviceIndex - OpenVR device index
+	/// @return const DeviceProperties* - The properties, nullptr for an invalid index
+	const DeviceProperties *Get( vr::TrackedDeviceIndex_t unDeviceIndex );
+
+	/// Drop cached properties, e.g. after VREvent_PropertyChanged
+	/// @param[in] uint64_t nDeviceMask - Bit per OpenVR index to drop
+	void Invalidate( uint64_t nDeviceMask ) { m_nValidMask &= ~nDeviceMask; }
+
+private:
+	DeviceProperties m_properties[vr::k_unMaxTrackedDeviceCount];
+
+	/// Bit per OpenVR index whose entry in m_properties is fetched
+	uint64_t m_nValidMask = 0;
+};
@@ -0,0 +1,117 @@
+#include <string>
+
+#include "HandSkeleton.h"
+#include "CommonTypes.h"
+
+
+static const char *const k_pchBoneNames[HandSkeleton::k_unNumBones] =
+{
+	"Root", "Wrist",
+	"Thumb0", "Thumb1", "Thumb2", "Thumb3",
+	"IndexFinger0", "IndexFinger1", "IndexFinger2", "IndexFinger3", "IndexFinger4",
+	"MiddleFinger0", "MiddleFinger1", "MiddleFinger2", "MiddleFinger3", "MiddleFinger4",
+	"RingFinger0", "RingFinger1", "RingFinger2", "RingFinger3", "RingFinger4",
+	"PinkyFinger0", "PinkyFinger1", "PinkyFinger2", "PinkyFinger3", "PinkyFinger4",
+	"Aux_Thumb", "Aux_IndexFinger", "Aux_MiddleFinger", "Aux_RingFinger", "Aux_PinkyFinger",
+};
+
+
+bool HandSkeleton::Initialize( const char *pchActionSetPath )
+{
+	m_bInitialized = false;
+	if ( vr::VRInput() == nullptr )
+		return false;
+
+	static const char *const k_pchActionNames[ActionInput::Hand_Count] = { "SkeletonLeftHand", "SkeletonRightHand" };
+	for ( int nHand = 0; nHand < ActionInput::Hand_Count; ++nHand )
+	{
+		std::string actionPath = std::string( pchActionSetPath ) + "/in/" + k_pchActionNames[nHand];
+		if ( vr::VRInput()->GetActionHandle( actionPath.c_str(), &m_ulSkeletonActions[nHand] ) != vr::VRInputError_None )
+		{
+			XR_TRACE( "[OpenVR] [ERROR] GetActionHandle( %s ) failed\n", actionPath.c_str() );
+			return false;
+		}
+		m_bHasBones[nHand] = false;
+	}
+
+	m_bInitialized = true;
+	return true;
+}
+
+
+void HandSkeleton::Update()
+{
+	if ( !m_bInitialized )
+		return;
+
+	for ( int nHand = 0; nHand < ActionInput::Hand_Count; ++nHand )
+	{
+		m_bHasBones[nHand] = false;
+
+		vr::InputSkeletalActionData_t actionData;
+		if ( vr::VRInput()->GetSkeletalActionData( m_ulSkeletonActions[nHand], &actionData, sizeof( actionData ) ) != vr::VRInputError_None || !actionData.bActive )
+			continue;
+
+		// Model space, relative to the controller's pose
+		m_bHasBones[nHand] = vr::VRInput()->GetSkeletalBoneData( m_ulSkeletonActions[nHand], vr::VRSkeletalTransformSpace_Model,
+			vr::VRSkeletalMotionRange_WithController, m_bones[nHand], k_unNumBones ) == vr::VRInputError_None;
+	}
+}
+
+
+bool HandSkeleton::GetUnityBones( ActionInput::EHand eHand, const UnityXRVector3 &devicePosition, const UnityXRVector4 &deviceRotation,
+	UnityXRVector3 positions[k_unNumUnityBones], UnityXRVector4 rotations[k_unNumUnityBones] ) const
+{
+	if ( !m_bHasBones[eHand] )
+		return false;
+
+	// Rotation matrix of the controller, so every bone position takes 9 multiplies instead of a quaternion sandwich
+	const float qx = deviceRotation.x, qy = deviceRotation.y, qz = deviceRotation.z, qw = deviceRotation.w;
+	const float r00 = 1.0f - 2.0f * ( qy * qy + qz * qz ), r01 = 2.0f * ( qx * qy - qw * qz ), r02 = 2.0f * ( qx * qz + qw * qy );
+	const float r10 = 2.0f * ( qx * qy + qw * qz ), r11 = 1.0f - 2.0f * ( qx * qx + qz * qz ), r12 = 2.0f * ( qy * qz - qw * qx );
+	const float r20 = 2.0f * ( qx * qz - qw * qy ), r21 = 2.0f * ( qy * qz + qw * qx ), r22 = 1.0f - 2.0f * ( qx * qx + qy * qy );
+
+	// Straight loop over all bones with no branches, so the compiler can vectorize it
+	const vr::VRBoneTransform_t *pBones = &m_bones[eHand][k_unFirstUnityBone];
+	for ( uint32_t unBone = 0; unBone < k_unNumUnityBones; ++unBone )
+	{
+		// OpenVR to Unity is a mirror along z, same as OpenVRMatrix3x4ToUnity: positions flip z, rotations flip x and y
+		const float px = pBones[unBone].position.v[0];
+		const float py = pBones[unBone].position.v[1];
+		const float pz = -pBones[unBone].position.v[2];
+		const float bx = -pBones[unBone].orientation.x;
+		const float by = -pBones[unBone].orientation.y;
+		const float bz = pBones[unBone].orientation.z;
+		const float bw = pBones[unBone].orientation.w;
+
+		positions[unBone].x = devicePosition.x + r00 * px + r01 * py + r02 * pz;
+		positions[unBone].y = devicePosition.y + r10 * px + r11 * py + r12 * pz;
+		positions[unBone].z = devicePosition.z + r20 * px + r21 * py + r22 * pz;
+
+		rotations[unBone].x = qw * bx + qx * bw + qy * bz - qz * by;
+		rotations[unBone].y = qw * by - qx * bz + qy * bw + qz * bx;
+		rotations[unBone].z = qw * bz + qx * by - qy * bx + qz * bw;
+		rotations[unBone].w = qw * bw - qx * bx - qy * by - qz * bz;
+	}
+
+	return true;
+}
+
+
+uint32_t HandSkeleton::GetParentBone( uint32_t unBone )
+{
+	// Root <- wrist <- first bone of every finger <- the rest of the finger, the aux bones hang off the root
+	if ( unBone == 0 || unBone >= k_unNumBones )
+		return k_unNumBones;
+	if ( unBone == 1 || unBone >= 26 )
+		return 0;
+	if ( unBone == 2 || unBone == 6 || unBone == 11 || unBone == 16 || unBone == 21 )
+		return 1;
+	return unBone - 1;
+}
+
+
+const char *HandSkeleton::GetBoneName( uint32_t unBone )
+{
+	return unBone < k_unNumBones ? k_pchBoneNames[unBone] : "";
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "OpenVR/openvr.h"
+#include "ProviderInterface/UnityXRTypes.h"
+
+#include "ActionInput.h"
+
+/// Hand skeletons read natively through IVRInput skeletal actions. Both hands' bones are fetched once per frame into
+/// preallocated arrays, device state updates transform them into Unity tracking space with the controller's pose.
+/// Main thread only.
+class HandSkeleton
+{
+public:
+	/// Bones of the OpenVR hand skeleton: root, wrist, 4 thumb, 5 per finger and 5 aux bones
+	static const uint32_t k_unNumBones = 31;
+
+	/// Bones reported to Unity, the wrist and the finger bones (the root and the aux bones are left out)
+	static const uint32_t k_unFirstUnityBone = 1;
+	static const uint32_t k_unNumUnityBones = 25;
+
+	/// Look up the skeletal actions <action set>/in/SkeletonLeftHand and <action set>/in/SkeletonRightHand
+	/// @param[in] const char* pchActionSetPath - Path of the action set in the action manifest
+	/// @return bool - false if IVRInput isn't available
+	bool Initialize( const char *pchActionSetPath );
+
+	bool IsInitialized() const { return m_bInitialized; }
+
+	/// Fetch the bones of both hands, call once per frame after UpdateActionState
+	void Update();
+
+	/// Bones of a hand in Unity tracking space, as of the last Update
+	/// @param[in] ActionInput::EHand eHand - The hand
+	/// @param[in] const UnityXRVector3& devicePosition - Position of the controller in Unity tracking space
+	/// @param[in] const UnityXRVector4& deviceRotation - Rotation of the controller in Unity tracking space
+	/// @param[out] UnityXRVector3 positions[k_unNumUnityBones] - Bone positions, starting with the wrist
+	/// @param[out] UnityXRVector4 rotations[k_unNumUnityBones] - Bone rotations, starting with the wrist
+	/// @return bool - false if the hand has no skeleton this frame
+	bool GetUnityBones( ActionInput::EHand eHand, const UnityXRVector3 &devicePosition, const UnityXRVector4 &deviceRotation,
+		UnityXRVector3 positions[k_unNumUnityBones], UnityXRVector4 rotations[k_unNumUnityBones] ) const;
+
+	/// Parent of every bone, as an index into the same bone array. k_unNumBones for the root.
+	static uint32_t GetParentBone( uint32_t unBone );
+
+	/// Name of every bone, as used for its input feature
+	static const char *GetBoneName( uint32_t unBone );
+
+private:
+	bool m_bInitialized = false;
+	vr::VRActionHandle_t m_ulSkeletonActions[ActionInput::Hand_Count] = {};
+
+	bool m_bHasBones[ActionInput::Hand_Count] = {};
+	vr::VRBoneTransform_t m_bones[ActionInput::Hand_Count][k_unNumBones];
+};
@@ -1,10 +1,13 @@
 #include <cassert>
 #include <array>
 #include <algorithm>
-#include <sstream>
-#include <chrono>
+#include <cstdio>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 #include "Input.h"
+#include "TimeDomain.h"
 
 static OpenVRProviderContext *s_pProviderContext;
 static IUnityXRInputInterface *s_Input = nullptr;
@@ -12,6 +15,37 @@ int OpenVRInputProvider::hmdFeatureIndices[static_cast< int >( HMDFeature::Total
 int OpenVRInputProvider::controllerFeatureIndices[static_cast< int >( ControllerFeature::Total )] = {};
 int OpenVRInputProvider::trackerFeatureIndices[static_cast< int >( TrackerFeature::Total )] = {};
 
+const OpenVRInputProvider::ControllerFeatureAction OpenVRInputProvider::k_controllerFeatureActions[] =
+{
+	{ ControllerFeature::Primary2DAxis, "Primary2DAxis", kUnityXRInputFeatureTypeAxis2D, kUnityXRInputFeatureUsagePrimary2DAxis },
+	{ ControllerFeature::Primary2DAxisClick, "Primary2DAxisClick", kUnityXRInputFeatureTypeBinary, kUnityXRInputFeatureUsagePrimary2DAxisClick },
+	{ ControllerFeature::Primary2DAxisTouch, "Primary2DAxisTouch", kUnityXRInputFeatureTypeBinary, kUnityXRInputFeatureUsagePrimary2DAxisTouch },
+	{ ControllerFeature::Secondary2DAxis, "Secondary2DAxis", kUnityXRInputFeatureTypeAxis2D, kUnityXRInputFeatureUsageSecondary2DAxis },
+	{ ControllerFeature::Secondary2DAxisTouch, "Secondary2DAxisTouch", kUnityXRInputFeatureTypeBinary, kUnityXRInputFeatureUsageSecondary2DAxisTouch },
+	{ ControllerFeature::Secondary2DAxisClick, "Secondary2DAxisClick", kUnityXRInputFeatureTypeBinary, kUnityXRInputFeatureUsageSecondary2DAxisClick },
+	{ ControllerFeature::Trigger, "Trigger", kUnityXRInputFeatureTypeAxis1D, kUnityXRInputFeatureUsageTrigger },
+	{ ControllerFeature::TriggerButton, "TriggerButton", kUnityXRInputFeatureTypeBinary, kUnityXRInputFeatureUsageTriggerButton },
+	{ ControllerFeature::TriggerTouch, "TriggerTouch", kUnityXRInputFeatureTypeBinary, nullptr },
+	{ ControllerFeature::Grip, "Grip", kUnityXRInputFeatureTypeAxis1D, kUnityXRInputFeatureUsageGrip },
+	{ ControllerFeature::GripButton, "GripButton", kUnityXRInputFeatureTypeBinary, kUnityXRInputFeatureUsageGripButton },
+	{ ControllerFeature::GripTouch, "GripTouch", kUnityXRInputFeatureTypeBinary, nullptr },
+	{ ControllerFeature::GripGrab, "GripGrab", kUnityXRInputFeatureTypeBinary, nullptr },
+	{ ControllerFeature::GripCapacitive, "GripCapacitive", kUnityXRInputFeatureTypeAxis1D, nullptr },
+	{ ControllerFeature::Primary, "Primary", kUnityXRInputFeatureTypeAxis1D, nullptr },
+	{ ControllerFeature::PrimaryButton, "PrimaryButton", kUnityXRInputFeatureTypeBinary, kUnityXRInputFeatureUsagePrimaryButton },
+	{ ControllerFeature::PrimaryTouch, "PrimaryTouch", kUnityXRInputFeatureTypeBinary, kUnityXRInputFeatureUsagePrimaryTouch },
+	{ ControllerFeature::Secondary, "Secondary", kUnityXRInputFeatureTypeAxis1D, nullptr },
+	{ ControllerFeature::SecondaryButton, "SecondaryButton", kUnityXRInputFeatureTypeBinary, kUnityXRInputFeatureUsageSecondaryButton },
+	{ ControllerFeature::SecondaryTouch, "SecondaryTouch", kUnityXRInputFeatureTypeBinary, kUnityXRInputFeatureUsageSecondaryTouch },
+	{ ControllerFeature::MenuButton, "MenuButton", kUnityXRInputFeatureTypeBinary, kUnityXRInputFeatureUsageMenuButton },
+	{ ControllerFeature::MenuTouch, "MenuTouch", kUnityXRInputFeatureTypeBinary, nullptr },
+	{ ControllerFeature::BumperButton, "BumperButton", kUnityXRInputFeatureTypeBinary, nullptr },
+	{ ControllerFeature::Tip, "Tip", kUnityXRInputFeatureTypeAxis1D, nullptr },
+	{ ControllerFeature::TipButton, "TipButton", kUnityXRInputFeatureTypeBinary, nullptr },
+	{ ControllerFeature::TipTouch, "TipTouch", kUnityXRInputFeatureTypeBinary, nullptr },
+};
+const uint32_t OpenVRInputProvider::k_unNumControllerFeatureActions = sizeof( k_controllerFeatureActions ) / sizeof( k_controllerFeatureActions[0] );
+
 // Valve's IVRSystem::TriggerHapticPulse method will not accept a value
 // greater than this, as determined by trial and error.
 const static unsigned short kMaxHapticPulseDurationInMicroseconds = 3999;
@@ -171,118 +205,90 @@ UnitySubsystemErrorCode UNITY_INTERFACE_API OpenVRInputProvider::Tick( UnitySubs
 {
 	OpenVRSystem::Get().Update();
 
+	LatchPoses( updateType );
+
 	if ( updateType == kUnityXRInputUpdateTypeBeforeRender )
 		return kUnitySubsystemErrorCodeSuccess;
 
+	m_propertyCache.Invalidate( OpenVRSystem::Get().ConsumePropertyChanges() );
+	UpdateConnectedDevices();
+	UpdateActionInput();
+
 	// Connect/Disconnect devices marked for change
-	for ( auto deviceIter = m_TrackedDevices.begin(); deviceIter != m_TrackedDevices.end(); )
+	for ( size_t nSlot = 0; nSlot < m_TrackedDevices.size(); )
 	{
-		if ( deviceIter->deviceStatus == EDeviceStatus::None &&
-			deviceIter->deviceChangeForNextUpdate == EDeviceStatus::Connect )
+		OpenVRDevice *device = &m_TrackedDevices[nSlot];
+		if ( device->deviceStatus == EDeviceStatus::None &&
+			device->deviceChangeForNextUpdate == EDeviceStatus::Connect )
 		{
-			s_Input->InputSubsystem_DeviceConnected( handle, deviceIter->deviceId );
-			deviceIter->deviceChangeForNextUpdate = EDeviceStatus::None;
-			deviceIter->deviceStatus = EDeviceStatus::Connect;
-			XR_TRACE( "[OpenVR] Device connected (status change). Handle: %d. OpenVRIndex: %d. UnityID: %d\n", handle, deviceIter->openVRDeviceIndex, deviceIter->deviceId );
+			s_Input->InputSubsystem_DeviceConnected( handle, device->deviceId );
+			device->deviceChangeForNextUpdate = EDeviceStatus::None;
+			device->deviceStatus = EDeviceStatus::Connect;
+			XR_TRACE( "[OpenVR] Device connected (status change). Handle: %d. OpenVRIndex: %d. UnityID: %d\n", handle, device->openVRDeviceIndex, device->deviceId );
 		}
 
-		if ( deviceIter->deviceChangeForNextUpdate == EDeviceStatus::Disconnect )
+		if ( device->deviceChangeForNextUpdate == EDeviceStatus::Disconnect )
 		{
-			if ( deviceIter->deviceStatus == EDeviceStatus::Connect )
+			if ( device->deviceStatus == EDeviceStatus::Connect )
 			{
-				s_Input->InputSubsystem_DeviceDisconnected( handle, deviceIter->deviceId );
-				XR_TRACE( "[OpenVR] Device disconnected (status change). Handle: %d. OpenVRIndex: %d. UnityID: %d\n", handle, deviceIter->openVRDeviceIndex, deviceIter->deviceId );
+				s_Input->InputSubsystem_DeviceDisconnected( handle, device->deviceId );
+				XR_TRACE( "[OpenVR] Device disconnected (status change). Handle: %d. OpenVRIndex: %d. UnityID: %d\n", handle, device->openVRDeviceIndex, device->deviceId );
 			}
-			deviceIter = m_TrackedDevices.erase( deviceIter );
+			// The last device moves into this slot and is visited next
+			RemoveTrackedDevice( nSlot );
+
+			// A device that only changed characteristics reconnects on the next update
+			m_bTopologyPending = true;
 		}
 		else
-			++deviceIter;
+			++nSlot;
 	}
 
 	return kUnitySubsystemErrorCodeSuccess;
 }
 
-std::optional<std::string> OpenVRInputProvider::OpenVRDevice::GetDeviceName() const
+bool OpenVRInputProvider::OpenVRDevice::GetDeviceName( const DeviceProperties &properties, char ( &deviceName )[k_unMaxDeviceNameSize] ) const
 {
+	if ( !properties.bHasModelNumber )
+		return false;
+
 	if ( ( characteristics & kUnityXRInputDeviceCharacteristicsHeadMounted ) == kUnityXRInputDeviceCharacteristicsHeadMounted )
 	{
-		char deviceModelName[kUnityXRStringSize] = { 0 };
-		if ( OpenVRSystem::Get().GetSystem()->GetStringTrackedDeviceProperty(
-			vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_ModelNumber_String, deviceModelName, sizeof( deviceModelName ) ) == 0 )
-			return std::nullopt;
-
-		std::ostringstream deviceNameStream;
-		deviceNameStream << "OpenVR Headset(" << deviceModelName << ")";
-
-		return { deviceNameStream.str() };
+		snprintf( deviceName, sizeof( deviceName ), "OpenVR Headset(%s)", properties.modelNumber );
 	}
 	else if ( ( characteristics & kUnityXRInputDeviceCharacteristicsHeldInHand ) == kUnityXRInputDeviceCharacteristicsHeldInHand ||
 		( characteristics & kUnityXRInputDeviceCharacteristicsController ) == kUnityXRInputDeviceCharacteristicsController )
 	{
-		char modelNumber[kUnityXRStringSize];
-		if ( OpenVRSystem::Get().GetSystem()->GetStringTrackedDeviceProperty( openVRDeviceIndex,
-			vr::Prop_ModelNumber_String, modelNumber, sizeof( modelNumber ) ) == 0 )
-			return std::nullopt;
-
-		std::ostringstream deviceNameStream;
-
 		if ( ( characteristics & kUnityXRInputDeviceCharacteristicsLeft ) == kUnityXRInputDeviceCharacteristicsLeft )
 		{
-			deviceNameStream << "OpenVR Controller(" << modelNumber << ") - Left";
+			snprintf( deviceName, sizeof( deviceName ), "OpenVR Controller(%s) - Left", properties.modelNumber );
 		}
 		else if ( ( characteristics & kUnityXRInputDeviceCharacteristicsRight ) == kUnityXRInputDeviceCharacteristicsRight )
 		{
-			deviceNameStream << "OpenVR Controller(" << modelNumber << ") - Right";
+			snprintf( deviceName, sizeof( deviceName ), "OpenVR Controller(%s) - Right", properties.modelNumber );
 		}
 		else
 		{
-			deviceNameStream << "OpenVR Controller(" << modelNumber << ")";
+			snprintf( deviceName, sizeof( deviceName ), "OpenVR Controller(%s)", properties.modelNumber );
 		}
-
-		return { deviceNameStream.str() };
 	}
 	else if ( ( characteristics & kUnityXRInputDeviceCharacteristicsTrackingReference ) == kUnityXRInputDeviceCharacteristicsTrackingReference )
 	{
-		char modelNumber[kUnityXRStringSize];
-		if ( OpenVRSystem::Get().GetSystem()->GetStringTrackedDeviceProperty( openVRDeviceIndex,
-			vr::Prop_ModelNumber_String, modelNumber, sizeof( modelNumber ) ) == 0 )
-			return std::nullopt;
-
-		std::ostringstream deviceNameStream;
-		deviceNameStream << "OpenVR Tracking Reference(" << modelNumber << ")";
-		return { deviceNameStream.str() };
+		snprintf( deviceName, sizeof( deviceName ), "OpenVR Tracking Reference(%s)", properties.modelNumber );
 	}
 	else if ( ( characteristics & kUnityXRInputDeviceCharacteristicsTrackedDevice ) == kUnityXRInputDeviceCharacteristicsTrackedDevice )
 	{
-		char modelNumber[kUnityXRStringSize];
-		if ( OpenVRSystem::Get().GetSystem()->GetStringTrackedDeviceProperty( openVRDeviceIndex,
-			vr::Prop_ModelNumber_String, modelNumber, sizeof( modelNumber ) ) == 0 )
-			return std::nullopt;
-
-		std::ostringstream deviceNameStream;
-		deviceNameStream << "OpenVR Tracked Device(" << modelNumber << ")";
-		return { deviceNameStream.str() };
+		snprintf( deviceName, sizeof( deviceName ), "OpenVR Tracked Device(%s)", properties.modelNumber );
 	}
 	else
 	{
-		std::ostringstream retVal;
-
-		char modelNumber[kUnityXRStringSize];
-		char serialNumber[kUnityXRStringSize];
+		if ( !properties.bHasSerialNumber )
+			return false;
 
-		if ( OpenVRSystem::Get().GetSystem()->GetStringTrackedDeviceProperty( openVRDeviceIndex,
-			vr::Prop_ModelNumber_String, modelNumber, sizeof( modelNumber ) ) == 0 )
-			return std::nullopt;
-		if ( OpenVRSystem::Get().GetSystem()->GetStringTrackedDeviceProperty( openVRDeviceIndex,
-			vr::Prop_SerialNumber_String, serialNumber, sizeof( serialNumber ) ) == 0 )
-			return std::nullopt;
-
-		retVal << modelNumber;
-		retVal << " S/N ";
-		retVal << serialNumber;
-
-		return retVal.str();
+		snprintf( deviceName, sizeof( deviceName ), "%s S/N %s", properties.modelNumber, properties.serialNumber );
 	}
+
+	return true;
 }
 
 UnitySubsystemErrorCode UNITY_INTERFACE_API OpenVRInputProvider::FillDeviceDefinition( UnitySubsystemHandle handle, UnityXRInternalInputDeviceId deviceId, UnityXRInputDeviceDefinition *deviceDefinition )
@@ -291,50 +297,37 @@ UnitySubsystemErrorCode UNITY_INTERFACE_API OpenVRInputProvider::FillDeviceDefin
 	if ( !device )
 		return kUnitySubsystemErrorCodeFailure;
 
-	char serialNumber[kUnityXRStringSize];
-	uint32_t serialNumberSize = OpenVRSystem::Get().GetSystem()->GetStringTrackedDeviceProperty( ( *device )->openVRDeviceIndex,
-		vr::Prop_SerialNumber_String, serialNumber, sizeof( serialNumber ) );
-	if ( serialNumberSize == 0 )
+	// Properties come from the cache, a reconnecting device doesn't go back to the runtime
+	const DeviceProperties *properties = m_propertyCache.Get( ( *device )->openVRDeviceIndex );
+	if ( !properties || !properties->bHasSerialNumber )
 		return kUnitySubsystemErrorCodeFailure;
-	s_Input->DeviceDefinition_SetSerialNumber( deviceDefinition, serialNumber );
-	std::string serialNumberString = std::string( serialNumber );
+	s_Input->DeviceDefinition_SetSerialNumber( deviceDefinition, properties->serialNumber );
 
 	// logitech reports two devices. this is the one we want to use. bit of hacky work here.
-	bool isLogitechVirtual = serialNumberString == "LOGITECH_STYLUS_VIRTUAL";
-
-	if ( isLogitechVirtual )
+	if ( properties->bIsLogitechVirtual )
 	{
 		s_Input->DeviceDefinition_SetManufacturer( deviceDefinition, "Logitech" );
 	}
 	else
 	{
-		char manufacturerName[kUnityXRStringSize];
-		uint32_t manufacturerNameSize = OpenVRSystem::Get().GetSystem()->GetStringTrackedDeviceProperty( ( *device )->openVRDeviceIndex,
-			vr::Prop_ManufacturerName_String, manufacturerName, sizeof( manufacturerName ) );
-		if ( manufacturerNameSize == 0 && !isLogitechVirtual )
+		if ( !properties->bHasManufacturerName )
 			return kUnitySubsystemErrorCodeFailure;
-		s_Input->DeviceDefinition_SetManufacturer( deviceDefinition, manufacturerName );
-		std::string manufacturerNameString = std::string( manufacturerName );
+		s_Input->DeviceDefinition_SetManufacturer( deviceDefinition, properties->manufacturerName );
 
-		if ( manufacturerNameString == "Logitech" && !isLogitechVirtual )
+		if ( properties->bIsLogitech )
 			return kUnitySubsystemErrorCodeFailure;
 	}
 
+	char deviceName[OpenVRDevice::k_unMaxDeviceNameSize];
+	if ( !( *device )->GetDeviceName( *properties, deviceName ) )
+		snprintf( deviceName, sizeof( deviceName ), "%s", properties->serialNumber );
 
-	auto deviceName = ( *device )->GetDeviceName();
-	if ( !deviceName )
-		deviceName = serialNumberString;
-
-	char inputProfileBuffer[kUnityXRStringSize];
-	uint32_t inputProfileSize = OpenVRSystem::Get().GetSystem()->GetStringTrackedDeviceProperty( ( *device )->openVRDeviceIndex,
-		vr::Prop_ControllerType_String, inputProfileBuffer, sizeof( inputProfileBuffer ) );
-	if ( inputProfileSize == 0 )
+	if ( !properties->bHasControllerType )
 		return kUnitySubsystemErrorCodeFailure;
-	std::string inputProfileName = std::string( inputProfileBuffer );
 
-	XR_TRACE( "[OpenVR] Found device OpenVRIndex:(%d) UnityIndex:(%d) with input profile:(%s) and name: (%s)\n", ( *device )->openVRDeviceIndex, deviceId, inputProfileName.c_str(), deviceName.value().c_str() );
+	XR_TRACE( "[OpenVR] Found device OpenVRIndex:(%d) UnityIndex:(%d) with input profile:(%s) and name: (%s)\n", ( *device )->openVRDeviceIndex, deviceId, properties->controllerType, deviceName );
 
-	s_Input->DeviceDefinition_SetName( deviceDefinition, deviceName->c_str() );
+	s_Input->DeviceDefinition_SetName( deviceDefinition, deviceName );
 	s_Input->DeviceDefinition_SetCharacteristics( deviceDefinition, ( *device )->characteristics );
 	s_Input->DeviceDefinition_SetCanQueryForDeviceStateAtTime( deviceDefinition, true );
 
@@ -393,6 +386,39 @@ UnitySubsystemErrorCode UNITY_INTERFACE_API OpenVRInputProvider::FillDeviceDefin
 			s_Input->DeviceDefinition_AddFeatureWithUsage( deviceDefinition, "TrackingState", kUnityXRInputFeatureTypeDiscreteStates, kUnityXRInputFeatureUsageTrackingState );
 		controllerFeatureIndices[static_cast< int >( ControllerFeature::IsTracked )] =
 			s_Input->DeviceDefinition_AddFeatureWithUsage( deviceDefinition, "IsTracked", kUnityXRInputFeatureTypeBinary, kUnityXRInputFeatureUsageIsTracked );
+
+		// Buttons and axes, only for controllers in a hand and only if they can be read natively. Added after the pose
+		// features so the pose feature indices are the same for every controller.
+		bool bIsHanded = ( ( *device )->characteristics & ( kUnityXRInputDeviceCharacteristicsLeft | kUnityXRInputDeviceCharacteristicsRight ) ) != 0;
+		( *device )->bHasActionFeatures = bIsHanded && m_actionInput.IsInitialized();
+		if ( ( *device )->bHasActionFeatures )
+		{
+			for ( uint32_t unAction = 0; unAction < k_unNumControllerFeatureActions; ++unAction )
+			{
+				const ControllerFeatureAction &featureAction = k_controllerFeatureActions[unAction];
+				controllerFeatureIndices[static_cast< int >( featureAction.feature )] = featureAction.usage ?
+					s_Input->DeviceDefinition_AddFeatureWithUsage( deviceDefinition, featureAction.pchName, featureAction.type, featureAction.usage ) :
+					s_Input->DeviceDefinition_AddFeature( deviceDefinition, featureAction.pchName, featureAction.type );
+			}
+		}
+
+		// Hand skeleton, the bones from the wrist on follow the hand feature
+		( *device )->handFeatureIndex = kUnityInvalidXRInputFeatureIndex;
+		( *device )->firstBoneFeatureIndex = kUnityInvalidXRInputFeatureIndex;
+		if ( bIsHanded && m_handSkeleton.IsInitialized() )
+		{
+			( *device )->handFeatureIndex = s_Input->DeviceDefinition_AddFeatureWithUsage( deviceDefinition, "Hand", kUnityXRInputFeatureTypeHand, kUnityXRInputFeatureUsageHandData );
+			for ( uint32_t unBone = 0; unBone < HandSkeleton::k_unNumUnityBones; ++unBone )
+			{
+				char boneName[kUnityXRStringSize];
+				snprintf( boneName, sizeof( boneName ), "Bone - %s", HandSkeleton::GetBoneName( HandSkeleton::k_unFirstUnityBone + unBone ) );
+				UnityXRInputFeatureIndex featureIndex = s_Input->DeviceDefinition_AddFeature( deviceDefinition, boneName, kUnityXRInputFeatureTypeBone );
+				if ( unBone == 0 )
+				{
+					( *device )->firstBoneFeatureIndex = featureIndex;
+				}
+			}
+		}
 	}
 	else if ( ( ( *device )->characteristics & kUnityXRInputDeviceCharacteristicsTrackingReference ) == kUnityXRInputDeviceCharacteristicsTrackingReference )
 	{
@@ -428,108 +454,47 @@ UnitySubsystemErrorCode UNITY_INTERFACE_API OpenVRInputProvider::FillDeviceDefin
 	return kUnitySubsystemErrorCodeSuccess;
 }
 
-static void OpenVRMatrix3x4ToUnity( const vr::HmdMatrix34_t &ovrm, UnityXRMatrix4x4 &out )
+// Called on the main thread when poses are latched
+void OpenVRInputProvider::UpdateEyeToHeadTransforms()
 {
-	float tmpMatrix[] =
-	{
-		ovrm.m[0][0], ovrm.m[1][0], ovrm.m[2][0], 0.0f,
-		ovrm.m[0][1], ovrm.m[1][1], ovrm.m[2][1], 0.0f,
-		ovrm.m[0][2], ovrm.m[1][2], ovrm.m[2][2], 0.0f,
-		ovrm.m[0][3], ovrm.m[1][3], ovrm.m[2][3], 1.0f
-	};
-
-	out.columns[0].x = tmpMatrix[( 0 * 4 ) + 0];
-	out.columns[1].x = tmpMatrix[( 1 * 4 ) + 0];
-	out.columns[2].x = -tmpMatrix[( 2 * 4 ) + 0];
-	out.columns[3].x = tmpMatrix[( 3 * 4 ) + 0];
-
-	out.columns[0].y = tmpMatrix[( 0 * 4 ) + 1];
-	out.columns[1].y = tmpMatrix[( 1 * 4 ) + 1];
-	out.columns[2].y = -tmpMatrix[( 2 * 4 ) + 1];
-	out.columns[3].y = tmpMatrix[( 3 * 4 ) + 1];
-
-	out.columns[0].z = -tmpMatrix[( 0 * 4 ) + 2];
-	out.columns[1].z = -tmpMatrix[( 1 * 4 ) + 2];
-	out.columns[2].z = tmpMatrix[( 2 * 4 ) + 2];
-	out.columns[3].z = -tmpMatrix[( 3 * 4 ) + 2];
-
-	out.columns[0].w = tmpMatrix[( 0 * 4 ) + 3];
-	out.columns[1].w = tmpMatrix[( 1 * 4 ) + 3];
-	out.columns[2].w = -tmpMatrix[( 2 * 4 ) + 3];
-	out.columns[3].w = tmpMatrix[( 3 * 4 ) + 3];
-}
+	bool bRefresh = !m_bEyeToHeadValid || m_latchedPoses.flUserIpdMeters != m_flEyeToHeadIpd;
+	if ( UserProjectSettings::GetNativeEventPumpEnabled() )
+		bRefresh |= OpenVRSystem::Get().ConsumeIpdChange();
 
-void OpenVRInputProvider::OpenVRToUnityTracking( const vr::TrackedDevicePose_t &openVRPose, std::optional<UnityXRMatrix4x4> postTransform,
-	UnityXRVector3 &outPosition, UnityXRVector4 &outRotation, UnityXRVector3 &outVelocity, UnityXRVector3 &outAngularVelocity )
-{
-	UnityXRMatrix4x4 trackingToReference;
-	OpenVRMatrix3x4ToUnity( openVRPose.mDeviceToAbsoluteTracking, trackingToReference );
+	if ( !bRefresh || OpenVRSystem::Get().GetSystem() == nullptr )
+		return;
 
-	if ( postTransform )
+	for ( int nEye = 0; nEye < 2; ++nEye )
 	{
-		XRMatrix4x4 &xrTrackingTransformRef = reinterpret_cast< XRMatrix4x4 & >( trackingToReference );
-		xrTrackingTransformRef = reinterpret_cast< XRMatrix4x4 & >( *postTransform ) * xrTrackingTransformRef;
-	}
-
-	outPosition.x = trackingToReference.columns[3].x;
-	outPosition.y = trackingToReference.columns[3].y;
-	outPosition.z = trackingToReference.columns[3].z;
-
-	XRMatrix3x3 rotationMatrix = {
-		trackingToReference.columns[0].x, trackingToReference.columns[1].x, trackingToReference.columns[2].x,
-		trackingToReference.columns[0].y, trackingToReference.columns[1].y, trackingToReference.columns[2].y,
-		trackingToReference.columns[0].z, trackingToReference.columns[1].z, trackingToReference.columns[2].z
-	};
-	XRQuaternion xrQuaternion;
-	MatrixToQuaternion( rotationMatrix, xrQuaternion );
-	outRotation.x = xrQuaternion.x;
-	outRotation.y = xrQuaternion.y;
-	outRotation.z = xrQuaternion.z;
-	outRotation.w = -xrQuaternion.w;
-
-	outVelocity.x = openVRPose.vVelocity.v[0];
-	outVelocity.y = openVRPose.vVelocity.v[1];
-	outVelocity.z = -openVRPose.vVelocity.v[2];
-
-	outAngularVelocity.x = openVRPose.vAngularVelocity.v[0];
-	outAngularVelocity.y = openVRPose.vAngularVelocity.v[1];
-	outAngularVelocity.z = -openVRPose.vAngularVelocity.v[2];
-}
-
-UnityXRMatrix4x4 OpenVRInputProvider::GetEyeTransform( EHMDEye eye )
-{
-	assert( eye != EHMDEye::Center );
-	if ( eye == EHMDEye::Center )
-		return XRMatrix4x4::identity;
-
-	const vr::EVREye openVREye = ( eye == EHMDEye::Left ) ? vr::Eye_Left : vr::Eye_Right;
-	vr::HmdMatrix34_t eyeOpenVRTransform = OpenVRSystem::Get().GetSystem()->GetEyeToHeadTransform( openVREye );
-	UnityXRMatrix4x4 eyeTransform;
-	OpenVRMatrix3x4ToUnity( eyeOpenVRTransform, eyeTransform );
-	return eyeTransform;
-}
+		const vr::EVREye openVREye = ( nEye == static_cast< int >( EHMDEye::Left ) ) ? vr::Eye_Left : vr::Eye_Right;
+		vr::HmdMatrix34_t eyeToHead = OpenVRSystem::Get().GetSystem()->GetEyeToHeadTransform( openVREye );
+		ConvertTransformToUnity( eyeToHead, m_eyeToHeadPositions[nEye], m_eyeToHeadRotations[nEye] );
 
-static UnityXRTimeStamp GetCurrentUnityTimestamp()
-{
-	auto now = std::chrono::system_clock::now();
-	auto ms = std::chrono::duration_cast< std::chrono::milliseconds >( now.time_since_epoch() ).count();
-	return static_cast< UnityXRTimeStamp >( ms );
+		// Flip to w >= 0 so the composed eye rotations keep the sign convention of the head rotation
+		UnityXRVector4 &rotation = m_eyeToHeadRotations[nEye];
+		rotation = { -rotation.x, -rotation.y, -rotation.z, -rotation.w };
+	}
+	m_flEyeToHeadIpd = m_latchedPoses.flUserIpdMeters;
+	m_bEyeToHeadValid = true;
 }
 
 UnitySubsystemErrorCode OpenVRInputProvider::Internal_UpdateDeviceState(
 	UnitySubsystemHandle handle, const OpenVRDevice &device,
-	const vr::TrackedDevicePose_t &trackingPose, UnityXRInputDeviceState *deviceState, bool updateNonTrackingData )
+	const vr::TrackedDevicePose_t &trackingPose, const UnityDevicePose &unityPose, UnityXRInputDeviceState *deviceState, bool updateNonTrackingData )
 {
 	if ( OpenVRSystem::Get().GetSystem()->IsInputAvailable() == false )
 		updateNonTrackingData = false;
 
-	updateNonTrackingData = false;
-
 	int trackingState = kUnityXRInputTrackingStatePosition | kUnityXRInputTrackingStateRotation | kUnityXRInputTrackingStateVelocity | kUnityXRInputTrackingStateAngularVelocity;
 
 	if ( !trackingPose.bPoseIsValid )
 		trackingState = kUnityXRInputTrackingStateNone;
 
+	const UnityXRVector3 &devicePosition = unityPose.position;
+	const UnityXRVector4 &deviceRotation = unityPose.rotation;
+	const UnityXRVector3 &deviceVelocity = unityPose.velocity;
+	const UnityXRVector3 &deviceAngularVelocity = unityPose.angularVelocity;
+
 	if ( ( device.characteristics & kUnityXRInputDeviceCharacteristicsHeadMounted ) == kUnityXRInputDeviceCharacteristicsHeadMounted )
 	{
 		s_Input->DeviceState_SetDiscreteStateValue( deviceState,
@@ -540,27 +505,28 @@ UnitySubsystemErrorCode OpenVRInputProvider::Internal_UpdateDeviceState(
 		bool present = activityLevel == vr::k_EDeviceActivityLevel_UserInteraction;
 		s_Input->DeviceState_SetBinaryValue( deviceState, hmdFeatureIndices[static_cast< int >( HMDFeature::UserPresence )], present ); 
 
-		UnityXRVector3 devicePosition, deviceVelocity, deviceAngularVelocity;
-		UnityXRVector4 deviceRotation;
-		OpenVRToUnityTracking( trackingPose, std::nullopt, devicePosition, deviceRotation, deviceVelocity, deviceAngularVelocity );
 		s_Input->DeviceState_SetAxis3DValue( deviceState, hmdFeatureIndices[static_cast< int >( HMDFeature::DevicePosition )], devicePosition );
 		s_Input->DeviceState_SetRotationValue( deviceState, hmdFeatureIndices[static_cast< int >( HMDFeature::DeviceRotation )], deviceRotation );
 		s_Input->DeviceState_SetAxis3DValue( deviceState, hmdFeatureIndices[static_cast< int >( HMDFeature::DeviceVelocity )], deviceVelocity );
 		s_Input->DeviceState_SetAxis3DValue( deviceState, hmdFeatureIndices[static_cast< int >( HMDFeature::DeviceAngularVelocity )], deviceAngularVelocity );
 
-		UnityXRVector3 leftEyePosition, leftEyeVelocity, leftEyeAngularVelocity;
+		// Eyes are rigidly attached to the head, they share its velocities
+		const UnityXRVector3 &leftEyeVelocity = deviceVelocity, &leftEyeAngularVelocity = deviceAngularVelocity;
+		const UnityXRVector3 &rightEyeVelocity = deviceVelocity, &rightEyeAngularVelocity = deviceAngularVelocity;
+
+		UnityXRVector3 leftEyePosition;
 		UnityXRVector4 leftEyeRotation;
-		UnityXRMatrix4x4 leftEyeTransform = GetEyeTransform( EHMDEye::Left );
-		OpenVRToUnityTracking( trackingPose, { leftEyeTransform }, leftEyePosition, leftEyeRotation, leftEyeVelocity, leftEyeAngularVelocity );
+		ComposeRigidTransforms( devicePosition, deviceRotation, m_eyeToHeadPositions[static_cast< int >( EHMDEye::Left )], m_eyeToHeadRotations[static_cast< int >( EHMDEye::Left )],
+			leftEyePosition, leftEyeRotation );
 		s_Input->DeviceState_SetAxis3DValue( deviceState, hmdFeatureIndices[static_cast< int >( HMDFeature::LeftEyePosition )], leftEyePosition );
 		s_Input->DeviceState_SetRotationValue( deviceState, hmdFeatureIndices[static_cast< int >( HMDFeature::LeftEyeRotation )], leftEyeRotation );
 		s_Input->DeviceState_SetAxis3DValue( deviceState, hmdFeatureIndices[static_cast< int >( HMDFeature::LeftEyeVelocity )], leftEyeVelocity );
 		s_Input->DeviceState_SetAxis3DValue( deviceState, hmdFeatureIndices[static_cast< int >( HMDFeature::LeftEyeAngularVelocity )], leftEyeAngularVelocity );
 
-		UnityXRVector3 rightEyePosition, rightEyeVelocity, rightEyeAngularVelocity;
+		UnityXRVector3 rightEyePosition;
 		UnityXRVector4 rightEyeRotation;
-		UnityXRMatrix4x4 rightEyeTransform = GetEyeTransform( EHMDEye::Right );
-		OpenVRToUnityTracking( trackingPose, { rightEyeTransform }, rightEyePosition, rightEyeRotation, rightEyeVelocity, rightEyeAngularVelocity );
+		ComposeRigidTransforms( devicePosition, deviceRotation, m_eyeToHeadPositions[static_cast< int >( EHMDEye::Right )], m_eyeToHeadRotations[static_cast< int >( EHMDEye::Right )],
+			rightEyePosition, rightEyeRotation );
 		s_Input->DeviceState_SetAxis3DValue( deviceState, hmdFeatureIndices[static_cast< int >( HMDFeature::RightEyePosition )], rightEyePosition );
 		s_Input->DeviceState_SetRotationValue( deviceState, hmdFeatureIndices[static_cast< int >( HMDFeature::RightEyeRotation )], rightEyeRotation );
 		s_Input->DeviceState_SetAxis3DValue( deviceState, hmdFeatureIndices[static_cast< int >( HMDFeature::RightEyeVelocity )], rightEyeVelocity );
@@ -578,13 +544,73 @@ UnitySubsystemErrorCode OpenVRInputProvider::Internal_UpdateDeviceState(
 			controllerFeatureIndices[static_cast< int >( ControllerFeature::TrackingState )], trackingState );
 		s_Input->DeviceState_SetBinaryValue( deviceState, controllerFeatureIndices[static_cast< int >( ControllerFeature::IsTracked )], trackingPose.bPoseIsValid );
 
-		UnityXRVector3 devicePosition, deviceVelocity, deviceAngularVelocity;
-		UnityXRVector4 deviceRotation;
-		OpenVRToUnityTracking( trackingPose, std::nullopt, devicePosition, deviceRotation, deviceVelocity, deviceAngularVelocity );
 		s_Input->DeviceState_SetAxis3DValue( deviceState, controllerFeatureIndices[static_cast< int >( ControllerFeature::DevicePosition )], devicePosition );
 		s_Input->DeviceState_SetRotationValue( deviceState, controllerFeatureIndices[static_cast< int >( ControllerFeature::DeviceRotation )], deviceRotation );
 		s_Input->DeviceState_SetAxis3DValue( deviceState, controllerFeatureIndices[static_cast< int >( ControllerFeature::DeviceVelocity )], deviceVelocity );
 		s_Input->DeviceState_SetAxis3DValue( deviceState, controllerFeatureIndices[static_cast< int >( ControllerFeature::DeviceAngularVelocity )], deviceAngularVelocity );
+
+		// Buttons and axes come from the state read in this update's UpdateActionInput
+		ActionInput::EHand eHand = ( ( device.characteristics & kUnityXRInputDeviceCharacteristicsLeft ) == kUnityXRInputDeviceCharacteristicsLeft ) ? ActionInput::Hand_Left : ActionInput::Hand_Right;
+		bool bIsHanded = ( device.characteristics & ( kUnityXRInputDeviceCharacteristicsLeft | kUnityXRInputDeviceCharacteristicsRight ) ) != 0;
+		if ( updateNonTrackingData && bIsHanded && device.bHasActionFeatures && m_actionInput.IsInitialized() )
+		{
+			for ( uint32_t unAction = 0; unAction < k_unNumControllerFeatureActions; ++unAction )
+			{
+				const ControllerFeatureAction &featureAction = k_controllerFeatureActions[unAction];
+				const ActionInput::ActionValue &value = m_actionInput.GetValue( eHand, unAction );
+				int featureIndex = controllerFeatureIndices[static_cast< int >( featureAction.feature )];
+
+				switch ( featureAction.type )
+				{
+				case kUnityXRInputFeatureTypeBinary:
+					s_Input->DeviceState_SetBinaryValue( deviceState, featureIndex, value.x != 0.0f );
+					break;
+				case kUnityXRInputFeatureTypeAxis1D:
+					s_Input->DeviceState_SetAxis1DValue( deviceState, featureIndex, value.x );
+					break;
+				case kUnityXRInputFeatureTypeAxis2D:
+					s_Input->DeviceState_SetAxis2DValue( deviceState, featureIndex, UnityXRVector2{ value.x, value.y } );
+					break;
+				default:
+					break;
+				}
+			}
+		}
+
+		// Bones come from the skeletons read in this update's UpdateActionInput, placed with the controller pose
+		if ( updateNonTrackingData && bIsHanded && device.handFeatureIndex != kUnityInvalidXRInputFeatureIndex && m_handSkeleton.IsInitialized() )
+		{
+			UnityXRVector3 bonePositions[HandSkeleton::k_unNumUnityBones];
+			UnityXRVector4 boneRotations[HandSkeleton::k_unNumUnityBones];
+			if ( m_handSkeleton.GetUnityBones( eHand, devicePosition, deviceRotation, bonePositions, boneRotations ) )
+			{
+				for ( uint32_t unBone = 0; unBone < HandSkeleton::k_unNumUnityBones; ++unBone )
+				{
+					uint32_t unParent = HandSkeleton::GetParentBone( HandSkeleton::k_unFirstUnityBone + unBone );
+
+					UnityXRBone bone;
+					bone.parentBoneIndex = unParent < HandSkeleton::k_unFirstUnityBone ? kUnityInvalidXRInputFeatureIndex : device.firstBoneFeatureIndex + unParent - HandSkeleton::k_unFirstUnityBone;
+					bone.position = bonePositions[unBone];
+					bone.rotation = boneRotations[unBone];
+					s_Input->DeviceState_SetBoneValue( deviceState, device.firstBoneFeatureIndex + unBone, bone );
+				}
+
+				// Unity's fingers have up to five bones, OpenVR's thumb has four
+				UnityXRHand hand;
+				hand.rootBoneIndex = device.firstBoneFeatureIndex;
+				static const uint32_t k_unFirstFingerBone[UnityXRFingerCount] = { 2, 6, 11, 16, 21 };
+				static const uint32_t k_unNumFingerBones[UnityXRFingerCount] = { 4, 5, 5, 5, 5 };
+				for ( int nFinger = 0; nFinger < UnityXRFingerCount; ++nFinger )
+				{
+					for ( int nFingerBone = 0; nFingerBone < kUnityXRMaxFingerBoneCount; ++nFingerBone )
+					{
+						hand.fingerBonesIndices[nFinger][nFingerBone] = static_cast< uint32_t >( nFingerBone ) < k_unNumFingerBones[nFinger] ?
+							device.firstBoneFeatureIndex + k_unFirstFingerBone[nFinger] + nFingerBone - HandSkeleton::k_unFirstUnityBone : kUnityInvalidXRInputFeatureIndex;
+					}
+				}
+				s_Input->DeviceState_SetHandValue( deviceState, device.handFeatureIndex, hand );
+			}
+		}
 	}
 	else if ( ( device.characteristics & kUnityXRInputDeviceCharacteristicsTrackingReference ) == kUnityXRInputDeviceCharacteristicsTrackingReference )
 	{
@@ -592,9 +618,6 @@ UnitySubsystemErrorCode OpenVRInputProvider::Internal_UpdateDeviceState(
 			trackerFeatureIndices[static_cast< int >( TrackerFeature::TrackingState )], trackingState );
 		s_Input->DeviceState_SetBinaryValue( deviceState, trackerFeatureIndices[static_cast< int >( TrackerFeature::IsTracked )], trackingPose.bPoseIsValid );
 
-		UnityXRVector3 devicePosition, deviceVelocity, deviceAngularVelocity;
-		UnityXRVector4 deviceRotation;
-		OpenVRToUnityTracking( trackingPose, std::nullopt, devicePosition, deviceRotation, deviceVelocity, deviceAngularVelocity );
 		s_Input->DeviceState_SetAxis3DValue( deviceState, trackerFeatureIndices[static_cast< int >( TrackerFeature::DevicePosition )], devicePosition );
 		s_Input->DeviceState_SetRotationValue( deviceState, trackerFeatureIndices[static_cast< int >( TrackerFeature::DeviceRotation )], deviceRotation );
 		s_Input->DeviceState_SetAxis3DValue( deviceState, trackerFeatureIndices[static_cast< int >( TrackerFeature::DeviceVelocity )], deviceVelocity );
@@ -606,9 +629,6 @@ UnitySubsystemErrorCode OpenVRInputProvider::Internal_UpdateDeviceState(
 			trackerFeatureIndices[static_cast< int >( TrackerFeature::TrackingState )], trackingState );
 		s_Input->DeviceState_SetBinaryValue( deviceState, trackerFeatureIndices[static_cast< int >( TrackerFeature::IsTracked )], trackingPose.bPoseIsValid );
 
-		UnityXRVector3 devicePosition, deviceVelocity, deviceAngularVelocity;
-		UnityXRVector4 deviceRotation;
-		OpenVRToUnityTracking( trackingPose, std::nullopt, devicePosition, deviceRotation, deviceVelocity, deviceAngularVelocity );
 		s_Input->DeviceState_SetAxis3DValue( deviceState, trackerFeatureIndices[static_cast< int >( TrackerFeature::DevicePosition )], devicePosition );
 		s_Input->DeviceState_SetRotationValue( deviceState, trackerFeatureIndices[static_cast< int >( TrackerFeature::DeviceRotation )], deviceRotation );
 		s_Input->DeviceState_SetAxis3DValue( deviceState, trackerFeatureIndices[static_cast< int >( TrackerFeature::DeviceVelocity )], deviceVelocity );
@@ -624,12 +644,20 @@ UnitySubsystemErrorCode UNITY_INTERFACE_API OpenVRInputProvider::UpdateDeviceSta
 	if ( !device )
 		return kUnitySubsystemErrorCodeFailure;
 
+	// Before render updates get the poses for the frame being rendered, dynamic updates the prediction for the frame after
+	const vr::TrackedDevicePose_t &trackingPose = ( updateType == kUnityXRInputUpdateTypeBeforeRender ) ?
+		m_latchedPoses.current[( *device )->openVRDeviceIndex] : m_latchedPoses.future[( *device )->openVRDeviceIndex];
+	UnityDevicePose unityPose;
+	( ( updateType == kUnityXRInputUpdateTypeBeforeRender ) ? m_latchedUnityCurrent : m_latchedUnityFuture ).Get( ( *device )->openVRDeviceIndex, unityPose );
+
 	UnitySubsystemErrorCode errorCode =
-		Internal_UpdateDeviceState( handle, **device, ( *device )->trackingPose[updateType], deviceState, true );
+		Internal_UpdateDeviceState( handle, **device, trackingPose, unityPose, deviceState, true );
 	if ( errorCode != kUnitySubsystemErrorCodeSuccess )
 		return errorCode;
 
-	s_Input->DeviceState_SetDeviceTime( deviceState, GetCurrentUnityTimestamp() );
+	// The state is as of when the poses were received, not when Unity asked for it
+	uint64_t nSampleTimeNs = m_latchedPoses.nSequence != 0 ? m_latchedPoses.nSampleTimeNs : TimeDomain::GetNowNs();
+	s_Input->DeviceState_SetDeviceTime( deviceState, TimeDomain::Get().ToUnityTimestamp( nSampleTimeNs ) );
 	return kUnitySubsystemErrorCodeSuccess;
 }
 
@@ -707,7 +735,15 @@ UnitySubsystemErrorCode UNITY_INTERFACE_API OpenVRInputProvider::HandleEvent( Un
 
 UnitySubsystemErrorCode UNITY_INTERFACE_API OpenVRInputProvider::HandleRecenter( UnitySubsystemHandle handle )
 {
-	return RecenterTrackingOrigin();
+	UnitySubsystemErrorCode result = RecenterTrackingOrigin();
+
+	// Recorded poses are relative to the old origin, which is only gone once the recenter went through
+	if ( result == kUnitySubsystemErrorCodeSuccess )
+	{
+		m_poseHistory.Invalidate();
+	}
+
+	return result;
 }
 
 UnitySubsystemErrorCode UNITY_INTERFACE_API OpenVRInputProvider::HandleHapticImpulse( UnitySubsystemHandle handle, UnityXRInternalInputDeviceId deviceId, int channel, float amplitude, float duration )
@@ -792,25 +828,38 @@ UnitySubsystemErrorCode UNITY_INTERFACE_API OpenVRInputProvider::HandleSetTracki
 
 UnitySubsystemErrorCode UNITY_INTERFACE_API OpenVRInputProvider::TryGetDeviceStateAtTime( UnitySubsystemHandle handle, UnityXRTimeStamp time, UnityXRInternalInputDeviceId deviceId, UnityXRInputDeviceState *state )
 {
-	UnityXRTimeStamp currentTimestamp = GetCurrentUnityTimestamp();
-	UnityXRTimeStamp timestampDelta = time - currentTimestamp;
-	constexpr float kMillisecondsInSecond = 1000.0f;
-	float deltaTimeInSeconds = static_cast< float >( timestampDelta ) / kMillisecondsInSecond;
-
-	vr::TrackedDevicePose_t trackedDevicesAtTimestamp[vr::k_unMaxTrackedDeviceCount];
-	vr::ETrackingUniverseOrigin trackingSpace = OpenVRSystem::Get().GetCompositor()->GetTrackingSpace();
-	OpenVRSystem::Get().GetSystem()->GetDeviceToAbsoluteTrackingPose( trackingSpace, deltaTimeInSeconds, trackedDevicesAtTimestamp, vr::k_unMaxTrackedDeviceCount );
-
 	auto device = GetTrackedDeviceByDeviceId( deviceId );
 	if ( !device )
 		return kUnitySubsystemErrorCodeFailure;
 
-	assert( ( *device )->openVRDeviceIndex < vr::k_unMaxTrackedDeviceCount );
-	if ( ( *device )->openVRDeviceIndex >= vr::k_unMaxTrackedDeviceCount )
+	const vr::TrackedDeviceIndex_t openVRDeviceIndex = ( *device )->openVRDeviceIndex;
+	assert( openVRDeviceIndex < vr::k_unMaxTrackedDeviceCount );
+	if ( openVRDeviceIndex >= vr::k_unMaxTrackedDeviceCount )
 		return kUnitySubsystemErrorCodeFailure;
 
+	// Unity timestamps are mapped onto the monotonic clock, so the delta is exact to the nanosecond and immune to wall clock changes
+	int64_t nowNs = static_cast< int64_t >( TimeDomain::GetNowNs() );
+	int64_t queryNs = TimeDomain::Get().FromUnityTimestamp( time );
+	constexpr double kNanosecondsInSecond = 1e9;
+	float deltaTimeInSeconds = static_cast< float >( static_cast< double >( queryNs - nowNs ) / kNanosecondsInSecond );
+
+	// Past timestamps are interpolated from the recorded history, only the future needs the runtime's prediction
+
+	vr::TrackedDevicePose_t trackingPose;
+	if ( queryNs < 0 || !m_poseHistory.Sample( openVRDeviceIndex, static_cast< uint64_t >( queryNs ), trackingPose ) )
+	{
+		// Only fill the poses up to the requested device
+		vr::TrackedDevicePose_t trackedDevicesAtTimestamp[vr::k_unMaxTrackedDeviceCount];
+		vr::ETrackingUniverseOrigin trackingSpace = OpenVRSystem::Get().GetCompositor()->GetTrackingSpace();
+		OpenVRSystem::Get().GetSystem()->GetDeviceToAbsoluteTrackingPose( trackingSpace, deltaTimeInSeconds, trackedDevicesAtTimestamp, openVRDeviceIndex + 1 );
+		trackingPose = trackedDevicesAtTimestamp[openVRDeviceIndex];
+	}
+
+	UnityDevicePose unityPose;
+	ConvertPoseToUnity( trackingPose, unityPose );
+
 	UnitySubsystemErrorCode errorCode =
-		Internal_UpdateDeviceState( handle, **device, trackedDevicesAtTimestamp[( *device )->openVRDeviceIndex], state, false );
+		Internal_UpdateDeviceState( handle, **device, trackingPose, unityPose, state, false );
 	if ( errorCode != kUnitySubsystemErrorCodeSuccess )
 		return errorCode;
 
@@ -818,8 +867,10 @@ UnitySubsystemErrorCode UNITY_INTERFACE_API OpenVRInputProvider::TryGetDeviceSta
 	return kUnitySubsystemErrorCodeSuccess;
 }
 
-UnityXRInputDeviceCharacteristics GetCharacteristicsForDeviceIndex( vr::TrackedDeviceIndex_t deviceIndex )
+// unNumCalls counts the calls into the runtime
+UnityXRInputDeviceCharacteristics GetCharacteristicsForDeviceIndex( vr::TrackedDeviceIndex_t deviceIndex, uint32_t &unNumCalls )
 {
+	unNumCalls++;
 	const vr::ETrackedDeviceClass trackedDeviceClass = OpenVRSystem::Get().GetSystem()->GetTrackedDeviceClass( deviceIndex );
 
 	switch ( trackedDeviceClass )
@@ -829,6 +880,7 @@ UnityXRInputDeviceCharacteristics GetCharacteristicsForDeviceIndex( vr::TrackedD
 		break;
 	case vr::TrackedDeviceClass_Controller:
 	{
+		unNumCalls++;
 		vr::ETrackedControllerRole openVRRole = OpenVRSystem::Get().GetSystem()->GetControllerRoleForTrackedDeviceIndex( deviceIndex );
 		switch ( openVRRole )
 		{
@@ -850,6 +902,7 @@ UnityXRInputDeviceCharacteristics GetCharacteristicsForDeviceIndex( vr::TrackedD
 		break;
 	case vr::TrackedDeviceClass_GenericTracker:
 	{
+		unNumCalls++;
 		vr::ETrackedControllerRole openVRRole = OpenVRSystem::Get().GetSystem()->GetControllerRoleForTrackedDeviceIndex( deviceIndex );
 		switch ( openVRRole )
 		{
@@ -877,32 +930,187 @@ UnityXRInputDeviceCharacteristics GetCharacteristicsForDeviceIndex( vr::TrackedD
 
 UnityXRInternalInputDeviceId OpenVRInputProvider::GenerateUniqueDeviceId() const
 {
-	std::vector<UnityXRInternalInputDeviceId> sortedDeviceIds;
-	for ( auto device : m_TrackedDevices )
-		sortedDeviceIds.emplace_back( device.deviceId );
+	// Lowest id not in use, same as before ids were tracked in a bitset
+	uint64_t nFreeIds = ~m_nUsedDeviceIds;
+	assert( nFreeIds != 0 );
+	if ( nFreeIds == 0 )
+		return kUnityInvalidXRInternalInputDeviceId;
+
+#ifdef _MSC_VER
+	unsigned long nLowestFree;
+	_BitScanForward64( &nLowestFree, nFreeIds );
+	return static_cast< UnityXRInternalInputDeviceId >( nLowestFree );
+#else
+	return static_cast< UnityXRInternalInputDeviceId >( __builtin_ctzll( nFreeIds ) );
+#endif
+}
+
+OpenVRInputProvider::OpenVRDevice &OpenVRInputProvider::AddTrackedDevice( vr::TrackedDeviceIndex_t openVRDeviceIndex, UnityXRInputDeviceCharacteristics characteristics )
+{
+	assert( openVRDeviceIndex < vr::k_unMaxTrackedDeviceCount && m_deviceSlotByOpenVRIndex[openVRDeviceIndex] == 0 );
+
+	// Reserved once so adding a device never reallocates
+	if ( m_TrackedDevices.capacity() < vr::k_unMaxTrackedDeviceCount )
+		m_TrackedDevices.reserve( vr::k_unMaxTrackedDeviceCount );
+
+	UnityXRInternalInputDeviceId deviceId = GenerateUniqueDeviceId();
+	m_nUsedDeviceIds |= 1ull << deviceId;
+
+	m_TrackedDevices.emplace_back( openVRDeviceIndex, deviceId, characteristics );
+	uint8_t nSlotPlusOne = static_cast< uint8_t >( m_TrackedDevices.size() );
+	m_deviceSlotByOpenVRIndex[openVRDeviceIndex] = nSlotPlusOne;
+	m_deviceSlotByDeviceId[deviceId] = nSlotPlusOne;
+
+	return m_TrackedDevices.back();
+}
+
+void OpenVRInputProvider::RemoveTrackedDevice( size_t nSlot )
+{
+	OpenVRDevice &device = m_TrackedDevices[nSlot];
+	m_nUsedDeviceIds &= ~( 1ull << device.deviceId );
+	m_deviceSlotByOpenVRIndex[device.openVRDeviceIndex] = 0;
+	m_deviceSlotByDeviceId[device.deviceId] = 0;
+
+	// Move the last device into the hole
+	if ( nSlot + 1 != m_TrackedDevices.size() )
+	{
+		device = m_TrackedDevices.back();
+		uint8_t nSlotPlusOne = static_cast< uint8_t >( nSlot + 1 );
+		m_deviceSlotByOpenVRIndex[device.openVRDeviceIndex] = nSlotPlusOne;
+		m_deviceSlotByDeviceId[device.deviceId] = nSlotPlusOne;
+	}
+	m_TrackedDevices.pop_back();
+}
 
-	std::sort( sortedDeviceIds.begin(), sortedDeviceIds.end() ); //wasn't necessarily sorted. 
+void OpenVRInputProvider::RemoveAllTrackedDevices()
+{
+	m_TrackedDevices.clear();
+	memset( m_deviceSlotByOpenVRIndex, 0, sizeof( m_deviceSlotByOpenVRIndex ) );
+	memset( m_deviceSlotByDeviceId, 0, sizeof( m_deviceSlotByDeviceId ) );
+	m_nUsedDeviceIds = 0;
+}
 
-	UnityXRInternalInputDeviceId uniqueId = 0;
-	for ( auto deviceId : sortedDeviceIds )
+void OpenVRInputProvider::GfxThread_UpdateTopology( TrackedPoseSnapshot &snapshot )
+{
+	// With the native event pump only the devices named by events are queried, everything is rescanned at start,
+	// when an event can affect any device and on a slow timer in case an event was missed
+	bool bRescanAll = true;
+	uint64_t nDirtyMask = ~0ull;
+	if ( UserProjectSettings::GetNativeEventPumpEnabled() )
 	{
-		if ( deviceId == uniqueId )
-			uniqueId++;
+		nDirtyMask = OpenVRSystem::Get().ConsumeTopologyChanges( bRescanAll );
+
+		uint64_t nNowNs = TimeDomain::GetNowNs();
+		if ( m_nLastTopologyRescanNs == 0 || nNowNs - m_nLastTopologyRescanNs >= k_nTopologyRescanIntervalNs )
+			bRescanAll = true;
+
+		if ( bRescanAll )
+		{
+			nDirtyMask = ~0ull;
+			m_nLastTopologyRescanNs = nNowNs;
+		}
+	}
+
+	uint32_t unNumCalls = 0;
+	bool bChanged = false;
+	for ( unsigned int openVRTrackedDeviceIndex = 0; openVRTrackedDeviceIndex < vr::k_unMaxTrackedDeviceCount; ++openVRTrackedDeviceIndex )
+	{
+		if ( ( nDirtyMask & ( 1ull << openVRTrackedDeviceIndex ) ) == 0 )
+			continue;
+
+		UnityXRInputDeviceCharacteristics characteristics = kUnityXRInputDeviceCharacteristicsNone;
+		unNumCalls++;
+		if ( OpenVRSystem::Get().GetSystem()->IsTrackedDeviceConnected( openVRTrackedDeviceIndex ) )
+		{
+			characteristics = GetCharacteristicsForDeviceIndex( openVRTrackedDeviceIndex, unNumCalls );
+		}
+
+		bChanged |= ( characteristics != m_gfxThreadCharacteristics[openVRTrackedDeviceIndex] );
+		m_gfxThreadCharacteristics[openVRTrackedDeviceIndex] = characteristics;
+	}
+
+	if ( bChanged )
+	{
+		m_nGfxThreadTopologyGeneration++;
+	}
+
+	m_unTopologyCallsLastFrame = unNumCalls;
+
+	memcpy( snapshot.characteristics, m_gfxThreadCharacteristics, sizeof( snapshot.characteristics ) );
+	snapshot.nTopologyGeneration = m_nGfxThreadTopologyGeneration;
+}
+
+// Called on the main thread once per frame, reads the controller state every device state update of the frame uses
+void OpenVRInputProvider::UpdateActionInput()
+{
+	// The paths are only looked at after one of the settings exports ran, and the action input only restarts if they differ
+	uint32_t nActionGeneration = UserProjectSettings::GetNativeActionGeneration();
+	const std::string &actionSetPath = UserProjectSettings::GetNativeActionSetPath();
+	std::string actionManifestPath;
+	bool bActionPathsChanged = false;
+	if ( nActionGeneration != m_nActionGeneration )
+	{
+		m_nActionGeneration = nActionGeneration;
+		actionManifestPath = actionSetPath.empty() ? std::string() : UserProjectSettings::GetNativeActionManifestPath();
+		bActionPathsChanged = ( actionSetPath != m_actionSetPath || actionManifestPath != m_actionManifestPath );
+	}
+
+	if ( bActionPathsChanged )
+	{
+		m_actionSetPath = actionSetPath;
+		m_actionManifestPath = actionManifestPath;
+		if ( m_actionSetPath.empty() )
+		{
+			m_actionInput = ActionInput();
+			m_handSkeleton = HandSkeleton();
+		}
 		else
-			break;
+		{
+			// The plugin owns input, so it's the one to hand the runtime the manifest the action set comes from
+			if ( !m_actionManifestPath.empty() && vr::VRInput() )
+			{
+				vr::EVRInputError eError = vr::VRInput()->SetActionManifestPath( m_actionManifestPath.c_str() );
+				if ( eError != vr::VRInputError_None )
+				{
+					XR_TRACE( "[OpenVR] [ERROR] SetActionManifestPath( %s ) failed: %d\n", m_actionManifestPath.c_str(), eError );
+				}
+			}
+
+			const char *actionNames[ActionInput::k_unMaxActions];
+			ActionInput::EActionType actionTypes[ActionInput::k_unMaxActions];
+			static_assert( sizeof( k_controllerFeatureActions ) / sizeof( k_controllerFeatureActions[0] ) <= ActionInput::k_unMaxActions, "Too many controller actions" );
+			for ( uint32_t unAction = 0; unAction < k_unNumControllerFeatureActions; ++unAction )
+			{
+				actionNames[unAction] = k_controllerFeatureActions[unAction].pchName;
+				actionTypes[unAction] = k_controllerFeatureActions[unAction].type == kUnityXRInputFeatureTypeBinary ? ActionInput::ActionType_Digital : ActionInput::ActionType_Analog;
+			}
+			m_actionInput.Initialize( m_actionSetPath.c_str(), actionNames, actionTypes, k_unNumControllerFeatureActions );
+			m_handSkeleton.Initialize( m_actionSetPath.c_str() );
+		}
 	}
 
-	return uniqueId;
+	if ( OpenVRSystem::Get().GetSystem() && OpenVRSystem::Get().GetSystem()->IsInputAvailable() )
+	{
+		m_actionInput.Update();
+		m_handSkeleton.Update();
+	}
 }
 
-void OpenVRInputProvider::GfxThread_UpdateConnectedDevices( const vr::TrackedDevicePose_t *currentDevicePoses )
+// Called on the main thread, the only thread that touches m_TrackedDevices
+void OpenVRInputProvider::UpdateConnectedDevices()
 {
+	if ( m_latchedPoses.nTopologyGeneration == m_nAppliedTopologyGeneration && !m_bTopologyPending )
+		return;
+
+	m_nAppliedTopologyGeneration = m_latchedPoses.nTopologyGeneration;
+	m_bTopologyPending = false;
+
 	for ( unsigned int openVRTrackedDeviceIndex = 0; openVRTrackedDeviceIndex < vr::k_unMaxTrackedDeviceCount; ++openVRTrackedDeviceIndex )
 	{
-		const bool isConnected = OpenVRSystem::Get().GetSystem()->IsTrackedDeviceConnected( openVRTrackedDeviceIndex );
+		UnityXRInputDeviceCharacteristics characteristics = m_latchedPoses.characteristics[openVRTrackedDeviceIndex];
 		auto existingDevice = GetTrackedDeviceByOpenVRIndex( openVRTrackedDeviceIndex );
 
-		if ( !isConnected )
+		if ( characteristics == kUnityXRInputDeviceCharacteristicsNone )
 		{
 			// Device was in list but is no longer tracked, mark for disconnect
 			if ( existingDevice )
@@ -912,48 +1120,69 @@ void OpenVRInputProvider::GfxThread_UpdateConnectedDevices( const vr::TrackedDev
 				XR_TRACE( "[OpenVR] Device disconnecting (disconnection reported). OpenVRIndex: %d. UnityID: %d\n", openVRTrackedDeviceIndex, ( *existingDevice )->deviceId );
 			}
 		}
-		else
+		else if ( !existingDevice )
 		{
 			// Device was not in list but is now tracked, add to tracked devices (is constructed marked for connect)
-			UnityXRInputDeviceCharacteristics characteristics = GetCharacteristicsForDeviceIndex( openVRTrackedDeviceIndex );
-			if ( !existingDevice )
-			{
-				if ( characteristics != kUnityXRInputDeviceCharacteristicsNone )
-				{
-					UnityXRInternalInputDeviceId newDeviceId = GenerateUniqueDeviceId();
-					m_TrackedDevices.emplace_back( openVRTrackedDeviceIndex, newDeviceId, characteristics );
-					XR_TRACE( "[OpenVR] Device connecting (status change). OpenVRIndex: %d. UnityID: %d\n", openVRTrackedDeviceIndex, newDeviceId );
-				}
-			}
-			else if ( ( *existingDevice )->characteristics != characteristics ) // Need to check to see if characteristics changed, if so disconnect and allow reconnection next frame
-			{
-				XR_TRACE( "[OpenVR] Device disconnecting (characteristics change). OpenVRIndex: %d. UnityID: %d\n", openVRTrackedDeviceIndex, ( *existingDevice )->deviceId );
-				( *existingDevice )->deviceChangeForNextUpdate = EDeviceStatus::Disconnect;
-			}
+			UnityXRInternalInputDeviceId newDeviceId = AddTrackedDevice( openVRTrackedDeviceIndex, characteristics ).deviceId;
+			XR_TRACE( "[OpenVR] Device connecting (status change). OpenVRIndex: %d. UnityID: %d\n", openVRTrackedDeviceIndex, newDeviceId );
+		}
+		else if ( ( *existingDevice )->characteristics != characteristics ) // Need to check to see if characteristics changed, if so disconnect and allow reconnection next frame
+		{
+			XR_TRACE( "[OpenVR] Device disconnecting (characteristics change). OpenVRIndex: %d. UnityID: %d\n", openVRTrackedDeviceIndex, ( *existingDevice )->deviceId );
+			( *existingDevice )->deviceChangeForNextUpdate = EDeviceStatus::Disconnect;
 		}
 	}
 }
 
-void OpenVRInputProvider::GfxThread_CopyPoses( const vr::TrackedDevicePose_t *currentDevicePoses, const vr::TrackedDevicePose_t *futureDevicePoses )
+// Called on the main thread at the start of every input update. Copying the newest snapshot here rather than reading
+// poses left behind at the graphics thread's sync point means the before render update always sees the latest WaitGetPoses result.
+void OpenVRInputProvider::LatchPoses( UnityXRInputUpdateType updateType )
 {
-	for ( auto &trackedDevice : m_TrackedDevices )
+	m_poseBuffer.Read( m_latchedPoses );
+
+	UpdateEyeToHeadTransforms();
+
+	// Every device state update of this snapshot reads from the batch, so each pose is converted once
+	if ( m_latchedPoses.nSequence != m_nConvertedPoseSequence )
 	{
-		trackedDevice.trackingPose[kUnityXRInputUpdateTypeDynamic] = futureDevicePoses[trackedDevice.openVRDeviceIndex];
-		trackedDevice.trackingPose[kUnityXRInputUpdateTypeBeforeRender] = currentDevicePoses[trackedDevice.openVRDeviceIndex];
+		ConvertPosesToUnity( m_latchedPoses.current, m_latchedUnityCurrent );
+		ConvertPosesToUnity( m_latchedPoses.future, m_latchedUnityFuture );
+		m_nConvertedPoseSequence = m_latchedPoses.nSequence;
 	}
+
+	if ( updateType != kUnityXRInputUpdateTypeBeforeRender )
+		return;
+
+	// Record the pose Unity renders the upcoming frame with, so it's the pose submitted alongside that frame
+	if ( m_latchedPoses.nSequence == 0 || m_latchedPoses.nSequence == m_nRenderPoseSequence )
+		return;
+
+	RenderPose &renderPose = m_renderPoseBuffer.BeginWrite();
+	renderPose.hmdPose = m_latchedPoses.current[vr::k_unTrackedDeviceIndex_Hmd];
+	renderPose.nSampleTimeNs = m_latchedPoses.nSampleTimeNs;
+	renderPose.nSequence = m_latchedPoses.nSequence;
+	m_renderPoseBuffer.Publish();
+
+	m_nRenderPoseSequence = m_latchedPoses.nSequence;
+}
+
+bool OpenVRInputProvider::GfxThread_GetRenderPose( RenderPose &renderPose )
+{
+	return m_renderPoseBuffer.Read( renderPose ) && renderPose.nSequence != 0;
 }
 
 // Called from the graphics thread in post-present to get connected devices and update poses.
-// The graphics thread will have a sync fence with the main loop, so thread synchronization is not further necessary.
+// The poses and device topology are published into m_poseBuffer, readers copy them out without ever waiting on this thread.
 void OpenVRInputProvider::GfxThread_UpdateDevices()
 {
 	if ( !m_Started )
 		return;
 
-	vr::TrackedDevicePose_t trackedDevicesCurrent[vr::k_unMaxTrackedDeviceCount];
-	vr::TrackedDevicePose_t trackedDevicesFuture[vr::k_unMaxTrackedDeviceCount];
+	const bool bIsOverlay = UserProjectSettings::GetInitializationType() == vr::VRApplication_Overlay;
+	float last_vsync_time = 0.0f;
+	vr::ETrackingUniverseOrigin trackingSpace = vr::TrackingUniverseStanding;
 
-	if ( UserProjectSettings::GetInitializationType() == vr::VRApplication_Overlay )
+	if ( bIsOverlay )
 	{
 		if ( OpenVRSystem::Get().GetOverlay() == nullptr )
 		{
@@ -968,25 +1197,89 @@ void OpenVRInputProvider::GfxThread_UpdateDevices()
 			return;
 		}
 
-		float last_vsync_time;
 		OpenVRSystem::Get().GetSystem()->GetTimeSinceLastVsync(&last_vsync_time, nullptr);
+	}
+	else if ( OpenVRSystem::Get().GetCompositor() == nullptr )
+	{
+		XR_TRACE( "[OpenVR] [ERROR] OpenVRSystem::Get().GetCompositor() returned nullptr.\n" );
+		return;
+	}
+	else
+	{
+		trackingSpace = OpenVRSystem::Get().GetCompositor()->GetTrackingSpace();
+	}
 
-		OpenVRSystem::Get().GetSystem()->GetDeviceToAbsoluteTrackingPose( vr::TrackingUniverseStanding, 0.0f, trackedDevicesCurrent, vr::k_unMaxTrackedDeviceCount );
-		OpenVRSystem::Get().GetSystem()->GetDeviceToAbsoluteTrackingPose( vr::TrackingUniverseStanding, last_vsync_time, trackedDevicesFuture, vr::k_unMaxTrackedDeviceCount );
+	// Poses are written straight into the slot, readers stay on the previously published one until Publish
+	TrackedPoseSnapshot &snapshot = m_poseBuffer.BeginWrite();
+
+	if ( bIsOverlay )
+	{
+		OpenVRSystem::Get().GetSystem()->GetDeviceToAbsoluteTrackingPose( vr::TrackingUniverseStanding, 0.0f, snapshot.current, vr::k_unMaxTrackedDeviceCount );
+		OpenVRSystem::Get().GetSystem()->GetDeviceToAbsoluteTrackingPose( vr::TrackingUniverseStanding, last_vsync_time, snapshot.future, vr::k_unMaxTrackedDeviceCount );
 	}
 	else
 	{
-		if ( OpenVRSystem::Get().GetCompositor() == nullptr )
-		{
-			XR_TRACE( "[OpenVR] [ERROR] OpenVRSystem::Get().GetCompositor() returned nullptr.\n" );
-			return;
-		}
+		OpenVRSystem::Get().GetCompositor()->WaitGetPoses( snapshot.current, vr::k_unMaxTrackedDeviceCount, snapshot.future, vr::k_unMaxTrackedDeviceCount );
+	}
+
+	snapshot.nSampleTimeNs = TimeDomain::GetNowNs();
+
+	// One float per frame lets the main thread re-read the eye to head transforms only when the IPD actually moves
+	vr::ETrackedPropertyError ipdError = vr::TrackedProp_Success;
+	snapshot.flUserIpdMeters = OpenVRSystem::Get().GetSystem()->GetFloatTrackedDeviceProperty( vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_UserIpdMeters_Float, &ipdError );
+	if ( ipdError != vr::TrackedProp_Success )
+	{
+		snapshot.flUserIpdMeters = 0.0f;
+	}
+	m_flGfxThreadUserIpd = snapshot.flUserIpdMeters;
 
-		OpenVRSystem::Get().GetCompositor()->WaitGetPoses( trackedDevicesCurrent, vr::k_unMaxTrackedDeviceCount, trackedDevicesFuture, vr::k_unMaxTrackedDeviceCount );
+	// Keep the vsync timeline in the same time base as the poses
+	float flSecondsSinceLastVsync = 0.0f;
+	bool bHaveVsync = OpenVRSystem::Get().GetSystem()->GetTimeSinceLastVsync( &flSecondsSinceLastVsync, nullptr );
+	if ( bHaveVsync )
+	{
+		TimeDomain::Get().RecordVsync( flSecondsSinceLastVsync, snapshot.nSampleTimeNs );
 	}
 
-	GfxThread_UpdateConnectedDevices( trackedDevicesCurrent );
-	GfxThread_CopyPoses( trackedDevicesCurrent, trackedDevicesFuture );
+	snapshot.nSequence = ++m_nPoseSequence;
+
+	GfxThread_UpdateTopology( snapshot );
+	m_poseBuffer.Publish();
+
+	if ( trackingSpace != m_eHistoryOrigin )
+	{
+		m_poseHistory.Invalidate();
+		m_eHistoryOrigin = trackingSpace;
+	}
+
+	// The history takes the poses already in hand rather than asking the runtime again. The overlay's current poses have
+	// no prediction. WaitGetPoses returns at running start, just before a vsync, and the frame rendered with its poses
+	// is scanned out one vsync after that.
+	uint64_t nPoseTimeNs = snapshot.nSampleTimeNs;
+	if ( !bIsOverlay && bHaveVsync )
+	{
+		GfxThread_UpdateDisplayTiming( snapshot.nSampleTimeNs );
+		float flSecondsToNextVsync = std::max( m_flGfxThreadFrameDuration - flSecondsSinceLastVsync, 0.0f );
+		float flSecondsToPhotons = flSecondsToNextVsync + m_flGfxThreadFrameDuration + m_flGfxThreadVsyncToPhotons;
+		nPoseTimeNs += (uint64_t )( flSecondsToPhotons * 1e9f );
+	}
+	m_poseHistory.Record( snapshot.current, nPoseTimeNs );
+}
+
+void OpenVRInputProvider::GfxThread_UpdateDisplayTiming( uint64_t nNowNs )
+{
+	// Only changes with the refresh rate or the HMD, so it's read on the topology rescan timer rather than every frame
+	if ( m_nLastDisplayTimingRefreshNs != 0 && nNowNs - m_nLastDisplayTimingRefreshNs < k_nTopologyRescanIntervalNs )
+		return;
+
+	m_nLastDisplayTimingRefreshNs = nNowNs;
+
+	vr::ETrackedPropertyError error = vr::TrackedProp_Success;
+	float flDisplayFrequency = OpenVRSystem::Get().GetSystem()->GetFloatTrackedDeviceProperty( vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float, &error );
+	m_flGfxThreadFrameDuration = ( error == vr::TrackedProp_Success && flDisplayFrequency > 0.0f ) ? 1.0f / flDisplayFrequency : 0.0f;
+
+	float flVsyncToPhotons = OpenVRSystem::Get().GetSystem()->GetFloatTrackedDeviceProperty( vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_SecondsFromVsyncToPhotons_Float, &error );
+	m_flGfxThreadVsyncToPhotons = ( error == vr::TrackedProp_Success && flVsyncToPhotons > 0.0f ) ? flVsyncToPhotons : 0.0f;
 }
 
 UnitySubsystemErrorCode OpenVRInputProvider::Start()
@@ -1000,16 +1293,15 @@ void OpenVRInputProvider::Stop( UnitySubsystemHandle handle )
 {
 	m_Started = false;
 
-	for ( auto deviceIter = m_TrackedDevices.begin(); deviceIter != m_TrackedDevices.end(); )
+	for ( auto &device : m_TrackedDevices )
 	{
-		if ( deviceIter->deviceStatus == EDeviceStatus::Connect )
+		if ( device.deviceStatus == EDeviceStatus::Connect )
 		{
-			XR_TRACE( "[OpenVR] Device disconnected (stopping provider). Handle: %d. DeviceID: %d\n", handle, deviceIter->deviceId );
-			s_Input->InputSubsystem_DeviceDisconnected( handle, deviceIter->deviceId );
+			XR_TRACE( "[OpenVR] Device disconnected (stopping provider). Handle: %d. DeviceID: %d\n", handle, device.deviceId );
+			s_Input->InputSubsystem_DeviceDisconnected( handle, device.deviceId );
 		}
-		deviceIter = m_TrackedDevices.erase( deviceIter );
 	}
-	m_TrackedDevices.clear();
+	RemoveAllTrackedDevices();
 }
 
 UnitySubsystemErrorCode UNITY_INTERFACE_API Lifecycle_Initialize( UnitySubsystemHandle handle, void *userData )
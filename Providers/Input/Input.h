@@ -7,6 +7,12 @@
 
 #include "OpenVRSystem.h"
 #include "OpenVRProviderContext.h"
+#include "PoseBuffer.h"
+#include "PoseHistory.h"
+#include "PoseConversion.h"
+#include "DevicePropertyCache.h"
+#include "ActionInput.h"
+#include "HandSkeleton.h"
 
 #include "Singleton.h"
 #include "CommonTypes.h"
@@ -42,6 +48,17 @@ public:
 
 	void GfxThread_UpdateDevices();
 
+	/// Get the HMD pose the main thread last handed to Unity for rendering, must be called on the graphics thread
+	/// @param[out] RenderPose& renderPose - The pose and when it was sampled
+	/// @return bool - false if no frame has been rendered with a pose yet
+	bool GfxThread_GetRenderPose( RenderPose &renderPose );
+
+	/// Number of runtime calls the last device topology update made, must be called on the graphics thread
+	uint32_t GfxThread_GetTopologyCallsPerFrame() const { return m_unTopologyCallsLastFrame; }
+
+	/// User IPD in meters recorded with the last pose snapshot, 0 if the runtime didn't report one. Must be called on the graphics thread
+	float GfxThread_GetUserIpd() const { return m_flGfxThreadUserIpd; }
+
 private:
 
 	enum class EDeviceStatus
@@ -147,10 +164,29 @@ private:
 
 	ControllerInputProfile controllerInputProfile = ControllerInputProfile::Undefined;
 
+	/// Controller features read from IVRInput actions, in the order they're added to handed controllers
+	struct ControllerFeatureAction
+	{
+		ControllerFeature feature;
+		const char *pchName;
+		UnityXRInputFeatureType type;
+		UnityXRInputFeatureUsage usage;
+	};
+	static const ControllerFeatureAction k_controllerFeatureActions[];
+	static const uint32_t k_unNumControllerFeatureActions;
+
+	/// Native controller state, initialized from the action set and manifest paths in UserProjectSettings.
+	/// Initialized again only when UserProjectSettings::GetNativeActionGeneration moves past m_nActionGeneration.
+	ActionInput m_actionInput;
+	HandSkeleton m_handSkeleton;
+	std::string m_actionSetPath;
+	std::string m_actionManifestPath;
+	uint32_t m_nActionGeneration = 0;
+	void UpdateActionInput();
+
 	static int hmdFeatureIndices[static_cast< int >( HMDFeature::Total )];
 	static int controllerFeatureIndices[static_cast< int >( ControllerFeature::Total )];
 	static int trackerFeatureIndices[static_cast< int >( TrackerFeature::Total )];
-	static const int kUnityXRInputUpdateTypeCount = 2;
 	bool m_Started = false;
 	vr::EVROverlayError overlayError = vr::EVROverlayError::VROverlayError_None;
 
@@ -161,7 +197,13 @@ private:
 		UnityXRInputDeviceCharacteristics characteristics = kUnityXRInputDeviceCharacteristicsNone;
 		EDeviceStatus deviceStatus = EDeviceStatus::None;
 		EDeviceStatus deviceChangeForNextUpdate = EDeviceStatus::None;
-		vr::TrackedDevicePose_t trackingPose[kUnityXRInputUpdateTypeCount];
+
+		/// If the definition includes the buttons and axes read from IVRInput actions
+		bool bHasActionFeatures = false;
+
+		/// Hand feature and the first of its HandSkeleton::k_unNumUnityBones bone features, invalid without a skeleton
+		UnityXRInputFeatureIndex handFeatureIndex = kUnityInvalidXRInputFeatureIndex;
+		UnityXRInputFeatureIndex firstBoneFeatureIndex = kUnityInvalidXRInputFeatureIndex;
 
 		OpenVRDevice( vr::TrackedDeviceIndex_t index, UnityXRInternalInputDeviceId id, UnityXRInputDeviceCharacteristics characteristics )
 			: deviceId( id )
@@ -169,42 +211,107 @@ private:
 			, characteristics( characteristics )
 			, deviceStatus( EDeviceStatus::None )
 			, deviceChangeForNextUpdate( EDeviceStatus::Connect )
-			, trackingPose()
 		{
 		}
 
-		std::optional<std::string> GetDeviceName() const;
+		/// Longest device name, the longest prefix and suffix around a model number or a model and serial number of full length.
+		/// Unity matches devices by name, so names must never be cut short.
+		static const size_t k_unMaxDeviceNameSize = 2 * kUnityXRStringSize + 32;
+
+		/// Compose the name the device is shown with in Unity
+		/// @param[in] const DeviceProperties& properties - The device's cached properties
+		/// @param[out] char(&deviceName)[k_unMaxDeviceNameSize] - The name
+		/// @return bool - false if the properties the name is made of are missing
+		bool GetDeviceName( const DeviceProperties &properties, char ( &deviceName )[k_unMaxDeviceNameSize] ) const;
 	};
 
+	/// Devices known to Unity, only ever touched on the main thread. There's at most one entry per OpenVR index, so the
+	/// vector never grows past vr::k_unMaxTrackedDeviceCount and is reserved up front. Order isn't stable, removing a
+	/// device moves the last one into its slot.
 	std::vector<OpenVRInputProvider::OpenVRDevice> m_TrackedDevices;
 
+	/// Slot in m_TrackedDevices plus one for every OpenVR index and device id, 0 if there's no device
+	uint8_t m_deviceSlotByOpenVRIndex[vr::k_unMaxTrackedDeviceCount] = {};
+	uint8_t m_deviceSlotByDeviceId[vr::k_unMaxTrackedDeviceCount] = {};
+
+	/// String properties of the devices, fetched once per OpenVR index
+	DevicePropertyCache m_propertyCache;
+
+	/// Bit per device id handed out to Unity, ids are the lowest free bit so they stay below vr::k_unMaxTrackedDeviceCount
+	uint64_t m_nUsedDeviceIds = 0;
+
+	/// Poses and topology published by the graphics thread after WaitGetPoses
+	TripleBuffer< TrackedPoseSnapshot > m_poseBuffer;
+
+	/// Graphics thread side of m_poseBuffer: last sequence, topology and topology generation
+	uint64_t m_nPoseSequence = 0;
+	UnityXRInputDeviceCharacteristics m_gfxThreadCharacteristics[vr::k_unMaxTrackedDeviceCount] = {};
+	uint64_t m_nGfxThreadTopologyGeneration = 0;
+
+	/// Time of the last full topology rescan and runtime calls the last topology update made (graphics thread)
+	static const uint64_t k_nTopologyRescanIntervalNs = 2000000000ull;
+	uint64_t m_nLastTopologyRescanNs = 0;
+	uint32_t m_unTopologyCallsLastFrame = 0;
+	float m_flGfxThreadUserIpd = 0.0f;
+
+	/// HMD frame duration and vsync to photons latency in seconds, used to timestamp m_poseHistory (graphics thread)
+	float m_flGfxThreadFrameDuration = 0.0f;
+	float m_flGfxThreadVsyncToPhotons = 0.0f;
+	uint64_t m_nLastDisplayTimingRefreshNs = 0;
+
+	/// Main thread side of m_poseBuffer: the snapshot copied at the start of the current input update
+	TrackedPoseSnapshot m_latchedPoses = {};
+
+	/// m_latchedPoses converted to Unity tracking space in one batch whenever a new snapshot is latched
+	UnityDevicePoses m_latchedUnityCurrent = {};
+	UnityDevicePoses m_latchedUnityFuture = {};
+	uint64_t m_nConvertedPoseSequence = 0;
+
+	/// Eye to head transforms in Unity space, indexed by EHMDEye. Read again when the IPD of the latched snapshot differs
+	/// from the one they were read at, or when the native event pump sees VREvent_IpdChanged.
+	UnityXRVector3 m_eyeToHeadPositions[2] = {};
+	UnityXRVector4 m_eyeToHeadRotations[2] = {};
+	float m_flEyeToHeadIpd = 0.0f;
+	bool m_bEyeToHeadValid = false;
+	void UpdateEyeToHeadTransforms();
+
+	/// Topology generation m_TrackedDevices was last reconciled with, and whether it needs another pass regardless
+	uint64_t m_nAppliedTopologyGeneration = 0;
+	bool m_bTopologyPending = false;
+
+	/// Render poses of every WaitGetPoses at their predicted display time, answers TryGetDeviceStateAtTime for past timestamps
+	PoseHistory m_poseHistory;
+
+	/// Tracking space m_poseHistory was recorded in (graphics thread)
+	vr::ETrackingUniverseOrigin m_eHistoryOrigin = vr::TrackingUniverseRawAndUncalibrated;
+
+	/// HMD poses handed to Unity for rendering, published by the main thread and read by the graphics thread at submit
+	TripleBuffer< RenderPose > m_renderPoseBuffer;
+	uint64_t m_nRenderPoseSequence = 0;
+
 	inline std::optional<OpenVRDevice *> GetTrackedDeviceByDeviceId( UnityXRInternalInputDeviceId id )
 	{
-		for ( auto &trackedDevice : m_TrackedDevices )
-		{
-			if ( trackedDevice.deviceId == id )
-				return { &trackedDevice };
-		}
-		return std::nullopt;
+		if ( id >= vr::k_unMaxTrackedDeviceCount || m_deviceSlotByDeviceId[id] == 0 )
+			return std::nullopt;
+		return { &m_TrackedDevices[m_deviceSlotByDeviceId[id] - 1] };
 	}
 	inline std::optional<OpenVRDevice *> GetTrackedDeviceByOpenVRIndex( vr::TrackedDeviceIndex_t idx )
 	{
-		for ( auto &trackedDevice : m_TrackedDevices )
-		{
-			if ( trackedDevice.openVRDeviceIndex == idx )
-				return { &trackedDevice };
-		}
-		return std::nullopt;
+		if ( idx >= vr::k_unMaxTrackedDeviceCount || m_deviceSlotByOpenVRIndex[idx] == 0 )
+			return std::nullopt;
+		return { &m_TrackedDevices[m_deviceSlotByOpenVRIndex[idx] - 1] };
 	}
 
 	UnitySubsystemErrorCode SendControllerHapticImpulse( UnityXRInternalInputDeviceId deviceId, int channel, float amplitude, float duration );
 	UnitySubsystemErrorCode GetHapticCapabilities( UnityXRInternalInputDeviceId deviceId, UnityXRHapticCapabilities *capabilities );
 	UnityXRInternalInputDeviceId GenerateUniqueDeviceId() const;
-	void GfxThread_UpdateConnectedDevices( const vr::TrackedDevicePose_t *currentDevicePoses );
-	static UnityXRMatrix4x4 GetEyeTransform( EHMDEye eye );
+	OpenVRDevice &AddTrackedDevice( vr::TrackedDeviceIndex_t openVRDeviceIndex, UnityXRInputDeviceCharacteristics characteristics );
+	void RemoveTrackedDevice( size_t nSlot );
+	void RemoveAllTrackedDevices();
+	void GfxThread_UpdateTopology( TrackedPoseSnapshot &snapshot );
+	void GfxThread_UpdateDisplayTiming( uint64_t nNowNs );
+	void UpdateConnectedDevices();
 	UnitySubsystemErrorCode Internal_UpdateDeviceState( UnitySubsystemHandle handle, const OpenVRDevice &device,
-		const vr::TrackedDevicePose_t &trackingPose, UnityXRInputDeviceState *deviceState, bool updateNonTrackingData );
-	static void OpenVRToUnityTracking( const vr::TrackedDevicePose_t &openVRPose, std::optional<UnityXRMatrix4x4> postTransform,
-		UnityXRVector3 &outPosition, UnityXRVector4 &outRotation, UnityXRVector3 &outVelocity, UnityXRVector3 &outAngularVelocity );
-	void GfxThread_CopyPoses( const vr::TrackedDevicePose_t *currentDevicePoses, const vr::TrackedDevicePose_t *futureDevicePoses );
+		const vr::TrackedDevicePose_t &trackingPose, const UnityDevicePose &unityPose, UnityXRInputDeviceState *deviceState, bool updateNonTrackingData );
+	void LatchPoses( UnityXRInputUpdateType updateType );
 };
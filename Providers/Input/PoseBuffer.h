@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+#include "OpenVR/openvr.h"
+#include "ProviderInterface/IUnityXRInput.h"
+
+/// Lock-free triple buffer between one writer and any number of readers. The writer fills a slot and publishes it,
+/// readers copy out the most recently published slot. Every slot carries a sequence counter (seqlock) that is odd
+/// while the writer is inside it, so a reader that raced the writer retries instead of returning a torn value.
+/// With three slots the writer is always two publishes away from the slot readers are directed to, so retries
+/// only happen when a reader stalls for more than a whole frame. Nobody ever waits on a lock.
+template< typename T >
+class TripleBuffer
+{
+	static_assert( std::is_trivially_copyable< T >::value, "TripleBuffer values are copied with memcpy" );
+
+public:
+	/// Writer: start filling the next slot, readers that still copy from it will retry
+	/// @return T& - The slot to fill before calling Publish
+	T &BeginWrite()
+	{
+		Slot &slot = m_slots[m_nWriteIndex];
+		slot.nSequence.store( slot.nSequence.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_release );
+		return slot.value;
+	}
+
+	/// Writer: finish the slot started with BeginWrite and direct readers to it
+	void Publish()
+	{
+		Slot &slot = m_slots[m_nWriteIndex];
+		slot.nSequence.store( slot.nSequence.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+		m_nPublishedIndex.store( m_nWriteIndex, std::memory_order_release );
+		m_nWriteIndex = ( m_nWriteIndex + 1 ) % k_nNumSlots;
+	}
+
+	/// Reader: copy the most recently published value
+	/// @param[out] T& value - The value, untouched if nothing has been published yet
+	/// @return bool - false if nothing has been published yet
+	bool Read( T &value ) const
+	{
+		for ( ;; )
+		{
+			int nIndex = m_nPublishedIndex.load( std::memory_order_acquire );
+			if ( nIndex < 0 )
+				return false;
+
+			const Slot &slot = m_slots[nIndex];
+			uint32_t nSequence = slot.nSequence.load( std::memory_order_acquire );
+			if ( nSequence & 1 )
+				continue;
+
+			memcpy( &value, &slot.value, sizeof( T ) );
+			std::atomic_thread_fence( std::memory_order_acquire );
+
+			if ( slot.nSequence.load( std::memory_order_relaxed ) == nSequence )
+				return true;
+		}
+	}
+
+private:
+	static const int k_nNumSlots = 3;
+
+	struct Slot
+	{
+		std::atomic< uint32_t > nSequence{ 0 };
+		T value = {};
+	};
+
+	Slot m_slots[k_nNumSlots];
+	int m_nWriteIndex = 0;
+	std::atomic< int > m_nPublishedIndex{ -1 };
+};
+
+/// Poses and device topology from one IVRCompositor::WaitGetPoses call
+struct TrackedPoseSnapshot
+{
+	/// Poses for the frame about to be rendered (used by the before render update)
+	vr::TrackedDevicePose_t current[vr::k_unMaxTrackedDeviceCount];
+
+	/// Poses predicted for the frame after (used by the dynamic update)
+	vr::TrackedDevicePose_t future[vr::k_unMaxTrackedDeviceCount];
+
+	/// Characteristics of the device at each OpenVR index, kUnityXRInputDeviceCharacteristicsNone if there's no device Unity should see
+	UnityXRInputDeviceCharacteristics characteristics[vr::k_unMaxTrackedDeviceCount];
+
+	/// Incremented whenever characteristics changed, readers only reconcile their device list when it moves
+	uint64_t nTopologyGeneration;
+
+	/// std::chrono::steady_clock time the poses were received, in nanoseconds
+	uint64_t nSampleTimeNs;
+
+	/// Prop_UserIpdMeters_Float of the HMD when the poses were received, 0 if unavailable
+	float flUserIpdMeters;
+
+	/// Incremented with every snapshot, 0 means no poses yet
+	uint64_t nSequence;
+};
+
+/// HMD pose the main thread handed to Unity for rendering a frame
+struct RenderPose
+{
+	/// The HMD pose in OpenVR tracking space
+	vr::TrackedDevicePose_t hmdPose;
+
+	/// Sample time and sequence of the snapshot the pose came from
+	uint64_t nSampleTimeNs;
+	uint64_t nSequence;
+};
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cmath>
+
+#include "PoseConversion.h"
+
+#if defined( _M_X64 ) || defined( __SSE2__ )
+#define POSE_CONVERSION_SSE 1
+#include <emmintrin.h>
+#endif
+
+
+void UnityDevicePoses::Get( vr::TrackedDeviceIndex_t unDeviceIndex, UnityDevicePose &pose ) const
+{
+	pose.position = { positionX[unDeviceIndex], positionY[unDeviceIndex], positionZ[unDeviceIndex] };
+	pose.rotation = { rotationX[unDeviceIndex], rotationY[unDeviceIndex], rotationZ[unDeviceIndex], rotationW[unDeviceIndex] };
+	pose.velocity = { velocityX[unDeviceIndex], velocityY[unDeviceIndex], velocityZ[unDeviceIndex] };
+	pose.angularVelocity = { angularVelocityX[unDeviceIndex], angularVelocityY[unDeviceIndex], angularVelocityZ[unDeviceIndex] };
+}
+
+// Unity's tracking space is OpenVR's with the z axis mirrored, so with S = diag( 1, 1, -1 ) the Unity rotation is S * R * S
+// and every element that touches row or column 2 (but not both) changes sign. Rather than building that matrix, the
+// quaternion is extracted directly from the OpenVR elements. As in MatrixToQuaternion the largest component comes from
+// its diagonal combination (4 * c^2, the four add up to 4) and the other three from off diagonal sums and differences,
+// which keeps full precision for every rotation. The result is negated where needed so that w <= 0.
+void ConvertTransformToUnity( const vr::HmdMatrix34_t &openVRTransform, UnityXRVector3 &position, UnityXRVector4 &rotation )
+{
+	const float( &m )[3][4] = openVRTransform.m;
+
+	position.x = m[0][3];
+	position.y = m[1][3];
+	position.z = -m[2][3];
+
+	// Squares of the components times 4
+	const float fSquareW = 1.0f + m[0][0] + m[1][1] + m[2][2];
+	const float fSquareX = 1.0f + m[0][0] - m[1][1] - m[2][2];
+	const float fSquareY = 1.0f - m[0][0] + m[1][1] - m[2][2];
+	const float fSquareZ = 1.0f - m[0][0] - m[1][1] + m[2][2];
+
+	// Off diagonal terms of the Unity space matrix
+	const float fDiffX = m[1][2] - m[2][1];
+	const float fDiffY = m[2][0] - m[0][2];
+	const float fDiffZ = m[1][0] - m[0][1];
+	const float fSumXY = m[0][1] + m[1][0];
+	const float fSumXZ = -( m[0][2] + m[2][0] );
+	const float fSumYZ = -( m[1][2] + m[2][1] );
+
+	float x, y, z, w;
+	if ( fSquareW >= fSquareX && fSquareW >= fSquareY && fSquareW >= fSquareZ )
+	{
+		const float fRoot = std::sqrt( fSquareW ), fScale = 0.5f / fRoot;
+		w = 0.5f * fRoot; x = fDiffX * fScale; y = fDiffY * fScale; z = fDiffZ * fScale;
+	}
+	else if ( fSquareX >= fSquareY && fSquareX >= fSquareZ )
+	{
+		const float fRoot = std::sqrt( fSquareX ), fScale = 0.5f / fRoot;
+		x = 0.5f * fRoot; y = fSumXY * fScale; z = fSumXZ * fScale; w = fDiffX * fScale;
+	}
+	else if ( fSquareY >= fSquareZ )
+	{
+		const float fRoot = std::sqrt( fSquareY ), fScale = 0.5f / fRoot;
+		y = 0.5f * fRoot; x = fSumXY * fScale; z = fSumYZ * fScale; w = fDiffY * fScale;
+	}
+	else
+	{
+		const float fRoot = std::sqrt( fSquareZ ), fScale = 0.5f / fRoot;
+		z = 0.5f * fRoot; x = fSumXZ * fScale; y = fSumYZ * fScale; w = fDiffZ * fScale;
+	}
+
+	const float fSign = w > 0.0f ? -1.0f : 1.0f;
+	rotation.x = x * fSign;
+	rotation.y = y * fSign;
+	rotation.z = z * fSign;
+	rotation.w = w * fSign;
+}
+
+void ConvertPoseToUnity( const vr::TrackedDevicePose_t &openVRPose, UnityDevicePose &pose )
+{
+	ConvertTransformToUnity( openVRPose.mDeviceToAbsoluteTracking, pose.position, pose.rotation );
+
+	pose.velocity.x = openVRPose.vVelocity.v[0];
+	pose.velocity.y = openVRPose.vVelocity.v[1];
+	pose.velocity.z = -openVRPose.vVelocity.v[2];
+
+	pose.angularVelocity.x = openVRPose.vAngularVelocity.v[0];
+	pose.angularVelocity.y = openVRPose.vAngularVelocity.v[1];
+	pose.angularVelocity.z = -openVRPose.vAngularVelocity.v[2];
+}
+
+void ComposeRigidTransforms( const UnityXRVector3 &parentPosition, const UnityXRVector4 &parentRotation,
+	const UnityXRVector3 &localPosition, const UnityXRVector4 &localRotation, UnityXRVector3 &position, UnityXRVector4 &rotation )
+{
+	const float qx = parentRotation.x, qy = parentRotation.y, qz = parentRotation.z, qw = parentRotation.w;
+
+	// v' = v + w * t + q.xyz x t with t = 2 * ( q.xyz x v ), the same for q and -q
+	const float tx = 2.0f * ( qy * localPosition.z - qz * localPosition.y );
+	const float ty = 2.0f * ( qz * localPosition.x - qx * localPosition.z );
+	const float tz = 2.0f * ( qx * localPosition.y - qy * localPosition.x );
+	position.x = parentPosition.x + localPosition.x + qw * tx + ( qy * tz - qz * ty );
+	position.y = parentPosition.y + localPosition.y + qw * ty + ( qz * tx - qx * tz );
+	position.z = parentPosition.z + localPosition.z + qw * tz + ( qx * ty - qy * tx );
+
+	const float lx = localRotation.x, ly = localRotation.y, lz = localRotation.z, lw = localRotation.w;
+	rotation.x = qw * lx + qx * lw + qy * lz - qz * ly;
+	rotation.y = qw * ly + qy * lw + qz * lx - qx * lz;
+	rotation.z = qw * lz + qz * lw + qx * ly - qy * lx;
+	rotation.w = qw * lw - qx * lx - qy * ly - qz * lz;
+}
+
+#if POSE_CONVERSION_SSE
+
+// Lanes 0..3 from four consecutive poses
+#define GATHER4( member ) _mm_setr_ps( p[0].member, p[1].member, p[2].member, p[3].member )
+
+static inline __m128 Select( __m128 mask, __m128 a, __m128 b )
+{
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+
+void ConvertPosesToUnity( const vr::TrackedDevicePose_t *pOpenVRPoses, UnityDevicePoses &poses )
+{
+	static_assert( vr::k_unMaxTrackedDeviceCount % 4 == 0, "Poses are converted four at a time" );
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 half = _mm_set1_ps( 0.5f );
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 signMask = _mm_set1_ps( -0.0f );
+	const __m128 allBits = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+
+	for ( uint32_t unIndex = 0; unIndex < vr::k_unMaxTrackedDeviceCount; unIndex += 4 )
+	{
+		const vr::TrackedDevicePose_t *p = pOpenVRPoses + unIndex;
+
+		_mm_store_ps( &poses.positionX[unIndex], GATHER4( mDeviceToAbsoluteTracking.m[0][3] ) );
+		_mm_store_ps( &poses.positionY[unIndex], GATHER4( mDeviceToAbsoluteTracking.m[1][3] ) );
+		_mm_store_ps( &poses.positionZ[unIndex], _mm_xor_ps( signMask, GATHER4( mDeviceToAbsoluteTracking.m[2][3] ) ) );
+
+		const __m128 m00 = GATHER4( mDeviceToAbsoluteTracking.m[0][0] );
+		const __m128 m11 = GATHER4( mDeviceToAbsoluteTracking.m[1][1] );
+		const __m128 m22 = GATHER4( mDeviceToAbsoluteTracking.m[2][2] );
+		const __m128 m01 = GATHER4( mDeviceToAbsoluteTracking.m[0][1] );
+		const __m128 m02 = GATHER4( mDeviceToAbsoluteTracking.m[0][2] );
+		const __m128 m10 = GATHER4( mDeviceToAbsoluteTracking.m[1][0] );
+		const __m128 m12 = GATHER4( mDeviceToAbsoluteTracking.m[1][2] );
+		const __m128 m20 = GATHER4( mDeviceToAbsoluteTracking.m[2][0] );
+		const __m128 m21 = GATHER4( mDeviceToAbsoluteTracking.m[2][1] );
+
+		const __m128 squareW = _mm_add_ps( _mm_add_ps( _mm_add_ps( one, m00 ), m11 ), m22 );
+		const __m128 squareX = _mm_sub_ps( _mm_sub_ps( _mm_add_ps( one, m00 ), m11 ), m22 );
+		const __m128 squareY = _mm_sub_ps( _mm_add_ps( _mm_sub_ps( one, m00 ), m11 ), m22 );
+		const __m128 squareZ = _mm_add_ps( _mm_sub_ps( _mm_sub_ps( one, m00 ), m11 ), m22 );
+
+		const __m128 diffX = _mm_sub_ps( m12, m21 );
+		const __m128 diffY = _mm_sub_ps( m20, m02 );
+		const __m128 diffZ = _mm_sub_ps( m10, m01 );
+		const __m128 sumXY = _mm_add_ps( m01, m10 );
+		const __m128 sumXZ = _mm_xor_ps( signMask, _mm_add_ps( m02, m20 ) );
+		const __m128 sumYZ = _mm_xor_ps( signMask, _mm_add_ps( m12, m21 ) );
+
+		// Same choice of the largest component as the scalar path, as lane masks
+		const __m128 isW = _mm_and_ps( _mm_cmpge_ps( squareW, squareX ), _mm_and_ps( _mm_cmpge_ps( squareW, squareY ), _mm_cmpge_ps( squareW, squareZ ) ) );
+		const __m128 isX = _mm_andnot_ps( isW, _mm_and_ps( _mm_cmpge_ps( squareX, squareY ), _mm_cmpge_ps( squareX, squareZ ) ) );
+		const __m128 isY = _mm_andnot_ps( _mm_or_ps( isW, isX ), _mm_cmpge_ps( squareY, squareZ ) );
+		const __m128 isZ = _mm_andnot_ps( _mm_or_ps( _mm_or_ps( isW, isX ), isY ), allBits );
+
+		// The largest square is at least 1, the four add up to 4
+		const __m128 root = _mm_sqrt_ps( Select( isW, squareW, Select( isX, squareX, Select( isY, squareY, squareZ ) ) ) );
+		const __m128 largest = _mm_mul_ps( half, root );
+		const __m128 scale = _mm_div_ps( half, root );
+
+		const __m128 x = Select( isX, largest, _mm_mul_ps( Select( isW, diffX, Select( isY, sumXY, sumXZ ) ), scale ) );
+		const __m128 y = Select( isY, largest, _mm_mul_ps( Select( isW, diffY, Select( isX, sumXY, sumYZ ) ), scale ) );
+		const __m128 z = Select( isZ, largest, _mm_mul_ps( Select( isW, diffZ, Select( isX, sumXZ, sumYZ ) ), scale ) );
+		const __m128 w = Select( isW, largest, _mm_mul_ps( Select( isX, diffX, Select( isY, diffY, diffZ ) ), scale ) );
+
+		// Negate where w > 0
+		const __m128 flip = _mm_and_ps( _mm_cmpgt_ps( w, zero ), signMask );
+		_mm_store_ps( &poses.rotationX[unIndex], _mm_xor_ps( x, flip ) );
+		_mm_store_ps( &poses.rotationY[unIndex], _mm_xor_ps( y, flip ) );
+		_mm_store_ps( &poses.rotationZ[unIndex], _mm_xor_ps( z, flip ) );
+		_mm_store_ps( &poses.rotationW[unIndex], _mm_xor_ps( w, flip ) );
+
+		_mm_store_ps( &poses.velocityX[unIndex], GATHER4( vVelocity.v[0] ) );
+		_mm_store_ps( &poses.velocityY[unIndex], GATHER4( vVelocity.v[1] ) );
+		_mm_store_ps( &poses.velocityZ[unIndex], _mm_xor_ps( signMask, GATHER4( vVelocity.v[2] ) ) );
+
+		_mm_store_ps( &poses.angularVelocityX[unIndex], GATHER4( vAngularVelocity.v[0] ) );
+		_mm_store_ps( &poses.angularVelocityY[unIndex], GATHER4( vAngularVelocity.v[1] ) );
+		_mm_store_ps( &poses.angularVelocityZ[unIndex], _mm_xor_ps( signMask, GATHER4( vAngularVelocity.v[2] ) ) );
+	}
+}
+
+#undef GATHER4
+
+#else
+
+void ConvertPosesToUnity( const vr::TrackedDevicePose_t *pOpenVRPoses, UnityDevicePoses &poses )
+{
+	UnityDevicePose pose;
+	for ( uint32_t unIndex = 0; unIndex < vr::k_unMaxTrackedDeviceCount; ++unIndex )
+	{
+		ConvertPoseToUnity( pOpenVRPoses[unIndex], pose );
+
+		poses.positionX[unIndex] = pose.position.x;
+		poses.positionY[unIndex] = pose.position.y;
+		poses.positionZ[unIndex] = pose.position.z;
+		poses.rotationX[unIndex] = pose.rotation.x;
+		poses.rotationY[unIndex] = pose.rotation.y;
+		poses.rotationZ[unIndex] = pose.rotation.z;
+		poses.rotationW[unIndex] = pose.rotation.w;
+		poses.velocityX[unIndex] = pose.velocity.x;
+		poses.velocityY[unIndex] = pose.velocity.y;
+		poses.velocityZ[unIndex] = pose.velocity.z;
+		poses.angularVelocityX[unIndex] = pose.angularVelocity.x;
+		poses.angularVelocityY[unIndex] = pose.angularVelocity.y;
+		poses.angularVelocityZ[unIndex] = pose.angularVelocity.z;
+	}
+}
+
+#endif
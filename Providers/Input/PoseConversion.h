@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "OpenVR/openvr.h"
+#include "ProviderInterface/UnityXRTypes.h"
+
+/// One device pose in Unity tracking space
+struct UnityDevicePose
+{
+	UnityXRVector3 position;
+	UnityXRVector4 rotation;
+	UnityXRVector3 velocity;
+	UnityXRVector3 angularVelocity;
+};
+
+/// Poses of every OpenVR device index in Unity tracking space, one array per component so the batch conversion
+/// can load and store whole SIMD registers
+struct UnityDevicePoses
+{
+	alignas( 16 ) float positionX[vr::k_unMaxTrackedDeviceCount];
+	alignas( 16 ) float positionY[vr::k_unMaxTrackedDeviceCount];
+	alignas( 16 ) float positionZ[vr::k_unMaxTrackedDeviceCount];
+	alignas( 16 ) float rotationX[vr::k_unMaxTrackedDeviceCount];
+	alignas( 16 ) float rotationY[vr::k_unMaxTrackedDeviceCount];
+	alignas( 16 ) float rotationZ[vr::k_unMaxTrackedDeviceCount];
+	alignas( 16 ) float rotationW[vr::k_unMaxTrackedDeviceCount];
+	alignas( 16 ) float velocityX[vr::k_unMaxTrackedDeviceCount];
+	alignas( 16 ) float velocityY[vr::k_unMaxTrackedDeviceCount];
+	alignas( 16 ) float velocityZ[vr::k_unMaxTrackedDeviceCount];
+	alignas( 16 ) float angularVelocityX[vr::k_unMaxTrackedDeviceCount];
+	alignas( 16 ) float angularVelocityY[vr::k_unMaxTrackedDeviceCount];
+	alignas( 16 ) float angularVelocityZ[vr::k_unMaxTrackedDeviceCount];
+
+	/// Gather the pose of one device
+	/// @param[in] vr::TrackedDeviceIndex_t unDeviceIndex - OpenVR device index
+	/// @param[out] UnityDevicePose& pose - The pose
+	void Get( vr::TrackedDeviceIndex_t unDeviceIndex, UnityDevicePose &pose ) const;
+};
+
+/// Convert an OpenVR rigid transform to Unity space, the z axis is mirrored and the rotation given with w <= 0
+/// @param[in] const vr::HmdMatrix34_t& openVRTransform - The transform from the runtime
+/// @param[out] UnityXRVector3& position - Translation in Unity space
+/// @param[out] UnityXRVector4& rotation - Rotation in Unity space
+void ConvertTransformToUnity( const vr::HmdMatrix34_t &openVRTransform, UnityXRVector3 &position, UnityXRVector4 &rotation );
+
+/// Place a transform given relative to a parent, i.e. the product parent * local of the two rigid transforms
+/// @param[in] const UnityXRVector3& parentPosition - Position of the parent
+/// @param[in] const UnityXRVector4& parentRotation - Rotation of the parent
+/// @param[in] const UnityXRVector3& localPosition - Position relative to the parent
+/// @param[in] const UnityXRVector4& localRotation - Rotation relative to the parent
+/// @param[out] UnityXRVector3& position - Position in the parent's space
+/// @param[out] UnityXRVector4& rotation - Rotation in the parent's space
+void ComposeRigidTransforms( const UnityXRVector3 &parentPosition, const UnityXRVector4 &parentRotation,
+	const UnityXRVector3 &localPosition, const UnityXRVector4 &localRotation, UnityXRVector3 &position, UnityXRVector4 &rotation );
+
+/// Convert one OpenVR pose to Unity tracking space, the transform as ConvertTransformToUnity does and the velocities mirrored along z
+/// @param[in] const vr::TrackedDevicePose_t& openVRPose - The pose from the runtime
+/// @param[out] UnityDevicePose& pose - The pose in Unity tracking space
+void ConvertPoseToUnity( const vr::TrackedDevicePose_t &openVRPose, UnityDevicePose &pose );
+
+/// Convert the poses of all devices in one pass, four at a time with SSE where available
+/// @param[in] const vr::TrackedDevicePose_t* pOpenVRPoses - k_unMaxTrackedDeviceCount poses from the runtime
+/// @param[out] UnityDevicePoses& poses - The poses in Unity tracking space
+void ConvertPosesToUnity( const vr::TrackedDevicePose_t *pOpenVRPoses, UnityDevicePoses &poses );
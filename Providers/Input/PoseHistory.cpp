@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "PoseHistory.h"
+#include "ProviderInterface/XRMath.h"
+
+namespace
+{
+	XRMatrix3x3 RotationToMatrix( const vr::HmdMatrix34_t &mat )
+	{
+		const float( *m )[4] = mat.m;
+		return XRMatrix3x3( m[0][0], m[0][1], m[0][2], m[1][0], m[1][1], m[1][2], m[2][0], m[2][1], m[2][2] );
+	}
+
+	XRQuaternion Slerp( const XRQuaternion &a, XRQuaternion b, float t )
+	{
+		// Take the short way around
+		float flCos = XRQuaternion::Dot( a, b );
+		if ( flCos < 0.0f )
+		{
+			flCos = -flCos;
+			b = -b;
+		}
+
+		float flScaleA = 1.0f - t;
+		float flScaleB = t;
+		if ( flCos < 0.9995f )
+		{
+			float flAngle = acosf( flCos );
+			float flInvSin = 1.0f / sinf( flAngle );
+			flScaleA = sinf( flScaleA * flAngle ) * flInvSin;
+			flScaleB = sinf( flScaleB * flAngle ) * flInvSin;
+		}
+
+		return Normalize( flScaleA * a + flScaleB * b );
+	}
+
+	/// Rotation by slerp, position by a cubic Hermite curve through both samples' positions and velocities
+	void InterpolatePose( const vr::TrackedDevicePose_t &a, const vr::TrackedDevicePose_t &b, float t, float flDeltaSeconds, vr::TrackedDevicePose_t &pose )
+	{
+		pose = ( t < 0.5f ) ? a : b;
+
+		XRQuaternion qa, qb;
+		MatrixToQuaternion( RotationToMatrix( a.mDeviceToAbsoluteTracking ), qa );
+		MatrixToQuaternion( RotationToMatrix( b.mDeviceToAbsoluteTracking ), qb );
+
+		XRMatrix3x3 rotation;
+		QuaternionToMatrix( Slerp( qa, qb, t ), rotation );
+		for ( int row = 0; row < 3; ++row )
+		{
+			for ( int col = 0; col < 3; ++col )
+			{
+				pose.mDeviceToAbsoluteTracking.m[row][col] = rotation.m[row][col];
+			}
+		}
+
+		float t2 = t * t;
+		float t3 = t2 * t;
+		float h00 = 2.0f * t3 - 3.0f * t2 + 1.0f;
+		float h10 = t3 - 2.0f * t2 + t;
+		float h01 = -2.0f * t3 + 3.0f * t2;
+		float h11 = t3 - t2;
+
+		for ( int axis = 0; axis < 3; ++axis )
+		{
+			pose.mDeviceToAbsoluteTracking.m[axis][3] = h00 * a.mDeviceToAbsoluteTracking.m[axis][3] + h10 * flDeltaSeconds * a.vVelocity.v[axis]
+				+ h01 * b.mDeviceToAbsoluteTracking.m[axis][3] + h11 * flDeltaSeconds * b.vVelocity.v[axis];
+			pose.vVelocity.v[axis] = a.vVelocity.v[axis] + ( b.vVelocity.v[axis] - a.vVelocity.v[axis] ) * t;
+			pose.vAngularVelocity.v[axis] = a.vAngularVelocity.v[axis] + ( b.vAngularVelocity.v[axis] - a.vAngularVelocity.v[axis] ) * t;
+		}
+	}
+}
+
+
+void PoseHistory::Record( const vr::TrackedDevicePose_t poses[vr::k_unMaxTrackedDeviceCount], uint64_t nTimeNs )
+{
+	uint32_t nEpoch = m_nEpoch.load( std::memory_order_acquire );
+
+	for ( uint32_t unDevice = 0; unDevice < vr::k_unMaxTrackedDeviceCount; ++unDevice )
+	{
+		if ( !poses[unDevice].bDeviceIsConnected )
+			continue;
+
+		DeviceRing &ring = m_devices[unDevice];
+
+		// The predicted display time jitters with the vsync reading, keep the ring in time order for Sample
+		if ( ring.nEpoch == nEpoch && ring.nWritten > 0 && ring.samples[( ring.nWritten - 1 ) % k_unNumSamples].nTimeNs >= nTimeNs )
+			continue;
+
+		ring.nSequence.store( ring.nSequence.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_release );
+
+		if ( ring.nEpoch != nEpoch )
+		{
+			ring.nWritten = 0;
+			ring.nEpoch = nEpoch;
+		}
+
+		PoseSample &sample = ring.samples[ring.nWritten % k_unNumSamples];
+		sample.nTimeNs = nTimeNs;
+		sample.pose = poses[unDevice];
+		ring.nWritten++;
+
+		ring.nSequence.store( ring.nSequence.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+	}
+}
+
+
+bool PoseHistory::Sample( vr::TrackedDeviceIndex_t unDeviceIndex, uint64_t nTimeNs, vr::TrackedDevicePose_t &pose ) const
+{
+	if ( unDeviceIndex >= vr::k_unMaxTrackedDeviceCount )
+		return false;
+
+	const DeviceRing &ring = m_devices[unDeviceIndex];
+	uint32_t nEpoch = m_nEpoch.load( std::memory_order_acquire );
+
+	PoseSample before, after;
+	for ( ;; )
+	{
+		uint32_t nSequence = ring.nSequence.load( std::memory_order_acquire );
+		if ( nSequence & 1 )
+			continue;
+
+		uint64_t nWritten = ( ring.nEpoch == nEpoch ) ? ring.nWritten : 0;
+		uint64_t nCount = std::min< uint64_t >( nWritten, k_unNumSamples );
+
+		// Samples are in time order, oldest at nWritten - nCount. Find the first sample at or after the requested time.
+		uint64_t nFirst = nWritten - nCount;
+		uint64_t nLow = nFirst, nHigh = nWritten;
+		while ( nLow < nHigh )
+		{
+			uint64_t nMid = nLow + ( nHigh - nLow ) / 2;
+			if ( ring.samples[nMid % k_unNumSamples].nTimeNs < nTimeNs )
+				nLow = nMid + 1;
+			else
+				nHigh = nMid;
+		}
+
+		bool bCovered = nLow < nWritten && ( nLow > nFirst || ring.samples[nLow % k_unNumSamples].nTimeNs == nTimeNs );
+		if ( bCovered )
+		{
+			memcpy( &after, &ring.samples[nLow % k_unNumSamples], sizeof( PoseSample ) );
+			memcpy( &before, &ring.samples[( nLow > nFirst ? nLow - 1 : nLow ) % k_unNumSamples], sizeof( PoseSample ) );
+		}
+
+		std::atomic_thread_fence( std::memory_order_acquire );
+		if ( ring.nSequence.load( std::memory_order_relaxed ) != nSequence )
+			continue;
+
+		if ( !bCovered )
+			return false;
+
+		break;
+	}
+
+	// Don't interpolate across a gap, e.g. after the device was off for a while
+	if ( after.nTimeNs - before.nTimeNs > k_unMaxGapNs )
+		return false;
+
+	if ( after.nTimeNs == before.nTimeNs || !before.pose.bPoseIsValid || !after.pose.bPoseIsValid )
+	{
+		pose = ( nTimeNs - before.nTimeNs < after.nTimeNs - nTimeNs ) ? before.pose : after.pose;
+		return true;
+	}
+
+	float t = (float )( nTimeNs - before.nTimeNs ) / (float )( after.nTimeNs - before.nTimeNs );
+	InterpolatePose( before.pose, after.pose, t, (float )( after.nTimeNs - before.nTimeNs ) * 1e-9f, pose );
+	return true;
+}
+
+
+void PoseHistory::Invalidate()
+{
+	m_nEpoch.fetch_add( 1, std::memory_order_acq_rel );
+}
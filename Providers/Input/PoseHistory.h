@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+#include "OpenVR/openvr.h"
+
+/// Timestamped poses of every tracked device over the last ~500 ms, so queries for past timestamps can be answered
+/// by interpolating recorded samples instead of asking the runtime. One writer (the graphics thread, once per frame)
+/// and any number of readers. Every device ring has a sequence counter that is odd while the writer is inside it,
+/// readers that raced the writer retry.
+class PoseHistory
+{
+public:
+	/// Samples kept per device, enough for 500 ms at 120 Hz
+	static const uint32_t k_unNumSamples = 64;
+
+	/// Samples further apart than this aren't interpolated between
+	static const uint64_t k_unMaxGapNs = 500000000ull;
+
+	/// Append a sample for every connected device. Samples that aren't newer than a device's newest sample are dropped.
+	/// @param[in] const vr::TrackedDevicePose_t poses[vr::k_unMaxTrackedDeviceCount] - Poses predicted for nTimeNs
+	/// @param[in] uint64_t nTimeNs - std::chrono::steady_clock time of the poses, in nanoseconds
+	void Record( const vr::TrackedDevicePose_t poses[vr::k_unMaxTrackedDeviceCount], uint64_t nTimeNs );
+
+	/// Pose of a device at a time covered by the history, interpolated between the samples around it
+	/// @param[in] vr::TrackedDeviceIndex_t unDeviceIndex - OpenVR device index
+	/// @param[in] uint64_t nTimeNs - std::chrono::steady_clock time, in nanoseconds
+	/// @param[out] vr::TrackedDevicePose_t& pose - The interpolated pose
+	/// @return bool - false if the time is newer than the newest sample or older than the history, the caller has to predict
+	bool Sample( vr::TrackedDeviceIndex_t unDeviceIndex, uint64_t nTimeNs, vr::TrackedDevicePose_t &pose ) const;
+
+	/// Forget all samples, e.g. when the tracking space changes. Can be called on any thread, samples recorded
+	/// before the call are never returned afterwards.
+	void Invalidate();
+
+private:
+	struct PoseSample
+	{
+		uint64_t nTimeNs;
+		vr::TrackedDevicePose_t pose;
+	};
+
+	struct DeviceRing
+	{
+		std::atomic< uint32_t > nSequence{ 0 };
+
+		/// Number of samples ever written, the newest is at ( nWritten - 1 ) % k_unNumSamples
+		uint64_t nWritten = 0;
+
+		/// m_nEpoch the samples were recorded in
+		uint32_t nEpoch = 0;
+
+		PoseSample samples[k_unNumSamples];
+	};
+
+	DeviceRing m_devices[vr::k_unMaxTrackedDeviceCount];
+
+	/// Bumped by Invalidate, rings recorded in an older epoch are restarted by the next Record
+	std::atomic< uint32_t > m_nEpoch{ 0 };
+};
@@ -105,6 +105,11 @@ bool OpenVRSystem::Update()
 {
 	m_FrameIndex++;
 
+	if ( UserProjectSettings::GetNativeEventPumpEnabled() )
+	{
+		PumpEvents();
+	}
+
 	if ( tickCallback )
 	{
 		tickCallback( m_FrameIndex );
@@ -197,6 +202,96 @@ vr::IVRCompositor *OpenVRSystem::StartVRCompositor()
 	return vrCompositor;
 }
 
+void OpenVRSystem::PumpEvents()
+{
+	if ( !m_VRSystem )
+		return;
+
+	// Always drain OpenVR's queue so native state never lags behind, managed code only gets the newest events if it falls behind
+	uint64_t nDirtyMask = 0;
+	bool bRescanAll = false;
+	vr::VREvent_t vrEvent;
+	while ( m_VRSystem->PollNextEvent( &vrEvent, sizeof( vr::VREvent_t ) ) )
+	{
+		// The managed queue is full, the oldest event makes room
+		if ( m_unNumQueuedEvents == k_unMaxQueuedEvents )
+		{
+			m_unFirstQueuedEvent = ( m_unFirstQueuedEvent + 1 ) % k_unMaxQueuedEvents;
+			m_unNumQueuedEvents--;
+		}
+
+		m_queuedEvents[( m_unFirstQueuedEvent + m_unNumQueuedEvents ) % k_unMaxQueuedEvents] = vrEvent;
+		m_unNumQueuedEvents++;
+
+		switch ( vrEvent.eventType )
+		{
+		case vr::VREvent_TrackedDeviceActivated:
+		case vr::VREvent_TrackedDeviceDeactivated:
+		case vr::VREvent_TrackedDeviceUpdated:
+			if ( vrEvent.trackedDeviceIndex < vr::k_unMaxTrackedDeviceCount )
+				nDirtyMask |= 1ull << vrEvent.trackedDeviceIndex;
+			else
+				bRescanAll = true;
+			break;
+
+		case vr::VREvent_TrackedDeviceRoleChanged:
+			// A role change can move the hands between any of the controllers
+			bRescanAll = true;
+			break;
+
+		case vr::VREvent_PropertyChanged:
+			if ( vrEvent.trackedDeviceIndex < vr::k_unMaxTrackedDeviceCount )
+				m_nPropertyDirtyMask |= 1ull << vrEvent.trackedDeviceIndex;
+			else
+				m_nPropertyDirtyMask = ~0ull;
+			break;
+
+		case vr::VREvent_IpdChanged:
+			m_bIpdChanged = true;
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	if ( nDirtyMask )
+		m_nTopologyDirtyMask.fetch_or( nDirtyMask, std::memory_order_release );
+	if ( bRescanAll )
+		m_bTopologyRescanRequested.store( true, std::memory_order_release );
+}
+
+bool OpenVRSystem::PopQueuedEvent( vr::VREvent_t *pEvent )
+{
+	if ( m_unNumQueuedEvents == 0 )
+		return false;
+
+	*pEvent = m_queuedEvents[m_unFirstQueuedEvent];
+	m_unFirstQueuedEvent = ( m_unFirstQueuedEvent + 1 ) % k_unMaxQueuedEvents;
+	m_unNumQueuedEvents--;
+	return true;
+}
+
+uint64_t OpenVRSystem::ConsumePropertyChanges()
+{
+	uint64_t nDirtyMask = m_nPropertyDirtyMask;
+	m_nPropertyDirtyMask = 0;
+	return nDirtyMask;
+}
+
+bool OpenVRSystem::ConsumeIpdChange()
+{
+	bool bIpdChanged = m_bIpdChanged;
+	m_bIpdChanged = false;
+	return bIpdChanged;
+}
+
+uint64_t OpenVRSystem::ConsumeTopologyChanges( bool &bRescanAll )
+{
+	bRescanAll = m_bTopologyRescanRequested.exchange( false, std::memory_order_acq_rel );
+	return m_nTopologyDirtyMask.exchange( 0, std::memory_order_acq_rel );
+}
+
 extern "C" uint32_t UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
 GetInitializationResult()
 {
@@ -207,4 +302,13 @@ extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
 RegisterTickCallback( TickCallback newTickCallback )
 {
 	OpenVRSystem::Get().SetTickCallback( newTickCallback );
-}
\ No newline at end of file
+}
+
+extern "C" bool UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+PollNextNativeEvent( vr::VREvent_t *pEvent, uint32_t eventSize )
+{
+	if ( pEvent == nullptr || eventSize != sizeof( vr::VREvent_t ) )
+		return false;
+
+	return OpenVRSystem::Get().PopQueuedEvent( pEvent );
+}
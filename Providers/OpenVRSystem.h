@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include "UserProjectSettings.h"
 
 #include "CommonTypes.h"
@@ -40,7 +42,39 @@ public:
 
 	void SetTickCallback( TickCallback newTickCallback ) { tickCallback = newTickCallback; }
 
+	/// Pop the oldest event queued by the native event pump (main thread)
+	/// @param[out] vr::VREvent_t* pEvent - The event
+	/// @return bool - false if the queue is empty
+	bool PopQueuedEvent( vr::VREvent_t *pEvent );
+
+	/// Take the topology changes reported by events since the last call, can be called from any thread
+	/// @param[out] bool& bRescanAll - true if an event affects more than the devices in the returned mask
+	/// @return uint64_t - Bit per OpenVR index whose device was activated, deactivated or updated
+	uint64_t ConsumeTopologyChanges( bool &bRescanAll );
+
+	/// Take the devices VREvent_PropertyChanged was reported for since the last call (main thread)
+	/// @return uint64_t - Bit per OpenVR index whose properties changed
+	uint64_t ConsumePropertyChanges();
+
+	/// Take whether VREvent_IpdChanged was reported since the last call (main thread)
+	/// @return bool - true if the eye to head transforms need to be read again
+	bool ConsumeIpdChange();
+
 private:
+	/// Poll all of OpenVR's events on the main thread, note topology changes and queue the events for managed code.
+	/// When managed code doesn't keep up, the oldest queued events are dropped.
+	void PumpEvents();
+
+	static const uint32_t k_unMaxQueuedEvents = 64;
+	vr::VREvent_t m_queuedEvents[k_unMaxQueuedEvents];
+	uint32_t m_unFirstQueuedEvent = 0;
+	uint32_t m_unNumQueuedEvents = 0;
+
+	std::atomic< uint64_t > m_nTopologyDirtyMask{ 0 };
+	std::atomic< bool > m_bTopologyRescanRequested{ false };
+	uint64_t m_nPropertyDirtyMask = 0;
+	bool m_bIpdChanged = false;
+
     uint64_t graphicsAdapterId;
 	int m_FrameIndex;
 
@@ -0,0 +1,47 @@
+#include <chrono>
+
+#include "TimeDomain.h"
+
+
+static const int64_t k_nNsPerMs = 1000000;
+
+TimeDomain::TimeDomain()
+{
+	m_nAnchorNs = GetNowNs();
+	m_nAnchorUnixMs = std::chrono::duration_cast< std::chrono::milliseconds >( std::chrono::system_clock::now().time_since_epoch() ).count();
+}
+
+
+uint64_t TimeDomain::GetNowNs()
+{
+	return std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+
+UnityXRTimeStamp TimeDomain::ToUnityTimestamp( uint64_t nTimeNs ) const
+{
+	int64_t nDeltaNs = static_cast< int64_t >( nTimeNs - m_nAnchorNs );
+
+	// Round towards negative infinity, so a timestamp never lies in the future of the time it came from
+	int64_t nDeltaMs = nDeltaNs / k_nNsPerMs;
+	if ( nDeltaNs < 0 && nDeltaNs % k_nNsPerMs != 0 )
+		nDeltaMs--;
+
+	return static_cast< UnityXRTimeStamp >( m_nAnchorUnixMs + nDeltaMs );
+}
+
+
+int64_t TimeDomain::FromUnityTimestamp( UnityXRTimeStamp timestamp ) const
+{
+	return static_cast< int64_t >( m_nAnchorNs ) + ( static_cast< int64_t >( timestamp ) - m_nAnchorUnixMs ) * k_nNsPerMs;
+}
+
+
+void TimeDomain::RecordVsync( float flSecondsSinceLastVsync, uint64_t nNowNs )
+{
+	uint64_t nSinceVsyncNs = static_cast< uint64_t >( static_cast< double >( flSecondsSinceLastVsync ) * 1e9 );
+	if ( nSinceVsyncNs > nNowNs )
+		return;
+
+	m_nLastVsyncNs.store( nNowNs - nSinceVsyncNs, std::memory_order_release );
+}
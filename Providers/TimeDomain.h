@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+#include "Singleton.h"
+#include "ProviderInterface/UnityXRTypes.h"
+
+/// Single time base for poses, device states and stats. Everything internal is std::chrono::steady_clock time in
+/// nanoseconds, which never jumps. Unity wants UTC milliseconds (UnityXRTimeStamp), those are derived from one
+/// wall clock reading taken at startup so they advance with the monotonic clock instead of the wall clock.
+/// The graphics thread also records the compositor's vsyncs in the same time base.
+class TimeDomain : public Singleton<TimeDomain>
+{
+public:
+	TimeDomain();
+
+	/// Current std::chrono::steady_clock time, in nanoseconds
+	static uint64_t GetNowNs();
+
+	/// Convert a steady_clock time to a Unity timestamp
+	/// @param[in] uint64_t nTimeNs - std::chrono::steady_clock time, in nanoseconds
+	/// @return UnityXRTimeStamp - Milliseconds since the Unix epoch
+	UnityXRTimeStamp ToUnityTimestamp( uint64_t nTimeNs ) const;
+
+	/// Convert a Unity timestamp to a steady_clock time
+	/// @param[in] UnityXRTimeStamp timestamp - Milliseconds since the Unix epoch
+	/// @return int64_t - std::chrono::steady_clock time, in nanoseconds. Negative for timestamps before the clock's epoch.
+	int64_t FromUnityTimestamp( UnityXRTimeStamp timestamp ) const;
+
+	/// Record the most recent vsync, called by the graphics thread after IVRSystem::GetTimeSinceLastVsync
+	/// @param[in] float flSecondsSinceLastVsync - Time since the vsync as returned by GetTimeSinceLastVsync
+	/// @param[in] uint64_t nNowNs - Time GetTimeSinceLastVsync was called at
+	void RecordVsync( float flSecondsSinceLastVsync, uint64_t nNowNs );
+
+	/// steady_clock time of the most recently recorded vsync, in nanoseconds. 0 if none was recorded yet.
+	uint64_t GetLastVsyncNs() const { return m_nLastVsyncNs.load( std::memory_order_acquire ); }
+
+private:
+	/// Wall clock and steady_clock read together at startup
+	int64_t m_nAnchorUnixMs;
+	uint64_t m_nAnchorNs;
+
+	std::atomic< uint64_t > m_nLastVsyncNs{ 0 };
+};
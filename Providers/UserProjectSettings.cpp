@@ -28,6 +28,24 @@ typedef struct _UserDefinedSettings
 static UserDefinedSettings s_UserDefinedSettings;
 static bool bInitialized = false;
 
+// Runtime settings that aren't part of the settings asset
+static uint16_t s_nDisplayStageCount = k_nDefaultDisplayStageCount;
+static uint16_t s_nDynamicResolutionPolicy = DynamicResolutionPolicy_Disabled;
+static float s_flDynamicResolutionMinScale = k_flDefaultDynamicResolutionMinScale;
+static float s_flDynamicResolutionMaxScale = k_flDefaultDynamicResolutionMaxScale;
+static uint32_t s_unEyeTexturePoolBudgetMB = k_unDefaultEyeTexturePoolBudgetMB;
+static bool s_bDepthSubmissionEnabled = false;
+static uint16_t s_nFoveationLevel = FoveationLevel_Off;
+static float s_flFoveationGaze[2][2] = { { 0.0f, 0.0f }, { 0.0f, 0.0f } };
+static bool s_bQuadViewEnabled = false;
+static float s_flQuadViewInsetFraction = k_flDefaultQuadViewInsetFraction;
+static float s_flQuadViewWideScale = k_flDefaultQuadViewWideScale;
+static bool s_bSharedCullingEnabled = false;
+static bool s_bNativeEventPumpEnabled = false;
+static std::string s_nativeActionSetPath;
+static std::string s_nativeActionManifestPath;
+static uint32_t s_nNativeActionGeneration = 0;
+
 const std::string kStereoRenderingMode = "StereoRenderingMode:";
 const std::string kInitializationType = "InitializationType:";
 const std::string kEditorAppKey = "EditorAppKey:";
@@ -36,10 +54,14 @@ const std::string kMirrorViewMode = "MirrorView:";
 
 #ifdef __linux__
 const std::string kStreamingAssetsFilePath = "StreamingAssets/SteamVR/OpenVRSettings.asset";
+const std::string kStreamingAssetsDirectoryPath = "StreamingAssets/SteamVR/";
 #else
 const string kStreamingAssetsFilePath = "StreamingAssets\\SteamVR\\OpenVRSettings.asset";
+const string kStreamingAssetsDirectoryPath = "StreamingAssets\\SteamVR\\";
 #endif
 
+const std::string kDisplayConfigCacheFileName = "OpenVRDisplayConfig.cache";
+
 const string kVSDebugPath = "..\\..\\";
 
 
@@ -311,6 +333,18 @@ std::string UserProjectSettings::GetActionManifestPath()
 	}
 }
 
+std::string UserProjectSettings::GetDisplayConfigCachePath()
+{
+	// Keep the cache next to the settings asset, but don't create any directories for it
+	std::string directoryPath = GetProjectDirectoryPath( true ) + kStreamingAssetsDirectoryPath;
+	if ( !DirectoryExists( directoryPath.c_str() ) )
+	{
+		return std::string();
+	}
+
+	return directoryPath + kDisplayConfigCacheFileName;
+}
+
 std::string UserProjectSettings::GetAppName()
 {
 	if ( s_UserDefinedSettings.applicationName )
@@ -323,6 +357,88 @@ std::string UserProjectSettings::GetAppName()
 	}
 }
 
+int UserProjectSettings::GetDisplayStageCount()
+{
+	return s_nDisplayStageCount;
+}
+
+EVRDynamicResolutionPolicy UserProjectSettings::GetDynamicResolutionPolicy()
+{
+	return (EVRDynamicResolutionPolicy )s_nDynamicResolutionPolicy;
+}
+
+float UserProjectSettings::GetDynamicResolutionMinScale()
+{
+	return s_flDynamicResolutionMinScale;
+}
+
+float UserProjectSettings::GetDynamicResolutionMaxScale()
+{
+	return s_flDynamicResolutionMaxScale;
+}
+
+uint32_t UserProjectSettings::GetEyeTexturePoolBudgetMB()
+{
+	return s_unEyeTexturePoolBudgetMB;
+}
+
+bool UserProjectSettings::GetDepthSubmissionEnabled()
+{
+	return s_bDepthSubmissionEnabled;
+}
+
+EVRFoveationLevel UserProjectSettings::GetFoveationLevel()
+{
+	return (EVRFoveationLevel )s_nFoveationLevel;
+}
+
+void UserProjectSettings::GetFoveationGaze( int eye, float &flGazeX, float &flGazeY )
+{
+	flGazeX = s_flFoveationGaze[eye][0];
+	flGazeY = s_flFoveationGaze[eye][1];
+}
+
+bool UserProjectSettings::GetQuadViewEnabled()
+{
+	return s_bQuadViewEnabled;
+}
+
+float UserProjectSettings::GetQuadViewInsetFraction()
+{
+	return s_flQuadViewInsetFraction;
+}
+
+float UserProjectSettings::GetQuadViewWideScale()
+{
+	return s_flQuadViewWideScale;
+}
+
+bool UserProjectSettings::GetSharedCullingEnabled()
+{
+	return s_bSharedCullingEnabled;
+}
+
+bool UserProjectSettings::GetNativeEventPumpEnabled()
+{
+	return s_bNativeEventPumpEnabled;
+}
+
+const std::string &UserProjectSettings::GetNativeActionSetPath()
+{
+	return s_nativeActionSetPath;
+}
+
+std::string UserProjectSettings::GetNativeActionManifestPath()
+{
+	// The manifest of the project settings unless one was given just for the native action set
+	return s_nativeActionManifestPath.empty() ? GetActionManifestPath() : s_nativeActionManifestPath;
+}
+
+uint32_t UserProjectSettings::GetNativeActionGeneration()
+{
+	return s_nNativeActionGeneration;
+}
+
 int UserProjectSettings::GetUnityMirrorViewMode()
 {
 	int unityMode = kUnityXRMirrorBlitNone;
@@ -440,6 +556,137 @@ SetMirrorViewMode( uint16_t mirrorViewMode )
 	s_UserDefinedSettings.mirrorViewMode = mirrorViewMode;
 }
 
+extern "C" uint16_t UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+GetDisplayStageCount()
+{
+	return s_nDisplayStageCount;
+}
+
+extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+SetDisplayStageCount( uint16_t displayStageCount )
+{
+	s_nDisplayStageCount = std::clamp( displayStageCount, k_nMinDisplayStageCount, k_nMaxDisplayStageCount );
+
+	XR_TRACE( "[OpenVR] Extern SetDisplayStageCount (%u)\n", s_nDisplayStageCount );
+}
+
+extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+SetDynamicResolutionPolicy( uint16_t dynamicResolutionPolicy )
+{
+	if ( dynamicResolutionPolicy > DynamicResolutionPolicy_PID )
+	{
+		dynamicResolutionPolicy = DynamicResolutionPolicy_Disabled;
+	}
+
+	XR_TRACE( "[OpenVR] Extern SetDynamicResolutionPolicy (%u)\n", dynamicResolutionPolicy );
+
+	s_nDynamicResolutionPolicy = dynamicResolutionPolicy;
+}
+
+extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+SetDynamicResolutionScaleRange( float minScale, float maxScale )
+{
+	XR_TRACE( "[OpenVR] Extern SetDynamicResolutionScaleRange (%f - %f)\n", minScale, maxScale );
+
+	s_flDynamicResolutionMinScale = minScale;
+	s_flDynamicResolutionMaxScale = maxScale;
+}
+
+extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+SetEyeTexturePoolBudget( uint32_t budgetMB )
+{
+	XR_TRACE( "[OpenVR] Extern SetEyeTexturePoolBudget (%u MB)\n", budgetMB );
+
+	s_unEyeTexturePoolBudgetMB = budgetMB;
+}
+
+extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+SetDepthSubmissionEnabled( uint16_t depthSubmissionEnabled )
+{
+	XR_TRACE( "[OpenVR] Extern SetDepthSubmissionEnabled (%u)\n", depthSubmissionEnabled );
+
+	s_bDepthSubmissionEnabled = depthSubmissionEnabled != 0;
+}
+
+extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+SetFoveationLevel( uint16_t foveationLevel )
+{
+	if ( foveationLevel > FoveationLevel_High )
+	{
+		foveationLevel = FoveationLevel_Off;
+	}
+
+	XR_TRACE( "[OpenVR] Extern SetFoveationLevel (%u)\n", foveationLevel );
+
+	s_nFoveationLevel = foveationLevel;
+}
+
+extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+SetFoveationGaze( int eye, float gazeX, float gazeY )
+{
+	if ( eye < 0 || eye > 1 )
+		return;
+
+	s_flFoveationGaze[eye][0] = gazeX;
+	s_flFoveationGaze[eye][1] = gazeY;
+}
+
+extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+SetQuadViewEnabled( uint16_t quadViewEnabled )
+{
+	XR_TRACE( "[OpenVR] Extern SetQuadViewEnabled (%u)\n", quadViewEnabled );
+
+	s_bQuadViewEnabled = quadViewEnabled != 0;
+}
+
+extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+SetQuadViewParameters( float insetFraction, float wideScale )
+{
+	XR_TRACE( "[OpenVR] Extern SetQuadViewParameters (%f, %f)\n", insetFraction, wideScale );
+
+	s_flQuadViewInsetFraction = insetFraction;
+	s_flQuadViewWideScale = wideScale;
+}
+
+extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+SetSharedCullingEnabled( uint16_t sharedCullingEnabled )
+{
+	XR_TRACE( "[OpenVR] Extern SetSharedCullingEnabled (%u)\n", sharedCullingEnabled );
+
+	s_bSharedCullingEnabled = sharedCullingEnabled != 0;
+}
+
+extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+SetNativeEventPumpEnabled( uint16_t nativeEventPumpEnabled )
+{
+	XR_TRACE( "[OpenVR] Extern SetNativeEventPumpEnabled (%u)\n", nativeEventPumpEnabled );
+
+	s_bNativeEventPumpEnabled = nativeEventPumpEnabled != 0;
+}
+
+extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+SetNativeActionSet( const char *actionSetPath )
+{
+	XR_TRACE( "[OpenVR] Extern SetNativeActionSet (%s)\n", actionSetPath ? actionSetPath : "" );
+
+	s_nativeActionSetPath = actionSetPath ? actionSetPath : "";
+	s_nNativeActionGeneration++;
+}
+
+extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
+SetNativeActionManifest( const char *actionManifestPath )
+{
+	XR_TRACE( "[OpenVR] Extern SetNativeActionManifest (%s)\n", actionManifestPath ? actionManifestPath : "" );
+
+	s_nativeActionManifestPath = actionManifestPath ? actionManifestPath : "";
+
+	#ifdef __linux__
+	std::replace( s_nativeActionManifestPath.begin(), s_nativeActionManifestPath.end(), '\\', '/' );
+	#endif
+
+	s_nNativeActionGeneration++;
+}
+
 extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
 SetUserDefinedSettings( UserDefinedSettings settings )
 {
@@ -457,6 +704,9 @@ SetUserDefinedSettings( UserDefinedSettings settings )
 	s_UserDefinedSettings.initializationType = settings.initializationType;
 	s_UserDefinedSettings.mirrorViewMode = settings.mirrorViewMode;
 
+	// The native action set falls back to the project's action manifest
+	s_nNativeActionGeneration++;
+
 	if ( settings.editorAppKey && strlen( settings.editorAppKey ) > 1 )
 	{
 		size_t strLen = strlen( settings.editorAppKey ) + 1;
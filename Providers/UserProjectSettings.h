@@ -44,6 +44,38 @@ enum EVRMirrorViewMode
 	SteamVR_Eye_Both = 3,
 };
 
+// Number of textures per eye the display provider cycles through
+static const uint16_t k_nMinDisplayStageCount = 1;
+static const uint16_t k_nMaxDisplayStageCount = 4;
+static const uint16_t k_nDefaultDisplayStageCount = 2;
+
+// Default floor and ceiling of the dynamic resolution scale
+static const float k_flDefaultDynamicResolutionMinScale = 0.6f;
+static const float k_flDefaultDynamicResolutionMaxScale = 1.0f;
+
+// Default VRAM budget for the eye texture pool
+static const uint32_t k_unDefaultEyeTexturePoolBudgetMB = 512;
+
+// Default part of each eye's field of view (per axis) the quad view inset covers, and resolution scale of the wide views
+static const float k_flDefaultQuadViewInsetFraction = 0.5f;
+static const float k_flDefaultQuadViewWideScale = 0.5f;
+
+enum EVRDynamicResolutionPolicy
+{
+	DynamicResolutionPolicy_Disabled = 0,
+	DynamicResolutionPolicy_Step = 1,
+	DynamicResolutionPolicy_Hysteresis = 2,
+	DynamicResolutionPolicy_PID = 3,
+};
+
+enum EVRFoveationLevel
+{
+	FoveationLevel_Off = 0,
+	FoveationLevel_Low = 1,
+	FoveationLevel_Medium = 2,
+	FoveationLevel_High = 3,
+};
+
 enum EVRStereoRenderingModes
 {
 	MultiPass = 0,
@@ -57,11 +89,28 @@ public:
 	static vr::EVRApplicationType GetInitializationType();
 	static std::string GetEditorAppKey();
 	static std::string GetActionManifestPath();
+	static std::string GetDisplayConfigCachePath();
 	static std::string GetAppName();
 	static void Initialize();
 	static std::string GetInitStartupInfo();
 	static EVRMirrorViewMode GetMirrorViewMode();
 	static int GetUnityMirrorViewMode();
+	static int GetDisplayStageCount();
+	static EVRDynamicResolutionPolicy GetDynamicResolutionPolicy();
+	static float GetDynamicResolutionMinScale();
+	static float GetDynamicResolutionMaxScale();
+	static uint32_t GetEyeTexturePoolBudgetMB();
+	static bool GetDepthSubmissionEnabled();
+	static EVRFoveationLevel GetFoveationLevel();
+	static void GetFoveationGaze( int eye, float &flGazeX, float &flGazeY );
+	static bool GetQuadViewEnabled();
+	static float GetQuadViewInsetFraction();
+	static float GetQuadViewWideScale();
+	static bool GetSharedCullingEnabled();
+	static bool GetNativeEventPumpEnabled();
+	static const std::string &GetNativeActionSetPath();
+	static std::string GetNativeActionManifestPath();
+	static uint32_t GetNativeActionGeneration();
 	static std::string GetProjectDirectoryPath( bool bAddDataDirectory );
 	static std::string GetCurrentWorkingPath();
 	static bool FileExists( const std::string &fileName );
@@ -0,0 +1,173 @@
+// Compares GetUnionCullingFrustum against the previous pullback-only union frustum on parallel and canted eye
+// profiles: the union has to contain both eye frustums, and on parallel eyes it must not be larger than before.
+
+#include <cmath>
+#include <cstdio>
+
+#include "CullingFrustum.h"
+
+
+static int s_nFailures = 0;
+
+#define CHECK( condition ) \
+	do \
+	{ \
+		if ( !( condition ) ) \
+		{ \
+			printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition ); \
+			s_nFailures++; \
+		} \
+	} while ( 0 )
+
+
+static const float k_flPi = 3.14159265358979f;
+static const float k_flNear = 0.1f;
+static const float k_flFar = 100.0f;
+
+/// An HMD's eye setup
+struct EyeProfile
+{
+	const char *pchName;
+	float rawProjection[2][4];
+	vr::HmdMatrix34_t eyeToHead[2];
+};
+
+/// Eye to head transform of an eye rotated outwards around the head's up axis and offset to the side
+static vr::HmdMatrix34_t GetEyeToHead( float flCantDegrees, float flX )
+{
+	float flCant = flCantDegrees * k_flPi / 180.0f;
+	float c = cosf( flCant ), s = sinf( flCant );
+
+	vr::HmdMatrix34_t mat = { {
+		{ c, 0.0f, s, flX },
+		{ 0.0f, 1.0f, 0.0f, 0.0f },
+		{ -s, 0.0f, c, 0.0f },
+	} };
+	return mat;
+}
+
+/// Parallel eyes with the usual asymmetric, slightly outward looking projections
+static EyeProfile GetParallelProfile()
+{
+	EyeProfile profile = { "parallel", { { -1.39f, 1.25f, -1.47f, 1.46f }, { -1.25f, 1.39f, -1.47f, 1.46f } }, {} };
+	profile.eyeToHead[0] = GetEyeToHead( 0.0f, -0.032f );
+	profile.eyeToHead[1] = GetEyeToHead( 0.0f, 0.032f );
+	return profile;
+}
+
+/// Displays canted 10 degrees outwards, each with a symmetric projection
+static EyeProfile GetCantedProfile()
+{
+	EyeProfile profile = { "canted 10 deg", { { -1.2f, 1.2f, -1.3f, 1.3f }, { -1.2f, 1.2f, -1.3f, 1.3f } }, {} };
+	profile.eyeToHead[0] = GetEyeToHead( 10.0f, -0.032f );
+	profile.eyeToHead[1] = GetEyeToHead( -10.0f, 0.032f );
+	return profile;
+}
+
+/// The union frustum before the canted fit: widest tangents of both eyes, pulled back along the head's forward
+/// axis until both eye apexes are inside. Eye rotations are ignored.
+static void GetPullbackUnionFrustum( const EyeProfile &profile, UnionCullingFrustum &frustum )
+{
+	const float *left = profile.rawProjection[0];
+	const float *right = profile.rawProjection[1];
+
+	frustum.rawProjection[0] = std::fmin( left[0], right[0] );
+	frustum.rawProjection[1] = std::fmax( left[1], right[1] );
+	frustum.rawProjection[2] = std::fmin( left[2], right[2] );
+	frustum.rawProjection[3] = std::fmax( left[3], right[3] );
+
+	float flHalfSeparation = ( profile.eyeToHead[1].m[0][3] - profile.eyeToHead[0].m[0][3] ) * 0.5f;
+	float flPullback = std::fmax( flHalfSeparation / -frustum.rawProjection[0], flHalfSeparation / frustum.rawProjection[1] );
+
+	frustum.apex[0] = 0.0f;
+	frustum.apex[1] = 0.0f;
+	frustum.apex[2] = flPullback;
+	frustum.flNear = k_flNear;
+	frustum.flFar = k_flFar + flPullback;
+}
+
+/// Volume between the near and far planes
+static double GetVolume( const UnionCullingFrustum &frustum )
+{
+	double flWidth = (double )frustum.rawProjection[1] - frustum.rawProjection[0];
+	double flHeight = (double )frustum.rawProjection[3] - frustum.rawProjection[2];
+	double flNear = frustum.flNear, flFar = frustum.flFar;
+	return flWidth * flHeight * ( flFar * flFar * flFar - flNear * flNear * flNear ) / 3.0;
+}
+
+/// If the union contains the eye's frustum, checked on its 8 corners as both are convex
+static bool ContainsEye( const UnionCullingFrustum &frustum, const EyeProfile &profile, int eye )
+{
+	const vr::HmdMatrix34_t &mat = profile.eyeToHead[eye];
+	const float *raw = profile.rawProjection[eye];
+	const float flEpsilon = 1e-4f;
+
+	for ( int corner = 0; corner < 8; ++corner )
+	{
+		float flDistance = ( corner & 4 ) ? k_flFar : k_flNear;
+		float eyePoint[3] = { raw[corner & 1] * flDistance, -raw[2 + ( ( corner >> 1 ) & 1 )] * flDistance, -flDistance };
+
+		float d[3];
+		for ( int axis = 0; axis < 3; ++axis )
+		{
+			float flHead = mat.m[axis][0] * eyePoint[0] + mat.m[axis][1] * eyePoint[1] + mat.m[axis][2] * eyePoint[2] + mat.m[axis][3];
+			d[axis] = flHead - frustum.apex[axis];
+		}
+
+		float flForward = -d[2];
+		float flTolerance = flEpsilon * std::fmax( flForward, 1.0f );
+		if ( flForward < frustum.flNear - flTolerance || flForward > frustum.flFar + flTolerance )
+			return false;
+
+		if ( d[0] < frustum.rawProjection[0] * flForward - flTolerance || d[0] > frustum.rawProjection[1] * flForward + flTolerance )
+			return false;
+
+		if ( -d[1] < frustum.rawProjection[2] * flForward - flTolerance || -d[1] > frustum.rawProjection[3] * flForward + flTolerance )
+			return false;
+	}
+
+	return true;
+}
+
+static void CompareProfile( const EyeProfile &profile, bool bParallel )
+{
+	UnionCullingFrustum pullbackFrustum;
+	GetPullbackUnionFrustum( profile, pullbackFrustum );
+
+	UnionCullingFrustum fitFrustum;
+	bool bFit = GetUnionCullingFrustum( profile.rawProjection, profile.eyeToHead, k_flNear, k_flFar, fitFrustum );
+	CHECK( bFit );
+	if ( !bFit )
+		return;
+
+	bool bPullbackContains = ContainsEye( pullbackFrustum, profile, 0 ) && ContainsEye( pullbackFrustum, profile, 1 );
+	bool bFitContains = ContainsEye( fitFrustum, profile, 0 ) && ContainsEye( fitFrustum, profile, 1 );
+	double flPullbackVolume = GetVolume( pullbackFrustum );
+	double flFitVolume = GetVolume( fitFrustum );
+
+	printf( "%-14s pullback: volume %10.1f contains both eyes %i | fit: volume %10.1f contains both eyes %i | ratio %.4f\n",
+		profile.pchName, flPullbackVolume, bPullbackContains ? 1 : 0, flFitVolume, bFitContains ? 1 : 0, flFitVolume / flPullbackVolume );
+
+	CHECK( bFitContains );
+
+	// Without cant both are exact, the fit may only shave off what the pullback wasted
+	if ( bParallel )
+	{
+		CHECK( bPullbackContains );
+		CHECK( flFitVolume <= flPullbackVolume * ( 1.0 + 1e-5 ) );
+	}
+}
+
+
+int main()
+{
+	CompareProfile( GetParallelProfile(), true );
+	CompareProfile( GetCantedProfile(), false );
+
+	if ( s_nFailures == 0 )
+	{
+		printf( "All culling frustum tests passed\n" );
+	}
+
+	return s_nFailures == 0 ? 0 : 1;
+}
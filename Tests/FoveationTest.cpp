@@ -0,0 +1,169 @@
+// Checks the CPU side of foveated rendering: the radial profiles and the fragment density maps built from them.
+
+#include <cstdio>
+#include <vector>
+
+#include "Foveation.h"
+
+
+static int s_nFailures = 0;
+
+#define CHECK( condition ) \
+	do \
+	{ \
+		if ( !( condition ) ) \
+		{ \
+			printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition ); \
+			s_nFailures++; \
+		} \
+	} while ( 0 )
+
+
+/// Horizontal density of a texel, both channels have to agree
+static uint8_t GetDensity( const std::vector< uint8_t > &vDensity, uint32_t nWidth, uint32_t x, uint32_t y )
+{
+	const uint8_t *pTexel = &vDensity[( y * nWidth + x ) * 2];
+	CHECK( pTexel[0] == pTexel[1] );
+	return pTexel[0];
+}
+
+/// Find the texel with the highest density, the first one in row order on ties
+static void FindPeak( const std::vector< uint8_t > &vDensity, uint32_t nWidth, uint32_t nHeight, uint32_t &nPeakX, uint32_t &nPeakY )
+{
+	uint8_t nBest = 0;
+	nPeakX = nPeakY = 0;
+	for ( uint32_t y = 0; y < nHeight; y++ )
+	{
+		for ( uint32_t x = 0; x < nWidth; x++ )
+		{
+			if ( GetDensity( vDensity, nWidth, x, y ) > nBest )
+			{
+				nBest = GetDensity( vDensity, nWidth, x, y );
+				nPeakX = x;
+				nPeakY = y;
+			}
+		}
+	}
+}
+
+
+static void TestProfiles()
+{
+	FoveationProfile profile;
+	CHECK( !GetFoveationProfile( FoveationLevel_Off, profile ) );
+	CHECK( profile.flMinDensity == 1.0f );
+
+	// Higher levels shade less of the field of view at full rate
+	FoveationProfile low, medium, high;
+	CHECK( GetFoveationProfile( FoveationLevel_Low, low ) );
+	CHECK( GetFoveationProfile( FoveationLevel_Medium, medium ) );
+	CHECK( GetFoveationProfile( FoveationLevel_High, high ) );
+	CHECK( low.flInnerRadius > medium.flInnerRadius && medium.flInnerRadius > high.flInnerRadius );
+	CHECK( low.flOuterRadius > medium.flOuterRadius && medium.flOuterRadius > high.flOuterRadius );
+	CHECK( high.flMinDensity <= medium.flMinDensity && medium.flMinDensity <= low.flMinDensity );
+}
+
+static void TestSymmetricMap()
+{
+	const float rawProjection[4] = { -1.2f, 1.2f, -1.2f, 1.2f };
+	const uint32_t nSize = 64;
+
+	FoveationProfile profile;
+	GetFoveationProfile( FoveationLevel_High, profile );
+
+	std::vector< uint8_t > vDensity( nSize * nSize * 2 );
+	BuildFragmentDensityMap( rawProjection, 0.0f, 0.0f, profile, nSize, nSize, 1.0f, false, vDensity.data() );
+
+	// Full rate in the middle, the minimum in the corners
+	uint8_t nMinDensity = (uint8_t )( profile.flMinDensity * 255.0f + 0.5f );
+	CHECK( GetDensity( vDensity, nSize, nSize / 2, nSize / 2 ) == 255 );
+	CHECK( GetDensity( vDensity, nSize, 0, 0 ) == nMinDensity );
+	CHECK( GetDensity( vDensity, nSize, nSize - 1, nSize - 1 ) == nMinDensity );
+
+	// Never increases from the center out to the edge, and is mirror symmetric
+	for ( uint32_t x = nSize / 2; x + 1 < nSize; x++ )
+	{
+		CHECK( GetDensity( vDensity, nSize, x + 1, nSize / 2 ) <= GetDensity( vDensity, nSize, x, nSize / 2 ) );
+	}
+
+	for ( uint32_t x = 0; x < nSize; x++ )
+	{
+		CHECK( GetDensity( vDensity, nSize, x, nSize / 2 ) == GetDensity( vDensity, nSize, nSize - 1 - x, nSize / 2 ) );
+	}
+}
+
+static void TestAsymmetricMap()
+{
+	// Canted HMDs look further out than in, the projection center sits a quarter of the way in from the left edge
+	const float rawProjection[4] = { -0.5f, 1.5f, -1.0f, 1.0f };
+	const uint32_t nSize = 64;
+
+	FoveationProfile profile;
+	GetFoveationProfile( FoveationLevel_High, profile );
+
+	std::vector< uint8_t > vDensity( nSize * nSize * 2 );
+	BuildFragmentDensityMap( rawProjection, 0.0f, 0.0f, profile, nSize, nSize, 1.0f, false, vDensity.data() );
+
+	uint32_t nPeakX, nPeakY;
+	FindPeak( vDensity, nSize, nSize, nPeakX, nPeakY );
+	CHECK( GetDensity( vDensity, nSize, nSize / 4, nSize / 2 ) == 255 );
+	CHECK( nPeakX < nSize / 2 );
+
+	// Looking right and up moves the full rate region right and towards the top row
+	BuildFragmentDensityMap( rawProjection, 0.5f, 0.5f, profile, nSize, nSize, 1.0f, false, vDensity.data() );
+	CHECK( GetDensity( vDensity, nSize, nSize / 2, nSize / 4 ) == 255 );
+	CHECK( GetDensity( vDensity, nSize, nSize / 4, nSize / 2 ) < 255 );
+}
+
+static void TestViewportScaleAndFlip()
+{
+	const float rawProjection[4] = { -1.0f, 1.0f, -1.5f, 0.5f };
+	const uint32_t nSize = 64;
+
+	FoveationProfile profile;
+	GetFoveationProfile( FoveationLevel_Medium, profile );
+	uint8_t nMinDensity = (uint8_t )( profile.flMinDensity * 255.0f + 0.5f );
+
+	// At half scale the view covers the first 32x32 texels, with its projection center in the same relative spot
+	std::vector< uint8_t > vFull( nSize * nSize * 2 );
+	std::vector< uint8_t > vHalf( nSize * nSize * 2 );
+	BuildFragmentDensityMap( rawProjection, 0.0f, 0.0f, profile, nSize / 2, nSize / 2, 1.0f, false, vFull.data() );
+	BuildFragmentDensityMap( rawProjection, 0.0f, 0.0f, profile, nSize, nSize, 0.5f, false, vHalf.data() );
+
+	for ( uint32_t y = 0; y < nSize; y++ )
+	{
+		for ( uint32_t x = 0; x < nSize; x++ )
+		{
+			uint8_t nExpected = ( x < nSize / 2 && y < nSize / 2 ) ? GetDensity( vFull, nSize / 2, x, y ) : nMinDensity;
+			CHECK( GetDensity( vHalf, nSize, x, y ) == nExpected );
+		}
+	}
+
+	// Bottom up writes the rows of the view in reverse, still inside the view
+	std::vector< uint8_t > vFlipped( nSize * nSize * 2 );
+	BuildFragmentDensityMap( rawProjection, 0.0f, 0.0f, profile, nSize, nSize, 0.5f, true, vFlipped.data() );
+
+	for ( uint32_t y = 0; y < nSize / 2; y++ )
+	{
+		for ( uint32_t x = 0; x < nSize / 2; x++ )
+		{
+			CHECK( GetDensity( vFlipped, nSize, x, y ) == GetDensity( vHalf, nSize, x, nSize / 2 - 1 - y ) );
+		}
+	}
+}
+
+
+int main()
+{
+	TestProfiles();
+	TestSymmetricMap();
+	TestAsymmetricMap();
+	TestViewportScaleAndFlip();
+
+	if ( s_nFailures == 0 )
+	{
+		printf( "All foveation tests passed\n" );
+	}
+
+	return s_nFailures == 0 ? 0 : 1;
+}
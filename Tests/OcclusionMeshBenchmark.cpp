@@ -0,0 +1,159 @@
+// Times WeldHiddenAreaMesh on synthetic hidden area meshes of 1k to 100k triangles and checks it against a brute force weld.
+// Pass --quick to only run the small meshes (used by ctest).
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "OcclusionMesh.h"
+
+
+static const float k_flPi = 3.14159265358979f;
+
+/// Build a ring shaped triangle list like the standard hidden area mesh, every triangle carries its own copy of the shared vertices
+/// @param[in] uint32_t nTriangleCount - Number of triangles to generate, rounded down to a multiple of 2
+/// @param[out] std::vector< vr::HmdVector2_t >& vVertices - Triangle list vertices
+static void BuildRingMesh( uint32_t nTriangleCount, std::vector< vr::HmdVector2_t > &vVertices )
+{
+	// Split the triangles over a few concentric rings so the vertex density resembles a real lens mask
+	const uint32_t nRings = 4;
+	const uint32_t nSegments = nTriangleCount / ( 2 * nRings );
+
+	vVertices.clear();
+	vVertices.reserve( (size_t )nRings * nSegments * 6 );
+
+	auto GetRingVertex = [&]( uint32_t nRing, uint32_t nSegment ) -> vr::HmdVector2_t
+	{
+		float flAngle = 2.0f * k_flPi * (float )( nSegment % nSegments ) / (float )nSegments;
+		float flRadius = 0.5f - 0.02f * (float )nRing;
+		return { { 0.5f + flRadius * std::cos( flAngle ), 0.5f + flRadius * std::sin( flAngle ) } };
+	};
+
+	for ( uint32_t nRing = 0; nRing < nRings; nRing++ )
+	{
+		for ( uint32_t nSegment = 0; nSegment < nSegments; nSegment++ )
+		{
+			vr::HmdVector2_t outer0 = GetRingVertex( nRing, nSegment );
+			vr::HmdVector2_t outer1 = GetRingVertex( nRing, nSegment + 1 );
+			vr::HmdVector2_t inner0 = GetRingVertex( nRing + 1, nSegment );
+			vr::HmdVector2_t inner1 = GetRingVertex( nRing + 1, nSegment + 1 );
+
+			vVertices.push_back( outer0 );
+			vVertices.push_back( outer1 );
+			vVertices.push_back( inner0 );
+
+			vVertices.push_back( inner0 );
+			vVertices.push_back( outer1 );
+			vVertices.push_back( inner1 );
+		}
+	}
+}
+
+/// Reference weld that compares every vertex against every welded vertex
+/// @return size_t - Number of unique vertices
+static size_t BruteForceWeld( const std::vector< vr::HmdVector2_t > &vVertices, float flEpsilon )
+{
+	std::vector< vr::HmdVector2_t > vUnique;
+	const float flEpsilonSquared = flEpsilon * flEpsilon;
+
+	for ( const vr::HmdVector2_t &vertex : vVertices )
+	{
+		bool bFound = false;
+		for ( const vr::HmdVector2_t &unique : vUnique )
+		{
+			float flDiffX = unique.v[0] - vertex.v[0];
+			float flDiffY = unique.v[1] - vertex.v[1];
+			if ( ( flDiffX * flDiffX ) + ( flDiffY * flDiffY ) < flEpsilonSquared )
+			{
+				bFound = true;
+				break;
+			}
+		}
+
+		if ( !bFound )
+		{
+			vUnique.push_back( vertex );
+		}
+	}
+
+	return vUnique.size();
+}
+
+/// Run fn nIterations times and return the average time of one run in milliseconds
+template< typename Fn >
+static double TimeMs( uint32_t nIterations, Fn fn )
+{
+	auto start = std::chrono::steady_clock::now();
+	for ( uint32_t i = 0; i < nIterations; i++ )
+	{
+		fn();
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration< double, std::milli >( end - start ).count() / (double )nIterations;
+}
+
+
+int main( int argc, char **argv )
+{
+	bool bQuick = argc > 1 && strcmp( argv[1], "--quick" ) == 0;
+
+	// Brute force is quadratic, only run it where it finishes in reasonable time
+	const uint32_t k_nMaxBruteForceTriangles = 10000;
+	const uint32_t rTriangleCounts[] = { 1000, 5000, 10000, 50000, 100000 };
+
+	int nFailures = 0;
+
+	printf( "%10s %10s %10s %14s %14s\n", "triangles", "vertices", "welded", "weld ms", "brute ms" );
+
+	for ( uint32_t nTriangleCount : rTriangleCounts )
+	{
+		if ( bQuick && nTriangleCount > k_nMaxBruteForceTriangles )
+			break;
+
+		std::vector< vr::HmdVector2_t > vVertices;
+		BuildRingMesh( nTriangleCount, vVertices );
+
+		vr::HiddenAreaMesh_t hiddenAreaMesh = { vVertices.data(), (uint32_t )( vVertices.size() / 3 ) };
+		WeldedHiddenAreaMesh weldedMesh;
+
+		uint32_t nIterations = bQuick ? 1 : ( 1000000 / nTriangleCount );
+		double flWeldMs = TimeMs( nIterations, [&]()
+		{
+			WeldHiddenAreaMesh( hiddenAreaMesh, vr::k_eHiddenAreaMesh_Standard, k_flDefaultHiddenAreaMeshWeldEpsilon, weldedMesh );
+		} );
+
+		// Every index has to point at a vertex within epsilon of its input vertex
+		for ( size_t i = 0; i < weldedMesh.vIndices.size(); i++ )
+		{
+			const UnityXRVector2 &welded = weldedMesh.vVertices[weldedMesh.vIndices[i]];
+			float flDiffX = welded.x - vVertices[i].v[0];
+			float flDiffY = welded.y - vVertices[i].v[1];
+			if ( ( flDiffX * flDiffX ) + ( flDiffY * flDiffY ) >= k_flDefaultHiddenAreaMeshWeldEpsilon * k_flDefaultHiddenAreaMeshWeldEpsilon )
+			{
+				printf( "FAIL: %u triangles, index %zu welded to a vertex outside epsilon\n", hiddenAreaMesh.unTriangleCount, i );
+				nFailures++;
+				break;
+			}
+		}
+
+		char rchBruteMs[32] = "-";
+		if ( nTriangleCount <= k_nMaxBruteForceTriangles )
+		{
+			size_t nBruteForceVertices = 0;
+			double flBruteMs = TimeMs( 1, [&]() { nBruteForceVertices = BruteForceWeld( vVertices, k_flDefaultHiddenAreaMeshWeldEpsilon ); } );
+			snprintf( rchBruteMs, sizeof( rchBruteMs ), "%.3f", flBruteMs );
+
+			if ( nBruteForceVertices != weldedMesh.vVertices.size() )
+			{
+				printf( "FAIL: %u triangles, welded %zu vertices, brute force welded %zu\n", hiddenAreaMesh.unTriangleCount, weldedMesh.vVertices.size(), nBruteForceVertices );
+				nFailures++;
+			}
+		}
+
+		printf( "%10u %10zu %10zu %14.3f %14s\n", hiddenAreaMesh.unTriangleCount, vVertices.size(), weldedMesh.vVertices.size(), flWeldMs, rchBruteMs );
+	}
+
+	return nFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,229 @@
+// Checks the batch (SSE where available) and scalar pose conversions against the MatrixToQuaternion path they
+// replaced, on random rotations and on 180 degree turns where the quaternion's w is zero, then times the batch
+// against converting the devices one at a time. Pass --quick to skip most of the timing (used by ctest).
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#include "PoseConversion.h"
+#include "ProviderInterface/XRMath.h"
+
+
+static int s_nFailures = 0;
+
+#define CHECK( condition ) \
+	do \
+	{ \
+		if ( !( condition ) ) \
+		{ \
+			printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition ); \
+			s_nFailures++; \
+		} \
+	} while ( 0 )
+
+
+static const float k_flPi = 3.14159265358979f;
+static const float k_flEpsilon = 1e-5f;
+
+/// OpenVR pose rotated around a unit axis, with a position and velocities that differ per device
+static vr::TrackedDevicePose_t GetPose( float flAxisX, float flAxisY, float flAxisZ, float flAngle, uint32_t unDevice )
+{
+	float c = cosf( flAngle ), s = sinf( flAngle ), t = 1.0f - c;
+	float x = flAxisX, y = flAxisY, z = flAxisZ;
+
+	vr::TrackedDevicePose_t pose = {};
+	pose.mDeviceToAbsoluteTracking = { {
+		{ t * x * x + c, t * x * y - s * z, t * x * z + s * y, 0.1f * unDevice },
+		{ t * x * y + s * z, t * y * y + c, t * y * z - s * x, 1.5f },
+		{ t * x * z - s * y, t * y * z + s * x, t * z * z + c, -0.25f * unDevice },
+	} };
+	pose.vVelocity = { { 0.5f, -0.01f * unDevice, 0.02f * unDevice } };
+	pose.vAngularVelocity = { { -0.3f, 0.04f * unDevice, 1.0f } };
+	pose.bPoseIsValid = true;
+	pose.bDeviceIsConnected = true;
+	return pose;
+}
+
+/// The conversion before the batch path: mirror z into a Unity matrix, MatrixToQuaternion and flip w
+static UnityXRVector4 GetReferenceRotation( const vr::HmdMatrix34_t &openVRTransform )
+{
+	const float( &m )[3][4] = openVRTransform.m;
+	XRMatrix3x3 rotationMatrix(
+		m[0][0], m[0][1], -m[0][2],
+		m[1][0], m[1][1], -m[1][2],
+		-m[2][0], -m[2][1], m[2][2] );
+
+	XRQuaternion xrQuaternion;
+	MatrixToQuaternion( rotationMatrix, xrQuaternion );
+	return { xrQuaternion.x, xrQuaternion.y, xrQuaternion.z, -xrQuaternion.w };
+}
+
+/// q and -q are the same rotation
+static bool SameRotation( const UnityXRVector4 &a, const UnityXRVector4 &b )
+{
+	float flDot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+	return fabsf( fabsf( flDot ) - 1.0f ) < k_flEpsilon;
+}
+
+static bool SameVector( const UnityXRVector3 &a, const UnityXRVector3 &b )
+{
+	return fabsf( a.x - b.x ) < k_flEpsilon && fabsf( a.y - b.y ) < k_flEpsilon && fabsf( a.z - b.z ) < k_flEpsilon;
+}
+
+/// Every device of the batch has to match the scalar conversion and the reference
+static void CheckPoses( const char *pchName, const vr::TrackedDevicePose_t *pOpenVRPoses )
+{
+	static UnityDevicePoses s_batchPoses;
+	ConvertPosesToUnity( pOpenVRPoses, s_batchPoses );
+
+	int nFailuresBefore = s_nFailures;
+	for ( uint32_t unDevice = 0; unDevice < vr::k_unMaxTrackedDeviceCount; unDevice++ )
+	{
+		const vr::TrackedDevicePose_t &openVRPose = pOpenVRPoses[unDevice];
+
+		UnityDevicePose batchPose, scalarPose;
+		s_batchPoses.Get( unDevice, batchPose );
+		ConvertPoseToUnity( openVRPose, scalarPose );
+		UnityXRVector4 referenceRotation = GetReferenceRotation( openVRPose.mDeviceToAbsoluteTracking );
+
+		CHECK( SameRotation( batchPose.rotation, referenceRotation ) );
+		CHECK( SameRotation( scalarPose.rotation, referenceRotation ) );
+		CHECK( batchPose.rotation.w <= 0.0f );
+		CHECK( scalarPose.rotation.w <= 0.0f );
+
+		const float( &m )[3][4] = openVRPose.mDeviceToAbsoluteTracking.m;
+		UnityXRVector3 position = { m[0][3], m[1][3], -m[2][3] };
+		UnityXRVector3 velocity = { openVRPose.vVelocity.v[0], openVRPose.vVelocity.v[1], -openVRPose.vVelocity.v[2] };
+		UnityXRVector3 angularVelocity = { openVRPose.vAngularVelocity.v[0], openVRPose.vAngularVelocity.v[1], -openVRPose.vAngularVelocity.v[2] };
+		CHECK( SameVector( batchPose.position, position ) && SameVector( scalarPose.position, position ) );
+		CHECK( SameVector( batchPose.velocity, velocity ) && SameVector( scalarPose.velocity, velocity ) );
+		CHECK( SameVector( batchPose.angularVelocity, angularVelocity ) && SameVector( scalarPose.angularVelocity, angularVelocity ) );
+
+		if ( s_nFailures != nFailuresBefore )
+		{
+			printf( "     %s: device %u\n", pchName, unDevice );
+			return;
+		}
+	}
+}
+
+static void TestRandomRotations()
+{
+	std::mt19937 random( 1234 );
+	std::uniform_real_distribution< float > component( -1.0f, 1.0f );
+	std::uniform_real_distribution< float > angle( -k_flPi, k_flPi );
+
+	static vr::TrackedDevicePose_t s_openVRPoses[vr::k_unMaxTrackedDeviceCount];
+	for ( int nBatch = 0; nBatch < 100; nBatch++ )
+	{
+		for ( uint32_t unDevice = 0; unDevice < vr::k_unMaxTrackedDeviceCount; unDevice++ )
+		{
+			float x, y, z, flLength;
+			do
+			{
+				x = component( random );
+				y = component( random );
+				z = component( random );
+				flLength = sqrtf( x * x + y * y + z * z );
+			} while ( flLength < 0.1f || flLength > 1.0f );
+
+			s_openVRPoses[unDevice] = GetPose( x / flLength, y / flLength, z / flLength, angle( random ), unDevice );
+		}
+		CheckPoses( "random", s_openVRPoses );
+	}
+}
+
+/// Half turns leave nothing on the diagonal for w, every other branch of the extraction has to pick up the rotation
+static void TestHalfTurns()
+{
+	const float k_flInvSqrt2 = 0.70710678f;
+	const float k_flInvSqrt3 = 0.57735027f;
+	const float rAxes[][3] = {
+		{ 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f },
+		{ k_flInvSqrt2, k_flInvSqrt2, 0.0f }, { k_flInvSqrt2, 0.0f, -k_flInvSqrt2 }, { 0.0f, -k_flInvSqrt2, k_flInvSqrt2 },
+		{ k_flInvSqrt3, k_flInvSqrt3, k_flInvSqrt3 }, { -k_flInvSqrt3, k_flInvSqrt3, k_flInvSqrt3 },
+	};
+	const uint32_t unNumAxes = sizeof( rAxes ) / sizeof( rAxes[0] );
+
+	// Exactly 180 degrees and just short of it on either side
+	const float rAngles[] = { k_flPi, k_flPi - 1e-3f, -k_flPi + 1e-3f, 0.0f };
+	const uint32_t unNumAngles = sizeof( rAngles ) / sizeof( rAngles[0] );
+
+	static vr::TrackedDevicePose_t s_openVRPoses[vr::k_unMaxTrackedDeviceCount];
+	for ( uint32_t unDevice = 0; unDevice < vr::k_unMaxTrackedDeviceCount; unDevice++ )
+	{
+		const float *pAxis = rAxes[unDevice % unNumAxes];
+		s_openVRPoses[unDevice] = GetPose( pAxis[0], pAxis[1], pAxis[2], rAngles[( unDevice / unNumAxes ) % unNumAngles], unDevice );
+	}
+	CheckPoses( "half turns", s_openVRPoses );
+}
+
+/// Run fn nIterations times and return the average time of one run in microseconds
+template< typename Fn >
+static double TimeUs( uint32_t nIterations, Fn fn )
+{
+	auto start = std::chrono::steady_clock::now();
+	for ( uint32_t i = 0; i < nIterations; i++ )
+	{
+		fn();
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration< double, std::micro >( end - start ).count() / (double )nIterations;
+}
+
+static void RunBenchmark( bool bQuick )
+{
+	std::mt19937 random( 5678 );
+	std::uniform_real_distribution< float > angle( -k_flPi, k_flPi );
+
+	static vr::TrackedDevicePose_t s_openVRPoses[vr::k_unMaxTrackedDeviceCount];
+	for ( uint32_t unDevice = 0; unDevice < vr::k_unMaxTrackedDeviceCount; unDevice++ )
+	{
+		s_openVRPoses[unDevice] = GetPose( 0.0f, 0.6f, 0.8f, angle( random ), unDevice );
+	}
+
+	static UnityDevicePoses s_batchPoses;
+	static UnityDevicePose s_scalarPoses[vr::k_unMaxTrackedDeviceCount];
+	uint32_t nIterations = bQuick ? 100 : 200000;
+
+	// Accumulate a result so the conversions can't be optimized away
+	float flSink = 0.0f;
+	double flBatchUs = TimeUs( nIterations, [&]()
+	{
+		ConvertPosesToUnity( s_openVRPoses, s_batchPoses );
+		flSink += s_batchPoses.rotationW[nIterations % vr::k_unMaxTrackedDeviceCount];
+	} );
+	double flScalarUs = TimeUs( nIterations, [&]()
+	{
+		for ( uint32_t unDevice = 0; unDevice < vr::k_unMaxTrackedDeviceCount; unDevice++ )
+		{
+			ConvertPoseToUnity( s_openVRPoses[unDevice], s_scalarPoses[unDevice] );
+		}
+		flSink += s_scalarPoses[nIterations % vr::k_unMaxTrackedDeviceCount].rotation.w;
+	} );
+
+	printf( "%u devices: batch %.3f us, scalar %.3f us, %.2fx (%g)\n", vr::k_unMaxTrackedDeviceCount, flBatchUs, flScalarUs,
+		flBatchUs > 0.0 ? flScalarUs / flBatchUs : 0.0, flSink );
+}
+
+
+int main( int argc, char **argv )
+{
+	bool bQuick = argc > 1 && strcmp( argv[1], "--quick" ) == 0;
+
+	TestRandomRotations();
+	TestHalfTurns();
+	RunBenchmark( bQuick );
+
+	if ( s_nFailures != 0 )
+	{
+		printf( "%d checks failed\n", s_nFailures );
+		return 1;
+	}
+
+	printf( "All pose conversion tests passed\n" );
+	return 0;
+}
@@ -109,6 +109,31 @@ namespace Unity.XR.OpenVR.Editor
             File.WriteAllText(newSettingsPath.FullName, CreateSettingText());
             Debug.Log("Wrote openvr settings to build directory: " + newSettingsPath.FullName);
             //Debug.Log("Copied openvr settings to build directory: " + newSettingsPath.FullName);
+
+            CopyDefaultActionManifest(streamingSteamVR);
+        }
+
+        // The default action manifest and its bindings live in the package, OpenVRSettings.UseDefaultNativeActions reads them from StreamingAssets/SteamVR in builds
+        private static void CopyDefaultActionManifest(string streamingSteamVR)
+        {
+            string manifestDirectory = Path.GetFullPath(OpenVRSettings.DefaultActionManifestFolder);
+            if (Directory.Exists(manifestDirectory) == false)
+            {
+                Debug.LogWarning("<b>[OpenVR]</b> Could not find the default action manifest at: " + manifestDirectory);
+                return;
+            }
+
+            foreach (string manifestFile in Directory.GetFiles(manifestDirectory, "*.json"))
+            {
+                FileInfo newManifestPath = new FileInfo(Path.Combine(streamingSteamVR, Path.GetFileName(manifestFile)));
+                if (newManifestPath.Exists)
+                {
+                    newManifestPath.IsReadOnly = false;
+                    newManifestPath.Delete();
+                }
+
+                File.Copy(manifestFile, newManifestPath.FullName);
+            }
         }
 
 
@@ -1,5 +1,6 @@
 ﻿using System.Collections;
 using System.Collections.Generic;
+using System.Runtime.InteropServices;
 using UnityEngine;
 using UnityEngine.Events;
 using Valve.VR;
@@ -23,6 +24,7 @@ namespace Unity.XR.OpenVR
         private static bool debugLogAllEvents = false;
 
         private static bool enabled = true;
+        private static bool useNativeEventPump = false;
 
         public static void Initialize(bool lazyLoadEvents = false)
         {
@@ -112,13 +114,38 @@ namespace Unity.XR.OpenVR
             instance.PollEvents();
         }
 
+        /// <summary>Let the plugin poll OpenVR's events and keep its device list up to date from them, events are then read from the plugin's queue. Not available while the SteamVR plugin handles events.</summary>
+        public static void UseNativeEventPump(bool useNative)
+        {
+            if (!enabled)
+            {
+                Debug.LogError("[OpenVR XR Plugin] This events class is currently not enabled, the native event pump would take the events from SteamVR_Events.");
+                return;
+            }
+
+            useNativeEventPump = useNative;
+            OpenVRSettings.SetNativeEventPumpEnabled(useNative ? (ushort)1 : (ushort)0);
+        }
+
+        private bool PollNextEvent()
+        {
+            if (useNativeEventPump)
+                return PollNextNativeEvent(ref vrEvent, vrEventSize);
+
+            return Valve.VR.OpenVR.System != null && Valve.VR.OpenVR.System.PollNextEvent(ref vrEvent, vrEventSize);
+        }
+
+        [DllImport("XRSDKOpenVR", CharSet = CharSet.Auto)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        private static extern bool PollNextNativeEvent(ref VREvent_t pEvent, uint eventSize);
+
         public void PollEvents()
         {
             if (Valve.VR.OpenVR.System != null && enabled)
             {
                 for (int eventIndex = 0; eventIndex < maxEventsPerUpdate; eventIndex++)
                 {
-                    if (Valve.VR.OpenVR.System == null || !Valve.VR.OpenVR.System.PollNextEvent(ref vrEvent, vrEventSize))
+                    if (!PollNextEvent())
                         break;
 
                     int uEventType = (int)vrEvent.eventType;
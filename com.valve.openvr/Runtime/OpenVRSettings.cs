@@ -159,6 +159,85 @@ namespace Unity.XR.OpenVR
         [DllImport("XRSDKOpenVR", CharSet = CharSet.Auto)]
         public static extern void SetMirrorViewMode(ushort mirrorViewMode);
 
+        /// <summary>Number of eye textures (1-4) the display cycles through. More stages trade latency for fewer GPU stalls.</summary>
+        [DllImport("XRSDKOpenVR", CharSet = CharSet.Auto)]
+        public static extern void SetDisplayStageCount(ushort displayStageCount);
+
+        [DllImport("XRSDKOpenVR", CharSet = CharSet.Auto)]
+        public static extern ushort GetDisplayStageCount();
+
+        /// <summary>0: Disabled, 1: Step, 2: Hysteresis, 3: PID. Scales the eye viewports to stay within the compositor's frame budget.</summary>
+        [DllImport("XRSDKOpenVR", CharSet = CharSet.Auto)]
+        public static extern void SetDynamicResolutionPolicy(ushort dynamicResolutionPolicy);
+
+        [DllImport("XRSDKOpenVR", CharSet = CharSet.Auto)]
+        public static extern void SetDynamicResolutionScaleRange(float minScale, float maxScale);
+
+        /// <summary>The viewport scale the last frame was rendered with, 1 when dynamic resolution is disabled.</summary>
+        [DllImport("XRSDKOpenVR", CharSet = CharSet.Auto)]
+        public static extern float GetDynamicResolutionScale();
+
+        /// <summary>VRAM budget in MB for eye textures kept around for reuse after a resolution change. Takes effect the next time eye textures are created.</summary>
+        [DllImport("XRSDKOpenVR", CharSet = CharSet.Auto)]
+        public static extern void SetEyeTexturePoolBudget(uint budgetMB);
+
+        /// <summary>Submit the eye depth buffers to the compositor so reprojection can use them. D3D11 and D3D12 only.</summary>
+        [DllImport("XRSDKOpenVR", CharSet = CharSet.Auto)]
+        public static extern void SetDepthSubmissionEnabled(ushort depthSubmissionEnabled);
+
+        /// <summary>0: Off, 1: Low, 2: Medium, 3: High. Lowers the shading rate towards the edges of the eye textures. Vulkan with VK_EXT_fragment_density_map only.</summary>
+        [DllImport("XRSDKOpenVR", CharSet = CharSet.Auto)]
+        public static extern void SetFoveationLevel(ushort foveationLevel);
+
+        /// <summary>Moves the full rate region of an eye (0:Left, 1:Right) to follow the gaze, given as the tangent of the horizontal and vertical gaze angle (x right, y up).</summary>
+        [DllImport("XRSDKOpenVR", CharSet = CharSet.Auto)]
+        public static extern void SetFoveationGaze(int eye, float gazeX, float gazeY);
+
+        /// <summary>Render each eye as a low resolution wide view plus a full resolution inset. Vulkan multi-pass only.</summary>
+        [DllImport("XRSDKOpenVR", CharSet = CharSet.Auto)]
+        public static extern void SetQuadViewEnabled(ushort quadViewEnabled);
+
+        /// <summary>Part of the field of view (per axis) the inset covers and resolution scale (per axis) of the wide views, both between 0 and 1.</summary>
+        [DllImport("XRSDKOpenVR", CharSet = CharSet.Auto)]
+        public static extern void SetQuadViewParameters(float insetFraction, float wideScale);
+
+        /// <summary>Cull both eyes of multi-pass rendering once, against a frustum containing both of them.</summary>
+        [DllImport("XRSDKOpenVR", CharSet = CharSet.Auto)]
+        public static extern void SetSharedCullingEnabled(ushort sharedCullingEnabled);
+
+        /// <summary>Let the plugin poll OpenVR's events and update the device list from them instead of querying every device each frame. Use OpenVREvents.UseNativeEventPump so OpenVREvents reads the events from the plugin.</summary>
+        [DllImport("XRSDKOpenVR", CharSet = CharSet.Auto)]
+        public static extern void SetNativeEventPumpEnabled(ushort nativeEventPumpEnabled);
+
+        /// <summary>Read controller buttons and axes natively from an action set of the action manifest (e.g. "/actions/unityxr") and report them as XR input features. The set needs an action per feature at "in/Trigger", "in/Primary2DAxis" and so on. Pass null or an empty string to turn it off. Don't use alongside another UpdateActionState caller such as the SteamVR plugin. UseDefaultNativeActions sets up the manifest that ships with the package.</summary>
+        [DllImport("XRSDKOpenVR", CharSet = CharSet.Ansi)]
+        public static extern void SetNativeActionSet(string actionSetPath);
+
+        /// <summary>Action manifest the plugin hands to IVRInput::SetActionManifestPath when SetNativeActionSet turns native input on. Pass null or an empty string to use the manifest of the project settings.</summary>
+        [DllImport("XRSDKOpenVR", CharSet = CharSet.Ansi)]
+        public static extern void SetNativeActionManifest(string actionManifestPath);
+
+        public const string DefaultNativeActionSet = "/actions/unityxr";
+        public const string DefaultActionManifestFolder = "Packages/com.valve.openvr/Runtime/ActionManifest";
+        public const string DefaultActionManifestFileName = "unityxr_actions.json";
+
+        /// <summary>Full path of the action manifest that ships with the package, with an action per input feature and default bindings for Index, Vive and Touch controllers. Builds read it from StreamingAssets/SteamVR.</summary>
+        public static string GetDefaultActionManifestPath()
+        {
+#if UNITY_EDITOR
+            return Path.GetFullPath(Path.Combine(DefaultActionManifestFolder, DefaultActionManifestFileName));
+#else
+            return Path.Combine(GetStreamingSteamVRPath(false), DefaultActionManifestFileName);
+#endif
+        }
+
+        /// <summary>Read controller input natively with the action manifest that ships with the package. For applications that don't use the SteamVR plugin or an action manifest of their own.</summary>
+        public static void UseDefaultNativeActions()
+        {
+            SetNativeActionManifest(GetDefaultActionManifestPath());
+            SetNativeActionSet(DefaultNativeActionSet);
+        }
+
 
         public bool InitializeActionManifestFileRelativeFilePath()
         {